@@ -0,0 +1,196 @@
+/*
+ *
+ * pnpControlBench.c - times the work the controller does for a job: parsing the centroid file, sorting the
+ * parts into pick order, planning, and the round trip of an instruction to the simulator
+ *
+ * Usage:
+ *   pnpControlBench [-r repeats] [-i round_trips] [centroid_file ...]
+ *
+ * Each centroid file is parsed into the placement store, sorted by orderPlacements() and planned by
+ * planPlacements() repeats times, and the fastest run of each is reported in us. The sample boards in
+ * bin/Release are used if no files are given. The round trip is then timed from issuing an instruction to
+ * isSimulatorReadyForNextInstruction() reporting it done, for round_trips instructions to a simulator running
+ * in the working directory (e.g. the stand-in simulator); it is skipped if none answers within a second. The
+ * instructions all turn a nozzle to the same angle, so the peephole optimiser is turned off for them.
+ * The benchmark quits the simulator when it finishes.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpPlanner.h"
+
+#define BENCH_SIMULATOR_TIMEOUT 1e9     // ns to wait for the simulator to answer the first instruction
+
+const char *bench_sample_file[] = {"bin/Release/centroid.txt", "bin/Release/centroid_small_auto.txt", "bin/Release/centroid_medium_auto.txt",
+                                   "bin/Release/centroid_large_auto.txt", "bin/Release/centroid_small_manual.txt",
+                                   "bin/Release/centroid_medium_manual.txt", "bin/Release/centroid_large_manual.txt"};
+
+/*
+ Function: nanoseconds
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the monotonic clock
+ Argument(s): none
+ Return Value: the time in ns
+ Usage: double start = nanoseconds();
+ */
+double nanoseconds()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ Function: compareTimes
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: qsort() comparison of two round trip times
+ Argument(s):
+ const void *a, const void *b - the times to compare
+ Return Value: negative, zero or positive as a is shorter than, the same as or longer than b
+ Usage: qsort(times, n, sizeof(double), compareTimes);
+ */
+int compareTimes(const void *a, const void *b)
+{
+    double ta = *(const double *)a, tb = *(const double *)b;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/*
+ Function: benchBoard
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: times the parsing, sorting and planning of one centroid file and prints the fastest of each
+ Argument(s):
+ const char *file_name - the centroid file
+ int repeats - the number of times each is run
+ Return Value: 0, or -1 if the file could not be read
+ Usage: benchBoard("centroid.txt", 100);
+ */
+int benchBoard(const char *file_name, int repeats)
+{
+    PlacementStore store;
+    const char *board = strrchr(file_name, '/') ? strrchr(file_name, '/') + 1 : file_name;  //the boards are reported by file name
+    int operation_mode, *order = NULL, plan = 0;
+    double t, best[3] = {INFINITY, INFINITY, INFINITY};
+
+    placementStoreInit(&store);
+    for (int r = 0; r < repeats; r++)
+    {
+        t = nanoseconds();
+        if (loadPlacementStore(file_name, &operation_mode, &store) != CENTROID_FILE_PRESENT_AND_READ)
+        {
+            printf("  %-28s unreadable\n", board);
+            placementStoreFree(&store);
+            free(order);
+            return -1;
+        }
+        best[0] = fmin(best[0], nanoseconds() - t);
+
+        if (order == NULL && (order = malloc((store.count + 1) * sizeof(int))) == NULL) {placementStoreFree(&store); return -1;}
+
+        t = nanoseconds();
+        orderPlacements(&store, order);
+        best[1] = fmin(best[1], nanoseconds() - t);
+
+        t = nanoseconds();
+        plan = planPlacements(&store, order);
+        best[2] = fmin(best[2], nanoseconds() - t);
+    }
+    printf("  %-28s %6d %10.1f %10.1f %10.1f  %.0f mm\n", board, store.count, best[0] / 1e3, best[1] / 1e3, best[2] / 1e3,
+           plan >= 0 ? routeLength(&store, order, store.count) : 0.0);
+
+    placementStoreFree(&store);
+    free(order);
+    return 0;
+}
+
+/*
+ Function: benchRoundTrips
+ -------------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: times instructions from issue to completion through the controller's interface to the simulator,
+ and prints the mean, median and 99th percentile. The peephole optimiser is turned off, so that none of
+ them is dropped
+ Argument(s):
+ int n - the number of instructions
+ Return Value: 0, or -1 if the simulator does not answer or there is not enough memory
+ Usage: benchRoundTrips(10000);
+ */
+int benchRoundTrips(int n)
+{
+    double *times = malloc(n * sizeof(double)), sum = 0, t;
+
+    if (times == NULL) return -1;
+
+    setPeepholeOptimiser(FALSE);  //every instruction is timed through to the simulator
+
+    /* the first instruction finds out whether a simulator is running */
+    t = nanoseconds();
+    rotateNozzle(0, 0.0);
+    while (!isSimulatorReadyForNextInstruction())
+    {
+        if (nanoseconds() - t > BENCH_SIMULATOR_TIMEOUT)
+        {
+            printf("No simulator answered within %.0f s, round trip skipped\n", BENCH_SIMULATOR_TIMEOUT / 1e9);
+            free(times);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        t = nanoseconds();
+        rotateNozzle(0, 0.0);
+        while (!isSimulatorReadyForNextInstruction());
+        times[i] = nanoseconds() - t;
+        sum += times[i];
+    }
+    qsort(times, n, sizeof(double), compareTimes);
+    printf("Instruction round trip, %d instructions: mean %.1f us, median %.1f us, 99th percentile %.1f us\n",
+           n, sum / n / 1e3, times[n / 2] / 1e3, times[(int) (0.99 * (n - 1))] / 1e3);
+    free(times);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int repeats = 100, round_trips = 2000, first_file = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) round_trips = atoi(argv[++i]);
+        else if (argv[i][0] != '-') {first_file = i; break;}
+        else
+        {
+            printf("usage: %s [-r repeats] [-i round_trips] [centroid_file ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeats < 1 || round_trips < 0) return 1;
+
+    defaultMachineProfile(&machine);
+    printf("Best of %d repeats, in us\n  %-28s %6s %10s %10s %10s\n", repeats, "board", "parts", "parse", "sort", "plan");
+    if (first_file < argc)
+        for (int i = first_file; i < argc; i++) benchBoard(argv[i], repeats);
+    else
+        for (int i = 0; i < sizeof(bench_sample_file) / sizeof(bench_sample_file[0]); i++) benchBoard(bench_sample_file[i], repeats);
+
+    if (round_trips > 0)
+    {
+        pnpOpen();
+        benchRoundTrips(round_trips);
+        pnpClose();
+    }
+    return 0;
+}
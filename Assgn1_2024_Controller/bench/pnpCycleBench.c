@@ -0,0 +1,514 @@
+/*
+ *
+ * pnpCycleBench.c - the cycle time regression suite: runs the controller end to end against the stand-in
+ * simulator on a fixed corpus of boards and compares the results with golden baselines
+ *
+ * Usage:
+ *   pnpCycleBench [-b baseline_file] [-u] [-t tolerance_percent] [-c cpu_tolerance_percent] [-w work_dir]
+ *                 [-g parts,parts,...] [centroid_file ...]
+ *
+ * The corpus is the sample boards in bin/Release, manual ones run in automatic mode, unless centroid files are
+ * given, plus boards of the given numbers of parts (1000,5000) made by pnpBoardGenerator with its default
+ * options and seed (-g 0 for none). Each board is run in work_dir (cycle_bench) by the controller with -q
+ * against a fresh stand-in simulator with a fixed seed and a few failed and bad picks, so every run of the same
+ * controller places a board the same way. The machine profile of the work directory, CYCLE_MACHINE_PROFILE,
+ * has the controller reject the parts the stand-in lifts on their side. The controller, simulator and generator are taken from the directory
+ * of this program. For each board the simulated cycle time, the instructions executed, the head travel and the
+ * parts placed are read from the simulator's summary, and the CPU time of the controller is measured. The
+ * simulator only counts a part as placed if it is released at the position and angle of the centroid file, so a
+ * correction lost by the controller shows as fewer parts placed.
+ *
+ * The results are compared with the baseline of each board in baseline_file (CYCLE_BASELINE_FILE). A board
+ * regresses if its cycle time, instructions or travel grow by more than tolerance_percent (1), fewer of its
+ * parts are placed, or its CPU time grows by more than cpu_tolerance_percent (50) and CYCLE_CPU_FLOOR_MS. Any
+ * regression makes the exit status 3. -u writes the results as the new baselines instead, after a change
+ * which is meant to alter them; the CPU times recorded are those of the machine it is run on.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <libgen.h>
+#include <limits.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "../pnpShared.h"
+
+#define CYCLE_BASELINE_FILE "bench/cycle_baselines.txt"
+#define CYCLE_WORK_DIR "cycle_bench"
+#define CYCLE_MAX_BOARDS 64
+#define CYCLE_NAME_LENGTH 64
+#define CYCLE_MACHINE_PROFILE "name = stand-in\nmax_pick_error = 15\n"  // the default machine, with the bad picks of -b rejected
+#define CYCLE_CPU_FLOOR_MS 20.0            // smaller changes in CPU time are noise, and never a regression
+#define CYCLE_START_TIMEOUT 5.0            // s to wait for the simulator to serve the shared memory
+#define CYCLE_RUN_TIMEOUT 600.0            // s to wait for the controller to place a board
+
+const char *cycle_sample_file[] = {"bin/Release/centroid.txt", "bin/Release/centroid_small_auto.txt", "bin/Release/centroid_medium_auto.txt",
+                                   "bin/Release/centroid_large_auto.txt", "bin/Release/centroid_small_manual.txt",
+                                   "bin/Release/centroid_medium_manual.txt", "bin/Release/centroid_large_manual.txt"};
+
+const char *simulator_options[] = {"-s", "1", "-f", "5", "-b", "2", NULL};
+
+/* the results of one board, as kept in the baseline file */
+typedef struct
+{
+    char name[CYCLE_NAME_LENGTH];
+    long parts;
+    long placed;
+    double sim_time;            // s of simulated time
+    long instructions;
+    double travel;              // mm of head travel
+    double cpu_ms;              // user and system CPU time of the controller
+
+} CycleResult;
+
+char program_dir[PATH_MAX] = ".";
+
+/*
+ Function: secondsNow
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the monotonic clock
+ Argument(s): none
+ Return Value: the time in s
+ Usage: double start = secondsNow();
+ */
+double secondsNow()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/*
+ Function: startProgram
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: runs one of the programs next to this one in the work directory, with its output to a file and no input
+ Argument(s):
+ const char *work_dir - the directory to run it in
+ const char *program - the program, e.g. "pnpSimulator"
+ const char *const options[] - its options, NULL terminated
+ const char *output - the file in work_dir its output goes to
+ Return Value: the process id, or -1 if it could not be started
+ Usage: pid_t simulator = startProgram(CYCLE_WORK_DIR, "pnpSimulator", simulator_options, "simulator.txt");
+ */
+pid_t startProgram(const char *work_dir, const char *program, const char *const options[], const char *output)
+{
+    char path[PATH_MAX + CYCLE_NAME_LENGTH];
+    const char *argv[16] = {path};
+    pid_t pid;
+
+    snprintf(path, sizeof(path), "%s/%s", program_dir, program);
+    for (int i = 0; options[i] != NULL && i < 14; i++) argv[i + 1] = options[i];
+
+    fflush(stdout);
+    if ((pid = fork()) == 0)
+    {
+        int in = open("/dev/null", O_RDONLY), out;
+
+        if (chdir(work_dir) != 0 || (out = open(output, O_CREAT | O_WRONLY | O_TRUNC, 0666)) < 0) _exit(127);
+        dup2(in, 0);
+        dup2(out, 1);
+        dup2(out, 2);
+        execv(path, (char *const *) argv);
+        _exit(127);
+    }
+    return pid;
+}
+
+/*
+ Function: awaitProgram
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: waits for a program to exit, and kills it if it takes too long
+ Argument(s):
+ pid_t pid - the program
+ double timeout - s to wait
+ double *cpu_ms - set to its user and system CPU time, if not NULL
+ Return Value: its exit status, or -1 if it had to be killed or did not exit normally
+ Usage: int status = awaitProgram(controller, CYCLE_RUN_TIMEOUT, &cpu_ms);
+ */
+int awaitProgram(pid_t pid, double timeout, double *cpu_ms)
+{
+    double end = secondsNow() + timeout;
+    struct rusage usage;
+    int status;
+
+    if (pid < 0) return -1;
+    while (wait4(pid, &status, WNOHANG, &usage) == 0)
+    {
+        if (secondsNow() > end)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+            return -1;
+        }
+        usleep(10000);
+    }
+    if (cpu_ms != NULL)
+        *cpu_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/*
+ Function: awaitSimulator
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ waits until the stand-in simulator serves the shared memory, so that it cannot clear an instruction the
+ controller has already passed when it starts
+ Argument(s): const char *work_dir - the directory the simulator runs in
+ Return Value: 0 once it serves it, -1 after CYCLE_START_TIMEOUT
+ Usage: if (awaitSimulator(CYCLE_WORK_DIR) != 0) ...
+ */
+int awaitSimulator(const char *work_dir)
+{
+    char path[PATH_MAX];
+    double end = secondsNow() + CYCLE_START_TIMEOUT;
+    struct stat st;
+
+    snprintf(path, sizeof(path), "%s/%s", work_dir, MEMORY_MAPPED_FILE);
+    while (secondsNow() < end)
+    {
+        int fd = open(path, O_RDONLY), serving = FALSE;
+
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= PNP_V2_OFFSET + (off_t) sizeof(PnPSharedV2))
+        {
+            void *p = mmap(NULL, PNP_V2_OFFSET + sizeof(PnPSharedV2), PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                serving = isSimulatorServingV2((const PnPSharedV2 *)((char *) p + PNP_V2_OFFSET));
+                munmap(p, PNP_V2_OFFSET + sizeof(PnPSharedV2));
+            }
+        }
+        if (fd >= 0) close(fd);
+        if (serving) return 0;
+        usleep(10000);
+    }
+    return -1;
+}
+
+/*
+ Function: copyBoard
+ -------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: copies a centroid file to the centroid file of the work directory, in automatic mode
+ Argument(s):
+ const char *board - the centroid file
+ const char *work_dir - the work directory
+ long *parts - set to the number of parts on the board
+ Return Value: 0, or -1 if the board could not be read or written
+ Usage: copyBoard("bin/Release/centroid.txt", CYCLE_WORK_DIR, &parts);
+ */
+int copyBoard(const char *board, const char *work_dir, long *parts)
+{
+    char path[PATH_MAX], buffer[65536];
+    FILE *in = fopen(board, "rb"), *out;
+    size_t n, total = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", work_dir, CENTROID_FILE);
+    if (in == NULL) return -1;
+    if (fscanf(in, "%*c %ld", parts) != 1 || fseek(in, 0, SEEK_SET) != 0 || (out = fopen(path, "wb")) == NULL)
+    {
+        fclose(in);
+        return -1;
+    }
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    {
+        if (total == 0) buffer[0] = 'A';  //the first character is the operation mode
+        total += fwrite(buffer, 1, n, out);
+    }
+    fclose(in);
+    return fclose(out) == 0 && total > 0 ? 0 : -1;
+}
+
+/*
+ Function: readSummary
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the cycle time, instructions, travel and parts placed from the stand-in simulator's summary
+ Argument(s):
+ const char *file_name - the output of the simulator
+ CycleResult *result - filled in
+ Return Value: 0, or -1 if the summary is missing
+ Usage: readSummary(CYCLE_WORK_DIR "/simulator.txt", &result);
+ */
+int readSummary(const char *file_name, CycleResult *result)
+{
+    FILE *fp = fopen(file_name, "r");
+    char line[256];
+    int found = 0;
+
+    if (fp == NULL) return -1;
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, "Simulated time %lf s, head travel %lf mm", &result -> sim_time, &result -> travel) == 2) found |= 1;
+        else if (sscanf(line, " total %ld", &result -> instructions) == 1) found |= 2;
+        else if (sscanf(line, "Parts placed %ld", &result -> placed) == 1) found |= 4;
+    }
+    fclose(fp);
+    return found == 7 ? 0 : -1;
+}
+
+/*
+ Function: runBoard
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: places a board with the controller against a fresh stand-in simulator, and reads the results
+ Argument(s):
+ const char *board - the centroid file
+ const char *work_dir - the work directory
+ CycleResult *result - filled in
+ Return Value: 0, or -1 if the board could not be run or the run failed
+ Usage: runBoard("bin/Release/centroid.txt", CYCLE_WORK_DIR, &result);
+ */
+int runBoard(const char *board, const char *work_dir, CycleResult *result)
+{
+    const char *controller_options[] = {"-q", NULL};
+    const char *leftover[] = {MEMORY_MAPPED_FILE, "pnp_job_journal", "simulator.txt", "controller.txt"};
+    char path[PATH_MAX];
+    pid_t simulator, controller;
+    int status;
+
+    memset(result, 0, sizeof(CycleResult));
+    snprintf(result -> name, sizeof(result -> name), "%s", strrchr(board, '/') ? strrchr(board, '/') + 1 : board);
+    for (int i = 0; i < sizeof(leftover) / sizeof(leftover[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", work_dir, leftover[i]);
+        unlink(path);
+    }
+    if (copyBoard(board, work_dir, &result -> parts) != 0) return -1;
+
+    if ((simulator = startProgram(work_dir, "pnpSimulator", simulator_options, "simulator.txt")) < 0) return -1;
+    if (awaitSimulator(work_dir) != 0)
+    {
+        kill(simulator, SIGKILL);
+        waitpid(simulator, NULL, 0);
+        return -1;
+    }
+
+    if ((controller = startProgram(work_dir, "Assgn1_2024_Controller", controller_options, "controller.txt")) < 0) status = -1;
+    else status = awaitProgram(controller, CYCLE_RUN_TIMEOUT, &result -> cpu_ms);
+
+    /* the simulator quits with the controller, and prints its summary */
+    if (awaitProgram(simulator, status == 0 ? CYCLE_START_TIMEOUT : 0, NULL) != 0 || status != 0) return -1;
+    snprintf(path, sizeof(path), "%s/simulator.txt", work_dir);
+    return readSummary(path, result);
+}
+
+/*
+ Function: loadBaselines
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the baseline file, one board per line, lines starting with # are comments
+ Argument(s):
+ const char *file_name - the baseline file
+ CycleResult baseline[] - filled in, CYCLE_MAX_BOARDS at most
+ Return Value: the number of baselines, or -1 if the file could not be read
+ Usage: int n = loadBaselines(CYCLE_BASELINE_FILE, baseline);
+ */
+int loadBaselines(const char *file_name, CycleResult baseline[])
+{
+    FILE *fp = fopen(file_name, "r");
+    char line[256];
+    int n = 0;
+
+    if (fp == NULL) return -1;
+    while (n < CYCLE_MAX_BOARDS && fgets(line, sizeof(line), fp) != NULL)
+    {
+        CycleResult *b = &baseline[n];
+        if (line[0] != '#' && sscanf(line, "%63s %ld %ld %lf %ld %lf %lf", b -> name, &b -> parts, &b -> placed, &b -> sim_time,
+                                     &b -> instructions, &b -> travel, &b -> cpu_ms) == 7) n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+/*
+ Function: saveBaselines
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes the results of the boards as the baseline file
+ Argument(s):
+ const char *file_name - the baseline file
+ const CycleResult result[] - the results
+ int n - the number of boards
+ Return Value: 0, or -1 if the file could not be written
+ Usage: saveBaselines(CYCLE_BASELINE_FILE, result, n);
+ */
+int saveBaselines(const char *file_name, const CycleResult result[], int n)
+{
+    FILE *fp = fopen(file_name, "w");
+
+    if (fp == NULL) return -1;
+    fprintf(fp, "# golden baselines of pnpCycleBench, rewritten by pnpCycleBench -u\n");
+    fprintf(fp, "# %-26s %7s %7s %10s %12s %10s %9s\n", "board", "parts", "placed", "cycle s", "instructions", "travel mm", "cpu ms");
+    for (int i = 0; i < n; i++)
+        fprintf(fp, "%-28s %7ld %7ld %10.2f %12ld %10.0f %9.1f\n", result[i].name, result[i].parts, result[i].placed, result[i].sim_time,
+                result[i].instructions, result[i].travel, result[i].cpu_ms);
+    return fclose(fp);
+}
+
+/*
+ * percentChange - the change from baseline to value in percent, 0 if the baseline is 0
+ */
+double percentChange(double value, double baseline)
+{
+    return baseline != 0 ? 100.0 * (value - baseline) / baseline : 0.0;
+}
+
+/*
+ Function: compareResult
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: prints the changes of a board from its baseline, and the metrics which regressed
+ Argument(s):
+ const CycleResult *r - the results
+ const CycleResult *b - the baseline
+ double tolerance - percent the cycle time, instructions and travel may grow by
+ double cpu_tolerance - percent the CPU time may grow by, beyond CYCLE_CPU_FLOOR_MS
+ Return Value: TRUE if the board regressed, FALSE if not
+ Usage: regressions += compareResult(&result[i], &baseline[j], 1.0, 50.0);
+ */
+int compareResult(const CycleResult *r, const CycleResult *b, double tolerance, double cpu_tolerance)
+{
+    double change[4] = {percentChange(r -> sim_time, b -> sim_time), percentChange(r -> instructions, b -> instructions),
+                        percentChange(r -> travel, b -> travel), percentChange(r -> cpu_ms, b -> cpu_ms)};
+    int regressed = FALSE;
+
+    printf("  %+6.1f%% %+6.1f%% %+6.1f%% %+6.1f%% ", change[0], change[1], change[2], change[3]);
+    if (r -> parts != b -> parts) {printf(" the board has changed, %ld parts instead of %ld\n", r -> parts, b -> parts); return TRUE;}
+    if (r -> placed < b -> placed) {printf(" PLACED %ld fewer", b -> placed - r -> placed); regressed = TRUE;}
+    if (change[0] > tolerance) {printf(" CYCLE TIME"); regressed = TRUE;}
+    if (change[1] > tolerance) {printf(" INSTRUCTIONS"); regressed = TRUE;}
+    if (change[2] > tolerance) {printf(" TRAVEL"); regressed = TRUE;}
+    if (change[3] > cpu_tolerance && r -> cpu_ms - b -> cpu_ms > CYCLE_CPU_FLOOR_MS) {printf(" CPU TIME"); regressed = TRUE;}
+    printf("%s\n", regressed ? " regressed" : change[0] < -tolerance || change[1] < -tolerance || change[2] < -tolerance ? " improved" : " ok");
+    return regressed;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_file = CYCLE_BASELINE_FILE, *work_dir = CYCLE_WORK_DIR, *generated = "1000,5000";
+    const char *board[CYCLE_MAX_BOARDS];
+    char generated_board[CYCLE_MAX_BOARDS][CYCLE_NAME_LENGTH + sizeof(CYCLE_WORK_DIR)];
+    int update = FALSE, boards = 0, first_file = argc, number_of_baselines, regressions = 0, failures = 0;
+    double tolerance = 1.0, cpu_tolerance = 50.0;
+    CycleResult result[CYCLE_MAX_BOARDS], baseline[CYCLE_MAX_BOARDS];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) baseline_file = argv[++i];
+        else if (strcmp(argv[i], "-u") == 0) update = TRUE;
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) cpu_tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) work_dir = argv[++i];
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) generated = argv[++i];
+        else if (argv[i][0] != '-') {first_file = i; break;}
+        else
+        {
+            printf("usage: %s [-b baseline_file] [-u] [-t tolerance_percent] [-c cpu_tolerance_percent] [-w work_dir]\n"
+                   "          [-g parts,parts,...] [centroid_file ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (tolerance < 0 || cpu_tolerance < 0) return 1;
+
+    /* the controller, simulator and generator are next to this program */
+    if (strchr(argv[0], '/') != NULL && realpath(argv[0], program_dir) != NULL) dirname(program_dir);
+    else if (realpath(".", program_dir) == NULL) return 2;
+    if (mkdir(work_dir, 0777) != 0 && errno != EEXIST)
+    {
+        perror("creation of the work directory failed");
+        return 2;
+    }
+    char profile_path[PATH_MAX];
+    FILE *profile;
+    snprintf(profile_path, sizeof(profile_path), "%s/pnp_machine_profile.txt", work_dir);
+    if ((profile = fopen(profile_path, "w")) == NULL || fputs(CYCLE_MACHINE_PROFILE, profile) < 0 || fclose(profile) != 0)
+    {
+        perror("writing the machine profile failed");
+        return 2;
+    }
+
+    if (first_file < argc)
+        for (int i = first_file; i < argc && boards < CYCLE_MAX_BOARDS; i++) board[boards++] = argv[i];
+    else
+        for (int i = 0; i < sizeof(cycle_sample_file) / sizeof(cycle_sample_file[0]); i++) board[boards++] = cycle_sample_file[i];
+
+    /* the generated boards are made in the work directory, with the default machine profile */
+    for (const char *p = generated; *p != '\0' && boards < CYCLE_MAX_BOARDS; p += strspn(p, ","))
+    {
+        long parts = strtol(p, (char **) &p, 10);
+        char count[24], name[CYCLE_NAME_LENGTH];
+        const char *options[] = {"-n", count, "-o", name, NULL};
+
+        if (parts <= 0) break;
+        snprintf(count, sizeof(count), "%ld", parts);
+        snprintf(name, sizeof(name), "generated_%ld.txt", parts);
+        if (awaitProgram(startProgram(work_dir, "pnpBoardGenerator", options, "generator.txt"), CYCLE_RUN_TIMEOUT, NULL) != 0)
+        {
+            printf("%s could not be generated\n", name);
+            return 2;
+        }
+        snprintf(generated_board[boards], sizeof(generated_board[boards]), "%s/%s", work_dir, name);
+        board[boards] = generated_board[boards];
+        boards++;
+    }
+
+    number_of_baselines = update ? 0 : loadBaselines(baseline_file, baseline);
+    if (!update && number_of_baselines < 0) printf("No baselines in %s, run with -u to record them\n", baseline_file);
+    printf("%-28s %7s %7s %10s %12s %10s %9s", "board", "parts", "placed", "cycle s", "instructions", "travel mm", "cpu ms");
+    if (number_of_baselines > 0) printf("  %7s %7s %7s %7s", "cycle", "instr", "travel", "cpu");
+    printf("\n");
+
+    for (int i = 0; i < boards; i++)
+    {
+        CycleResult *r = &result[i];
+        int b;
+
+        if (runBoard(board[i], work_dir, r) != 0)
+        {
+            printf("%-28s the run failed, see %s\n", r -> name, work_dir);
+            failures++;
+            continue;
+        }
+        printf("%-28s %7ld %7ld %10.2f %12ld %10.0f %9.1f", r -> name, r -> parts, r -> placed, r -> sim_time, r -> instructions, r -> travel, r -> cpu_ms);
+
+        for (b = 0; b < number_of_baselines && strcmp(baseline[b].name, r -> name) != 0; b++);
+        if (b < number_of_baselines) regressions += compareResult(r, &baseline[b], tolerance, cpu_tolerance);
+        else printf("%s\n", number_of_baselines > 0 ? "  no baseline" : "");
+    }
+
+    if (failures) return 2;
+    if (update)
+    {
+        if (saveBaselines(baseline_file, result, boards) != 0)
+        {
+            perror("writing of the baseline file failed");
+            return 2;
+        }
+        printf("Baselines of %d boards written to %s\n", boards, baseline_file);
+        return 0;
+    }
+    if (regressions)
+    {
+        printf("%d of %d boards regressed beyond %.1f%% (CPU time %.0f%%)\n", regressions, boards, tolerance, cpu_tolerance);
+        return 3;
+    }
+    printf("No regressions beyond %.1f%% (CPU time %.0f%%)\n", tolerance, cpu_tolerance);
+    return 0;
+}
@@ -0,0 +1,288 @@
+/*
+ *
+ * pnpDispatchBench.c - compares ways of dispatching the states of the autonomous state machine
+ *
+ * Usage:
+ *   pnpDispatchBench [-n dispatches] [-r repeats] [-e pick error percent]
+ *
+ * A model of the autonomous state machine, with the state handlers reduced to the bookkeeping of the trip
+ * and no instructions to the simulator, is run for n dispatches with
+ *   - a switch over the states generated from STATE_TABLE(), with the handlers inlined into it
+ *   - the same switch followed by the transition check the controller makes after every dispatch
+ *   - a table of pointers to the handlers, also generated from STATE_TABLE()
+ * The fastest of the repeats is reported in ns per dispatch, and every method must visit the same states.
+ * A loop over the nozzles of the head with the nozzle count read from the machine profile is then compared
+ * with the same loop with the count a compile-time constant, as when built with FIXED_NUMBER_OF_NOZZLES.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpMachineProfile.h"
+#include "../pnpStates.h"
+
+const unsigned int state_transitions[NUMBER_OF_STATES] = {STATE_TABLE(STATE_TRANSITIONS)};
+
+/* the part of the controller's state which decides the next state */
+typedef struct
+{
+    int nozzles, nozzle, check_nozzle, placing, lookup_photo;
+    int part, parts;
+    int held[MAX_NUMBER_OF_NOZZLES];
+    unsigned int random, error_percent;
+} Trip;
+
+/*
+ * missedPick - TRUE for error_percent of the look-up photos, from a small LCG so the trace is the same for every method
+ */
+static inline int missedPick(Trip *t)
+{
+    t -> random = t -> random * 1103515245u + 12345u;
+    return (t -> random >> 16) % 100 < t -> error_percent;
+}
+
+/*
+ * the handlers, one per state, each returns the next state. The states only used in manual mode go home.
+ */
+static inline int onHOME(Trip *t) { t -> part = 0; t -> nozzle = 0; t -> placing = FALSE; return MOVE_TO_FEEDER; }
+static inline int onMOVE_TO_FEEDER(Trip *t) { return LOWER_HEAD_NOZZLE; }
+static inline int onWAIT_1(Trip *t) { return MOVE_TO_HOME; }
+static inline int onLOWER_CNTR_NOZZLE(Trip *t) { return VAC_CNTR_NOZZLE; }
+static inline int onVAC_CNTR_NOZZLE(Trip *t) { return RAISE_CNTR_NOZZLE; }
+static inline int onRAISE_CNTR_NOZZLE(Trip *t) { return MOVE_TO_HOME; }
+static inline int onMOVE_TO_CAMERA(Trip *t) { return LOOK_UP_PHOTO; }
+static inline int onLOOK_UP_PHOTO(Trip *t) { t -> lookup_photo = TRUE; return CHECK_ERROR; }
+static inline int onMOVE_TO_PCB(Trip *t) { return LOOK_DOWN_PHOTO; }
+static inline int onLOOK_DOWN_PHOTO(Trip *t) { t -> lookup_photo = FALSE; return CHECK_ERROR; }
+static inline int onCORRECT_ERRORS(Trip *t) { return WAIT_1; }
+static inline int onMOVE_TO_HOME(Trip *t) { return HOME; }
+static inline int onFIX_NOZZLE_ERROR(Trip *t) { t -> check_nozzle--; return CHECK_ERROR; }
+static inline int onFIX_PREPLACE_ERROR(Trip *t) { return LOWER_HEAD_NOZZLE; }
+static inline int onLOWER_HEAD_NOZZLE(Trip *t) { return VAC_HEAD_NOZZLE; }
+static inline int onVAC_HEAD_NOZZLE(Trip *t) { return RAISE_HEAD_NOZZLE; }
+static inline int onMOVE_TO_REJECT_BIN(Trip *t) { return REJECT_PART; }
+static inline int onREJECT_PART(Trip *t) { return CHECK_ERROR; }
+static inline int onFLY_BY_CAMERA(Trip *t) { t -> lookup_photo = TRUE; return CHECK_ERROR; }
+static inline int onPRE_ROTATE_NOZZLES(Trip *t) { return MOVE_TO_FEEDER; }
+
+static inline int onCHECK_ERROR(Trip *t)
+{
+    if (!t -> lookup_photo) return FIX_PREPLACE_ERROR;
+    if (t -> check_nozzle >= 0 && missedPick(t))
+    {
+        t -> held[t -> check_nozzle--] = FALSE;
+        return CHECK_ERROR;
+    }
+    if (t -> check_nozzle >= 0) return FIX_NOZZLE_ERROR;
+
+    t -> lookup_photo = FALSE;
+    for (int n = 0; n < t -> nozzles; n++)
+    {
+        if (!t -> held[n]) continue;
+        t -> nozzle = n;
+        t -> placing = TRUE;
+        return MOVE_TO_PCB;
+    }
+    t -> nozzle = 0;
+    return t -> part == t -> parts ? MOVE_TO_HOME : HOME;
+}
+
+static inline int onRAISE_HEAD_NOZZLE(Trip *t)
+{
+    if (!t -> placing)
+    {
+        t -> held[t -> nozzle] = TRUE;
+        t -> part++;
+        if (t -> nozzle + 1 < t -> nozzles && t -> part < t -> parts)
+        {
+            t -> nozzle++;
+            return MOVE_TO_FEEDER;
+        }
+        t -> check_nozzle = t -> nozzle;
+        return MOVE_TO_CAMERA;
+    }
+
+    t -> held[t -> nozzle] = FALSE;
+    for (int n = t -> nozzle + 1; n < t -> nozzles; n++)
+    {
+        if (!t -> held[n]) continue;
+        t -> nozzle = n;
+        return MOVE_TO_PCB;
+    }
+    t -> placing = FALSE;
+    t -> nozzle = 0;
+    return t -> part == t -> parts ? MOVE_TO_HOME : MOVE_TO_FEEDER;
+}
+
+#define DISPATCH_CASE(number, name, next) case number: state = on##number(t); break;
+#define HANDLER_ENTRY(number, name, next) on##number,
+
+int (*const state_handler[NUMBER_OF_STATES])(Trip*) = {STATE_TABLE(HANDLER_ENTRY)};
+
+/*
+ Function: nanoseconds
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the monotonic clock
+ Argument(s): none
+ Return Value: the time in ns
+ Usage: double start = nanoseconds();
+ */
+double nanoseconds()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ Function: runSwitch
+ -------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: runs the model state machine with a switch over the states, as the controller does
+ Argument(s):
+ Trip *t - the state of the model, starting at HOME
+ long dispatches - the number of states to run
+ int check - TRUE to check every change of state against the transition table
+ long *bad - incremented for each change of state not in the table
+ Return Value: a checksum of the states visited
+ Usage: sum = runSwitch(&trip, n, FALSE, &bad);
+ */
+unsigned long runSwitch(Trip *t, long dispatches, int check, long *bad)
+{
+    int state = HOME, previous_state;
+    unsigned long sum = 0;
+
+    for (long i = 0; i < dispatches; i++)
+    {
+        previous_state = state;
+        switch (state)
+        {
+            STATE_TABLE(DISPATCH_CASE)
+        }
+        if (check && !IS_STATE_TRANSITION(previous_state, state)) (*bad)++;
+        sum = sum * 31 + state;
+    }
+    return sum;
+}
+
+/*
+ Function: runTable
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: runs the model state machine through the table of pointers to the state handlers
+ Argument(s):
+ Trip *t - the state of the model, starting at HOME
+ long dispatches - the number of states to run
+ Return Value: a checksum of the states visited
+ Usage: sum = runTable(&trip, n);
+ */
+unsigned long runTable(Trip *t, long dispatches)
+{
+    int state = HOME;
+    unsigned long sum = 0;
+
+    for (long i = 0; i < dispatches; i++)
+    {
+        state = state_handler[state](t);
+        sum = sum * 31 + state;
+    }
+    return sum;
+}
+
+/*
+ * heldWithProfileCount, heldWithFixedCount - count the parts on the head, the first with the nozzle count of the machine
+ * profile as the controller is normally built, the second with the constant a FIXED_NUMBER_OF_NOZZLES build uses
+ */
+int heldWithProfileCount(const int held[])
+{
+    int count = 0;
+    for (int n = 0; n < machine.number_of_nozzles; n++) count += held[n];
+    return count;
+}
+
+int heldWithFixedCount(const int held[])
+{
+    int count = 0;
+    for (int n = 0; n < NUMBER_OF_NOZZLES; n++) count += held[n];
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    long n = 10000000, bad = 0;
+    int repeats = 10, error_percent = 5;
+    const char method_name[3][24] = {"switch", "switch and check", "handler table"};
+    double best[5];
+    unsigned long sum[3] = {0, 0, 0};
+    volatile long sink = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) n = atol(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) error_percent = atoi(argv[++i]);
+        else
+        {
+            printf("usage: %s [-n dispatches] [-r repeats] [-e pick error percent]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (n < 1 || repeats < 1 || error_percent < 0 || error_percent > 100) return 1;
+
+    defaultMachineProfile(&machine);
+    for (int k = 0; k < 5; k++) best[k] = INFINITY;
+
+    for (int r = 0; r < repeats; r++)
+    {
+        for (int method = 0; method < 3; method++)
+        {
+            Trip trip = {.nozzles = machine.number_of_nozzles, .parts = 32, .random = 1, .error_percent = error_percent};
+            double t = nanoseconds();
+
+            if (method == 2) sum[method] = runTable(&trip, n);
+            else sum[method] = runSwitch(&trip, n, method == 1, &bad);
+            best[method] = fmin(best[method], nanoseconds() - t);
+        }
+        if (sum[1] != sum[0] || sum[2] != sum[0])
+        {
+            printf("the dispatch methods visited different states\n");
+            return 3;
+        }
+
+        int held[MAX_NUMBER_OF_NOZZLES] = {0};
+        double t = nanoseconds();
+        for (long i = 0; i < n; i++)
+        {
+            held[i % NUMBER_OF_NOZZLES] ^= 1;
+            sink += heldWithProfileCount(held);
+        }
+        best[3] = fmin(best[3], nanoseconds() - t);
+
+        t = nanoseconds();
+        for (long i = 0; i < n; i++)
+        {
+            held[i % NUMBER_OF_NOZZLES] ^= 1;
+            sink += heldWithFixedCount(held);
+        }
+        best[4] = fmin(best[4], nanoseconds() - t);
+    }
+    if (bad)
+    {
+        printf("%ld changes of state are not in the transition table\n", bad);
+        return 4;
+    }
+
+    printf("%ld dispatches of the autonomous state machine, %d%% missed picks, best of %d repeats\n", n, error_percent, repeats);
+    for (int method = 0; method < 3; method++)
+        printf("%-24s %7.2f ns per dispatch\n", method_name[method], best[method] / n);
+    printf("\nCounting the parts on a %d nozzle head\n", machine.number_of_nozzles);
+    printf("%-24s %7.2f ns per count\n", "profile nozzle count", best[3] / n);
+    printf("%-24s %7.2f ns per count\n", "fixed nozzle count", best[4] / n);
+    return 0;
+}
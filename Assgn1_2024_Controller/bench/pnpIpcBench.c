@@ -0,0 +1,492 @@
+/*
+ *
+ * pnpIpcBench.c - measures the round trip of an instruction between the controller and the simulator through
+ * the shared PnP block, or the PnPSharedV2 block which follows it
+ *
+ * Usage:
+ *   pnpIpcBench [-t seconds] [-n round_trips] [-s segment] [-w handshake] [-c controller_cpu,simulator_cpu]
+ *
+ * The benchmark forks a minimal echo simulator, which accepts each instruction as the simulator of the
+ * assignment does (ready_for_next_instruction cleared, then instruction_to_execute) and is ready again at once,
+ * so only the cost of the handshake is measured. The v2 handshakes pass the instruction through the PnPSharedV2
+ * block instead, with the results written back under its sequence lock as the stand-in simulator does. The controller side issues instructions and waits for each
+ * to be done, for the given time (1 s) or number of round trips (1000000), whichever comes first, for every
+ * combination of
+ *   - segment: "file", a memory mapped file as pnp_shared_file is, "shm", a POSIX shm_open() segment, or "huge",
+ *     an anonymous segment on huge pages, which is skipped if none are reserved (/proc/sys/vm/nr_hugepages)
+ *   - pinning: both sides free to run on any CPU, or pinned to different CPUs, the first two the benchmark
+ *     may use unless -c is given
+ *   - handshake: see the handshake table below, new handshakes are added there
+ * and reports the p50, p99 and p999 latency, the worst, and the instructions per second. -s and -w select one.
+ *
+ * Platform: Any POSIX compliant platform, pinning and huge pages need Linux
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../pnpShared.h"
+
+#define IPC_BENCH_FILE "pnp_ipc_bench_file"
+#define IPC_BENCH_SHM "/pnp_ipc_bench"
+#define IPC_BENCH_HUGE_PAGE (2 * 1024 * 1024)
+#define IPC_BENCH_SIMULATOR_POLL_US 100        // the idle poll interval of the stand-in simulator
+
+#define SEGMENT_FILE 0
+#define SEGMENT_SHM 1
+#define SEGMENT_HUGE 2
+#define NUMBER_OF_SEGMENTS 3
+
+const char segment_name[NUMBER_OF_SEGMENTS][8] = {"file", "shm", "huge"};
+
+/* one way of passing an instruction to the simulator and finding out that it has been done */
+typedef struct
+{
+    const char *name;
+    const char *description;
+    int notifies;                                       // TRUE if the simulator writes a byte to the notify pipe when ready
+    void (*issue)(volatile PnP*);                       // controller side, passes an instruction
+    void (*await)(volatile PnP*, int);                  // controller side, returns once it is done, given the read end of the pipe
+    void (*serve)(volatile PnP*, int, int);             // simulator side, echoes instructions until quit, given the write end and notifies
+
+} Handshake;
+
+/*
+ Function: nanoseconds
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the monotonic clock
+ Argument(s): none
+ Return Value: the time in ns
+ Usage: double start = nanoseconds();
+ */
+double nanoseconds()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * issueInstruction - passes a rotation of nozzle 0 as rotateNozzle() does, the arguments then the instruction
+ */
+void issueInstruction(volatile PnP *pnp)
+{
+    pnp -> instruction_argument_1 = 0.0;
+    pnp -> instruction_argument_2 = 0.0;
+    pnp -> instruction_argument_3 = 0;
+    pnp -> instruction_to_execute = ROTATE_NOZZLE;
+}
+
+/*
+ * isDone - the test of isSimulatorReadyForNextInstruction()
+ */
+static inline int isDone(volatile PnP *pnp)
+{
+    return (pnp -> instruction_to_execute == NO_INSTRUCTION) && pnp -> ready_for_next_instruction;
+}
+
+/*
+ * awaitSpinning - checks continuously until the instruction is done
+ */
+void awaitSpinning(volatile PnP *pnp, int notify_fd)
+{
+    while (!isDone(pnp));
+}
+
+/*
+ * awaitSleeping - the controller's main loop without notifications: one check straight after issuing,
+ * then a check every 1000 / POLL_LOOP_RATE ms
+ */
+void awaitSleeping(volatile PnP *pnp, int notify_fd)
+{
+    while (!isDone(pnp)) usleep(1000000 / POLL_LOOP_RATE);
+}
+
+/*
+ * awaitNotified - the controller's main loop as waitForEvent() runs it: one check straight after issuing,
+ * then a wait for a byte from the simulator, or 1000 / POLL_LOOP_RATE ms, before checking again
+ */
+void awaitNotified(volatile PnP *pnp, int notify_fd)
+{
+    struct pollfd fds = {.fd = notify_fd, .events = POLLIN};
+    char drain[64];
+
+    while (!isDone(pnp))
+        if (poll(&fds, 1, 1000 / POLL_LOOP_RATE) > 0) read(notify_fd, drain, sizeof(drain));
+}
+
+/*
+ * echoInstruction - accepts an instruction as the simulator of the assignment does, and is ready again at once
+ */
+static inline void echoInstruction(volatile PnP *pnp, int notify_fd, int notifies)
+{
+    char byte = 1;
+
+    pnp -> ready_for_next_instruction = FALSE;
+    pnp -> instruction_to_execute = NO_INSTRUCTION;
+    pnp -> ready_for_next_instruction = TRUE;
+    if (notifies) write(notify_fd, &byte, 1);
+}
+
+/*
+ * serveSpinning - checks for an instruction continuously
+ */
+void serveSpinning(volatile PnP *pnp, int notify_fd, int notifies)
+{
+    while (!pnp -> quit)
+        if (pnp -> instruction_to_execute != NO_INSTRUCTION) echoInstruction(pnp, notify_fd, notifies);
+}
+
+/*
+ * serveSleeping - checks for an instruction every IPC_BENCH_SIMULATOR_POLL_US while idle, as the stand-in simulator does
+ */
+void serveSleeping(volatile PnP *pnp, int notify_fd, int notifies)
+{
+    while (!pnp -> quit)
+    {
+        if (pnp -> instruction_to_execute != NO_INSTRUCTION) echoInstruction(pnp, notify_fd, notifies);
+        else usleep(IPC_BENCH_SIMULATOR_POLL_US);
+    }
+}
+
+/*
+ * sharedV2 - the PnPSharedV2 block of a segment
+ */
+static inline PnPSharedV2 *sharedV2(volatile PnP *pnp)
+{
+    return (PnPSharedV2 *)((char *) pnp + PNP_V2_OFFSET);
+}
+
+/*
+ * issueInstructionV2 - passes a rotation of nozzle 0 through the PnPSharedV2 block as rotateNozzle() does
+ */
+void issueInstructionV2(volatile PnP *pnp)
+{
+    publishInstructionV2(sharedV2(pnp), ROTATE_NOZZLE, 0.0, 0.0, 0);
+}
+
+/*
+ * awaitSpinningV2, awaitNotifiedV2 - as awaitSpinning() and awaitNotified(), with the test of the PnPSharedV2 block
+ */
+void awaitSpinningV2(volatile PnP *pnp, int notify_fd)
+{
+    while (!isInstructionDoneV2(sharedV2(pnp)));
+}
+
+void awaitNotifiedV2(volatile PnP *pnp, int notify_fd)
+{
+    struct pollfd fds = {.fd = notify_fd, .events = POLLIN};
+    char drain[64];
+
+    while (!isInstructionDoneV2(sharedV2(pnp)))
+        if (poll(&fds, 1, 1000 / POLL_LOOP_RATE) > 0) read(notify_fd, drain, sizeof(drain));
+}
+
+/*
+ * echoInstructionV2 - takes an instruction from the PnPSharedV2 block, publishes unchanged results and finishes it,
+ * returns FALSE if there was no instruction
+ */
+static inline int echoInstructionV2(volatile PnP *pnp, int notify_fd, int notifies)
+{
+    static PnPSnapshot results;
+    PnPInstruction taken;
+    unsigned int number = takeInstructionV2(sharedV2(pnp), &taken);
+    char byte = 1;
+
+    if (number == 0) return FALSE;
+    writeSnapshotV2(sharedV2(pnp), &results);
+    finishInstructionV2(sharedV2(pnp), number);
+    if (notifies) write(notify_fd, &byte, 1);
+    return TRUE;
+}
+
+/*
+ * serveSpinningV2, serveSleepingV2 - as serveSpinning() and serveSleeping(), through the PnPSharedV2 block
+ */
+void serveSpinningV2(volatile PnP *pnp, int notify_fd, int notifies)
+{
+    while (!pnp -> quit) echoInstructionV2(pnp, notify_fd, notifies);
+}
+
+void serveSleepingV2(volatile PnP *pnp, int notify_fd, int notifies)
+{
+    while (!pnp -> quit)
+        if (!echoInstructionV2(pnp, notify_fd, notifies)) usleep(IPC_BENCH_SIMULATOR_POLL_US);
+}
+
+/* the handshakes measured, a faster handshake is added here with its controller and simulator sides */
+const Handshake handshake[] = {
+    {"spin", "both sides check continuously, the lower bound of the protocol", FALSE, issueInstruction, awaitSpinning, serveSpinning},
+    {"sleep", "the controller without notifications and the stand-in simulator", FALSE, issueInstruction, awaitSleeping, serveSleeping},
+    {"notify", "the controller woken by SIMULATOR_NOTIFY_FIFO and the stand-in simulator", TRUE, issueInstruction, awaitNotified, serveSleeping},
+    {"v2", "spin through the PnPSharedV2 block, release/acquire publication", FALSE, issueInstructionV2, awaitSpinningV2, serveSpinningV2},
+    {"v2notify", "notify through the PnPSharedV2 block", TRUE, issueInstructionV2, awaitNotifiedV2, serveSleepingV2}};
+
+#define NUMBER_OF_HANDSHAKES ((int) (sizeof(handshake) / sizeof(handshake[0])))
+
+/*
+ Function: mapSegment
+ --------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: creates and maps a shared segment for the PnP, PnPExtension and PnPSharedV2 blocks, before the echo simulator is forked
+ Argument(s):
+ int segment - SEGMENT_FILE, SEGMENT_SHM or SEGMENT_HUGE
+ size_t *size - set to the size mapped
+ Return Value: the segment, or NULL if it could not be created
+ Usage: volatile PnP *pnp = mapSegment(SEGMENT_SHM, &size);
+ */
+volatile PnP *mapSegment(int segment, size_t *size)
+{
+    void *p = MAP_FAILED;
+    int fd = -1;
+
+    *size = PNP_V2_OFFSET + sizeof(PnPSharedV2);
+    if (segment == SEGMENT_FILE) fd = open(IPC_BENCH_FILE, O_CREAT | O_RDWR, 0666);
+    else if (segment == SEGMENT_SHM) fd = shm_open(IPC_BENCH_SHM, O_CREAT | O_RDWR, 0666);
+    if (fd >= 0 && ftruncate(fd, *size) == 0) p = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fd >= 0) close(fd);
+#ifdef MAP_HUGETLB
+    if (segment == SEGMENT_HUGE)
+    {
+        *size = IPC_BENCH_HUGE_PAGE;
+        p = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (p == MAP_FAILED) return NULL;
+    memset(p, 0, PNP_V2_OFFSET + sizeof(PnPSharedV2));
+    ((PnP *) p) -> ready_for_next_instruction = TRUE;
+    return p;
+}
+
+/*
+ Function: unmapSegment
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: unmaps a segment made by mapSegment() and removes its file or shm name
+ Argument(s):
+ int segment - the kind of segment
+ volatile PnP *pnp - the segment
+ size_t size - its size
+ Return Value: none
+ Usage: unmapSegment(SEGMENT_SHM, pnp, size);
+ */
+void unmapSegment(int segment, volatile PnP *pnp, size_t size)
+{
+    munmap((void *) pnp, size);
+    if (segment == SEGMENT_FILE) unlink(IPC_BENCH_FILE);
+    else if (segment == SEGMENT_SHM) shm_unlink(IPC_BENCH_SHM);
+}
+
+/*
+ Function: pinToCpu
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: restricts the calling process to one CPU, or to every CPU in the mask
+ Argument(s):
+ int cpu - the CPU, or -1 for the mask
+ const void *mask - the cpu_set_t the benchmark started with
+ Return Value: 0, or -1 if it could not be set
+ Usage: pinToCpu(1, &all_cpus);
+ */
+int pinToCpu(int cpu, const void *mask)
+{
+#ifdef CPU_SET
+    cpu_set_t set;
+
+    if (cpu < 0) return sched_setaffinity(0, sizeof(cpu_set_t), (const cpu_set_t *) mask);
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(cpu_set_t), &set);
+#else
+    return cpu < 0 ? 0 : -1;
+#endif
+}
+
+/*
+ Function: compareTimes
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: qsort() comparison of two round trip times
+ Argument(s):
+ const void *a, const void *b - the times to compare
+ Return Value: negative, zero or positive as a is shorter than, the same as or longer than b
+ Usage: qsort(times, n, sizeof(double), compareTimes);
+ */
+int compareTimes(const void *a, const void *b)
+{
+    double ta = *(const double *)a, tb = *(const double *)b;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/*
+ Function: printPercentile
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: prints a percentile of sorted round trip times in us, or - if there are too few times to give it
+ Argument(s):
+ const double times[] - the times in ns, shortest first
+ long n - the number of times
+ double fraction - the percentile as a fraction, e.g. 0.999
+ Return Value: none
+ Usage: printPercentile(times, n, 0.99);
+ */
+void printPercentile(const double times[], long n, double fraction)
+{
+    if (n * (1.0 - fraction) < 1.0) printf(" %9s", "-");
+    else printf(" %9.2f", times[(long) (fraction * (n - 1))] / 1e3);
+}
+
+/*
+ Function: measure
+ -----------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: forks the echo simulator on a segment, times round trips with a handshake and prints the results
+ Argument(s):
+ int segment - the kind of segment
+ const Handshake *h - the handshake
+ int controller_cpu, simulator_cpu - the CPUs to pin each side to, or -1 for unpinned
+ const void *mask - the cpu_set_t the benchmark started with
+ double seconds - how long to measure for
+ long max_round_trips - the most round trips to measure
+ double times[] - space for max_round_trips times
+ Return Value: 0, or -1 if the segment could not be made or the simulator forked
+ Usage: measure(SEGMENT_FILE, &handshake[0], 0, 1, &mask, 1.0, 1000000, times);
+ */
+int measure(int segment, const Handshake *h, int controller_cpu, int simulator_cpu, const void *mask, double seconds, long max_round_trips, double times[])
+{
+    size_t size;
+    volatile PnP *pnp = mapSegment(segment, &size);
+    int notify[2];
+    pid_t simulator;
+    long n = 0;
+
+    if (pnp == NULL) return -1;
+    if (pipe(notify) != 0) {unmapSegment(segment, pnp, size); return -1;}
+    fcntl(notify[1], F_SETFL, O_NONBLOCK);
+
+    if ((simulator = fork()) == 0)
+    {
+        close(notify[0]);
+        pinToCpu(simulator_cpu, mask);
+        h -> serve(pnp, notify[1], h -> notifies);
+        _exit(0);
+    }
+    close(notify[1]);
+    if (simulator < 0) {close(notify[0]); unmapSegment(segment, pnp, size); return -1;}
+    pinToCpu(controller_cpu, mask);
+
+    /* the first round trip waits for the simulator to start and is not counted */
+    h -> issue(pnp);
+    h -> await(pnp, notify[0]);
+
+    double start = nanoseconds(), end = start + seconds * 1e9, t = start;
+    while (n < max_round_trips && t < end)
+    {
+        h -> issue(pnp);
+        h -> await(pnp, notify[0]);
+        double done = nanoseconds();
+        times[n++] = done - t;
+        t = done;
+    }
+
+    pnp -> quit = TRUE;
+    waitpid(simulator, NULL, 0);
+    close(notify[0]);
+    unmapSegment(segment, pnp, size);
+    pinToCpu(-1, mask);
+
+    qsort(times, n, sizeof(double), compareTimes);
+    printf("%-7s %-7s %-9s %9ld", segment_name[segment], controller_cpu < 0 ? "no" : "yes", h -> name, n);
+    printPercentile(times, n, 0.5);
+    printPercentile(times, n, 0.99);
+    printPercentile(times, n, 0.999);
+    printf(" %9.2f %12.0f\n", times[n - 1] / 1e3, n / ((t - start) / 1e9));
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = 1.0;
+    long max_round_trips = 1000000;
+    int only_segment = -1, only_handshake = -1, cpu[2] = {-1, -1};
+#ifdef CPU_SET
+    cpu_set_t mask;
+#else
+    int mask = 0;
+#endif
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) max_round_trips = atol(argv[++i]);
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc && sscanf(argv[++i], "%d,%d", &cpu[0], &cpu[1]) == 2);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            for (int s = 0; s < NUMBER_OF_SEGMENTS; s++) if (strcmp(argv[i + 1], segment_name[s]) == 0) only_segment = s;
+            if (only_segment < 0) {printf("unknown segment %s\n", argv[i + 1]); return 1;}
+            i++;
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+        {
+            for (int w = 0; w < NUMBER_OF_HANDSHAKES; w++) if (strcmp(argv[i + 1], handshake[w].name) == 0) only_handshake = w;
+            if (only_handshake < 0) {printf("unknown handshake %s\n", argv[i + 1]); return 1;}
+            i++;
+        }
+        else
+        {
+            printf("usage: %s [-t seconds] [-n round_trips] [-s file|shm|huge] [-w handshake] [-c controller_cpu,simulator_cpu]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (seconds <= 0 || max_round_trips < 1) return 1;
+
+    double *times = malloc(max_round_trips * sizeof(double));
+    if (times == NULL) {printf("not enough memory for %ld round trips\n", max_round_trips); return 2;}
+
+    /* pin to the first two CPUs the benchmark may use, unless others were given */
+#ifdef CPU_SET
+    sched_getaffinity(0, sizeof(mask), &mask);
+    for (int c = 0, found = 0; cpu[0] < 0 && c < CPU_SETSIZE && found < 2; c++)
+        if (CPU_ISSET(c, &mask)) cpu[found++] = c;
+    if (cpu[1] < 0) cpu[0] = -1;
+#endif
+    for (int w = 0; w < NUMBER_OF_HANDSHAKES; w++)
+        if (only_handshake < 0 || only_handshake == w) printf("%-8s %s\n", handshake[w].name, handshake[w].description);
+    if (cpu[0] < 0) printf("Fewer than two CPUs to pin to, only unpinned round trips are measured\n");
+    else printf("Pinned round trips run the controller on CPU %d and the simulator on CPU %d\n", cpu[0], cpu[1]);
+    printf("\n%-7s %-7s %-9s %9s %9s %9s %9s %9s %12s\n", "segment", "pinned", "handshake", "trips", "p50 us", "p99 us", "p999 us", "worst us", "per second");
+
+    for (int s = 0; s < NUMBER_OF_SEGMENTS; s++)
+    {
+        if (only_segment >= 0 && only_segment != s) continue;
+        for (int pinned = 0; pinned < 2; pinned++)
+        {
+            if (pinned && cpu[0] < 0) continue;
+            for (int w = 0; w < NUMBER_OF_HANDSHAKES; w++)
+            {
+                if (only_handshake >= 0 && only_handshake != w) continue;
+                if (measure(s, &handshake[w], pinned ? cpu[0] : -1, pinned ? cpu[1] : -1, &mask, seconds, max_round_trips, times) != 0)
+                {
+                    printf("%-7s %-7s %-9s skipped, ", segment_name[s], pinned ? "yes" : "no", handshake[w].name);
+                    if (s == SEGMENT_HUGE) printf("no huge pages are reserved\n");
+                    else perror("the segment could not be made");
+                }
+            }
+        }
+    }
+    free(times);
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ *
+ * pnpKernelBench.c - compares the scalar, SSE2 and AVX2 versions of the planner's distance and cost kernels
+ *
+ * Usage:
+ *   pnpKernelBench [-n points] [-r repeats]
+ *
+ * Each kernel is run on n random points repeats times at each level the processor supports, the fastest
+ * run is reported in ns per point along with the speed up over the scalar version. The results of every
+ * level are checked against the scalar version, including the index nearestPoint() returns for a point
+ * at each of NEAREST_QUERIES places on the board. The nearest neighbour planner is then timed on a board
+ * of n parts at each level, and its order checked against that of the scalar version.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpKernels.h"
+#include "../pnpPlanner.h"
+
+#define NEAREST_QUERIES 1000    // points whose nearest is checked, half of them on a point of the board
+
+/*
+ Function: nanoseconds
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the monotonic clock
+ Argument(s): none
+ Return Value: the time in ns
+ Usage: double start = nanoseconds();
+ */
+double nanoseconds()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 100000, repeats = 20;
+    const char kernel_name[4][24] = {"pointDistances", "pointChebyshevCosts", "pathLength", "nearestPoint"};
+    double best[NUMBER_OF_KERNEL_LEVELS][4];
+    volatile double sink = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) n = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else
+        {
+            printf("usage: %s [-n points] [-r repeats]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (n < 1 || repeats < 1) return 1;
+
+    double *x = malloc(n * sizeof(double)), *y = malloc(n * sizeof(double));
+    double *out = malloc(n * sizeof(double)), *reference = malloc(n * sizeof(double)), *reference_chebyshev = malloc(n * sizeof(double));
+    int *order = malloc(n * sizeof(int)), *reference_order = malloc(n * sizeof(int));
+    double query_x[NEAREST_QUERIES], query_y[NEAREST_QUERIES];
+    int reference_query_nearest[NEAREST_QUERIES];
+    if (x == NULL || y == NULL || out == NULL || reference == NULL || reference_chebyshev == NULL || order == NULL || reference_order == NULL)
+    {
+        printf("not enough memory for %d points\n", n);
+        return 2;
+    }
+
+    srand(1);
+    defaultMachineProfile(&machine);
+    for (int i = 0; i < n; i++)
+    {
+        x[i] = 100.0 + 400.0 * rand() / RAND_MAX;
+        y[i] = 100.0 + 400.0 * rand() / RAND_MAX;
+    }
+    for (int q = 0; q < NEAREST_QUERIES; q++)
+    {   //a point of the board is at distance 0, the others are where ties and rounding differences are likeliest
+        query_x[q] = (q % 2) ? x[rand() % n] : 100.0 + 400.0 * rand() / RAND_MAX;
+        query_y[q] = (q % 2) ? y[rand() % n] : 100.0 + 400.0 * rand() / RAND_MAX;
+    }
+
+    selectKernels(KERNELS_SCALAR);
+    pointDistances(machine.camera_x, machine.camera_y, x, y, n, reference);
+    pointChebyshevCosts(machine.camera_x, machine.camera_y, x, y, n, 1.0, 0.5, reference_chebyshev);
+    double reference_length = pathLength(x, y, n);
+    int reference_nearest = nearestPoint(300.0, 300.0, x, y, n, NULL);
+    for (int q = 0; q < NEAREST_QUERIES; q++) reference_query_nearest[q] = nearestPoint(query_x[q], query_y[q], x, y, n, NULL);
+
+    printf("%d points, %d repeats, best of each kernel in ns per point\n", n, repeats);
+    printf("%-22s", "");
+    for (int level = 0; level < NUMBER_OF_KERNEL_LEVELS; level++) printf("%16s", kernelsName(level));
+    printf("\n");
+
+    int levels = 0;
+    for (int level = 0; level < NUMBER_OF_KERNEL_LEVELS && selectKernels(level) == level; level++, levels++)
+    {
+        double error = 0;
+
+        for (int k = 0; k < 4; k++) best[level][k] = INFINITY;
+        for (int r = 0; r < repeats; r++)
+        {
+            double t = nanoseconds();
+            pointDistances(machine.camera_x, machine.camera_y, x, y, n, out);
+            best[level][0] = fmin(best[level][0], nanoseconds() - t);
+            for (int i = 0; i < n; i++) error = fmax(error, fabs(out[i] - reference[i]));
+
+            t = nanoseconds();
+            pointChebyshevCosts(machine.camera_x, machine.camera_y, x, y, n, 1.0, 0.5, out);
+            best[level][1] = fmin(best[level][1], nanoseconds() - t);
+            for (int i = 0; i < n; i++) error = fmax(error, fabs(out[i] - reference_chebyshev[i]));
+
+            t = nanoseconds();
+            sink = pathLength(x, y, n);
+            best[level][2] = fmin(best[level][2], nanoseconds() - t);
+            error = fmax(error, fabs(sink - reference_length) / reference_length);
+
+            t = nanoseconds();
+            sink = nearestPoint(300.0, 300.0, x, y, n, NULL);
+            best[level][3] = fmin(best[level][3], nanoseconds() - t);
+            if ((int) sink != reference_nearest) error = INFINITY;
+        }
+        if (error > 1e-9)
+        {
+            printf("%s kernels differ from the scalar kernels, error %g\n", kernelsName(level), error);
+            return 3;
+        }
+        for (int q = 0; q < NEAREST_QUERIES; q++)
+        {
+            int nearest = nearestPoint(query_x[q], query_y[q], x, y, n, NULL);
+            if (nearest != reference_query_nearest[q])
+            {
+                printf("%s nearestPoint() returns %d for (%.6f, %.6f), the scalar version %d\n", kernelsName(level), nearest,
+                       query_x[q], query_y[q], reference_query_nearest[q]);
+                return 3;
+            }
+        }
+    }
+
+    for (int k = 0; k < 4; k++)
+    {
+        printf("%-22s", kernel_name[k]);
+        for (int level = 0; level < levels; level++)
+            printf("%9.2f (%4.1fx)", best[level][k] / n, best[KERNELS_SCALAR][k] / best[level][k]);
+        printf("\n");
+    }
+
+    /* the nearest neighbour planner without the spatial index, where nearestPoint() does nearly all the work */
+    PlacementStore store;
+    nearest_scan_limit = n;
+    placementStoreInit(&store);
+    for (int i = 0; i < n; i++) placementStoreAdd(&store, "U", "0603", 0, x[i], y[i], 0, rand() % NUMBER_OF_FEEDERS);
+    printf("%-22s", "orderPlacementsNearest");
+    for (int level = 0; level < levels; level++)
+    {
+        selectKernels(level);
+        double t = nanoseconds();
+        orderPlacementsNearest(&store, level == KERNELS_SCALAR ? reference_order : order);
+        printf("%13.1f ms", (nanoseconds() - t) / 1e6);
+        if (level != KERNELS_SCALAR && memcmp(order, reference_order, n * sizeof(int)) != 0)
+        {
+            printf("\n%s kernels plan another order than the scalar kernels\n", kernelsName(level));
+            return 3;
+        }
+    }
+    printf("\n");
+
+    placementStoreFree(&store);
+    free(x);
+    free(y);
+    free(out);
+    free(reference);
+    free(reference_chebyshev);
+    free(order);
+    free(reference_order);
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*
+ *
+ * pnpPlannerBench.c - measures the planning passes of the controller on large synthetic boards, with the
+ * placement info held in the structure of arrays placement store and in an array of PlacementInfo records
+ *
+ * Usage:
+ *   pnpPlannerBench [-n parts] [-r repeats] [-s seed]
+ *
+ * Each pass is run repeats times and the fastest run is reported, in ns per part.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <math.h>
+#include "../pnpPlanner.h"
+#include "../pnpSpatialIndex.h"
+
+#define BENCH_CENTROID_FILE "pnp_bench_centroid.txt"
+
+const char *bench_footprint[] = {"0402", "0603", "0805", "1206", "SOT23", "SOIC8", "QFP", "TQFP44"};
+
+PlacementInfo *records;             // the array of structures copy of the board
+const PlacementInfo *sort_records;  // the records being sorted by compareRecords()
+
+/*
+ Function: nanoseconds
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the monotonic clock
+ Argument(s): none
+ Return Value: the time in ns
+ Usage: double start = nanoseconds();
+ */
+double nanoseconds()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ Function: compareRecords
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: qsort() comparison of two record indexes, with the ordering of orderPlacements()
+ Argument(s):
+ const void *a, const void *b - the indexes into sort_records to compare
+ Return Value: negative, zero or positive as a sorts before, with or after b
+ Usage: qsort(order, n, sizeof(int), compareRecords);
+ */
+int compareRecords(const void *a, const void *b)
+{
+    int ia = *(const int *)a, ib = *(const int *)b;
+    const PlacementInfo *ra = &sort_records[ia], *rb = &sort_records[ib];
+
+    if (ra -> feeder != rb -> feeder) return ra -> feeder < rb -> feeder ? -1 : 1;
+    if (ra -> y_target != rb -> y_target) return ra -> y_target < rb -> y_target ? -1 : 1;
+    return ia - ib;
+}
+
+/*
+ Function: recordRouteLength
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: routeLength() for the array of structures copy of the board
+ Argument(s):
+ const PlacementInfo r[] - the parts
+ const int order[] - the index of each part in pick order
+ int n - the number of parts
+ Return Value: the travel in mm
+ Usage: double length = recordRouteLength(records, order, n);
+ */
+double recordRouteLength(const PlacementInfo r[], const int order[], int n)
+{
+    double x = machine.home_x, y = machine.home_y, length = 0;
+
+    for (int first = 0; first < n; first += machine.number_of_nozzles)
+    {
+        int last = first + machine.number_of_nozzles < n ? first + machine.number_of_nozzles : n;
+
+        for (int i = first; i < last; i++)
+        {
+            int f = r[order[i]].feeder;
+            double nx = machine.feeder_x[f] - machine.nozzle_x[i - first], ny = machine.feeder_y[f];
+            length += hypot(nx - x, ny - y);
+            x = nx;
+            y = ny;
+        }
+        length += hypot(machine.camera_x - x, machine.camera_y - y);
+        x = machine.camera_x;
+        y = machine.camera_y;
+        /* the placements are sequenced as routeLength() does, ending at the first pick of the next trip */
+        double place_x[MAX_NUMBER_OF_NOZZLES], place_y[MAX_NUMBER_OF_NOZZLES];
+        int sequence[MAX_NUMBER_OF_NOZZLES];
+        for (int i = first; i < last; i++)
+        {
+            place_x[i - first] = r[order[i]].x_target - machine.nozzle_x[i - first];
+            place_y[i - first] = r[order[i]].y_target;
+        }
+        sequenceTrip(place_x, place_y, last - first, x, y,
+                     last < n ? machine.pick_x[0][r[order[last]].feeder] : machine.home_x, last < n ? machine.pick_y[0][r[order[last]].feeder] : machine.home_y, sequence);
+        for (int s = 0; s < last - first; s++)
+        {
+            length += hypot(place_x[sequence[s]] - x, place_y[sequence[s]] - y);
+            x = place_x[sequence[s]];
+            y = place_y[sequence[s]];
+        }
+    }
+    return length + hypot(machine.home_x - x, machine.home_y - y);
+}
+
+/*
+ Function: writeBoard
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes a centroid file for automatic mode with random parts spread over the PCB
+ Argument(s):
+ const char *file_name - the file to write
+ int n - the number of parts
+ Return Value: 0 on success, -1 if the file could not be written
+ Usage: writeBoard(BENCH_CENTROID_FILE, 100000);
+ */
+int writeBoard(const char *file_name, int n)
+{
+    FILE *fp = fopen(file_name, "w");
+
+    if (fp == NULL) return -1;
+    fprintf(fp, "A\n%d\n", n);
+    for (int i = 0; i < n; i++)
+    {
+        int type = rand() % NUMBER_OF_FEEDERS;
+        fprintf(fp, "U%d\t%s\t%d\t%.2f\t%.2f\t%.2f\t%d\n", i, bench_footprint[type % 8], 10 * (type + 1),
+                100.0 + 400.0 * rand() / RAND_MAX, 100.0 + 400.0 * rand() / RAND_MAX, 360.0 * rand() / RAND_MAX - 180.0, type);
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 100000, repeats = 5, operation_mode;
+    unsigned int seed = 1;
+    PlacementStore store;
+    double t, best[7], soa_length = 0, aos_length = 0, grid_length = 0, scan_length = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) n = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = atoi(argv[++i]);
+        else
+        {
+            printf("usage: %s [-n parts] [-r repeats] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (n < 1 || repeats < 1) return 1;
+
+    srand(seed);
+    defaultMachineProfile(&machine);
+    if (writeBoard(BENCH_CENTROID_FILE, n) != 0) {perror("writing of benchmark board failed"); return 2;}
+
+    int *order = malloc(n * sizeof(int));
+    records = malloc(n * sizeof(PlacementInfo));
+    if (order == NULL || records == NULL) {printf("not enough memory for %d parts\n", n); return 2;}
+    placementStoreInit(&store);
+
+    for (int p = 0; p < 7; p++) best[p] = INFINITY;
+    for (int r = 0; r < repeats; r++)
+    {
+        t = nanoseconds();
+        if (loadPlacementStore(BENCH_CENTROID_FILE, &operation_mode, &store) != CENTROID_FILE_PRESENT_AND_READ) {printf("benchmark board unreadable\n"); return 2;}
+        best[0] = fmin(best[0], nanoseconds() - t);
+
+        /* the array of structures copy is built from the store, so both hold the same board */
+        for (int i = 0; i < n; i++)
+        {
+            snprintf(records[i].component_designation, sizeof(records[i].component_designation), "%s", placementDesignation(&store, i));
+            snprintf(records[i].component_footprint, sizeof(records[i].component_footprint), "%s", placementFootprint(&store, i));
+            records[i].component_value = store.value[i];
+            records[i].x_target = store.x[i];
+            records[i].y_target = store.y[i];
+            records[i].theta_target = store.theta[i];
+            records[i].feeder = store.feeder[i];
+        }
+
+        t = nanoseconds();
+        orderPlacements(&store, order);
+        best[1] = fmin(best[1], nanoseconds() - t);
+
+        t = nanoseconds();
+        soa_length = routeLength(&store, order, n);
+        best[2] = fmin(best[2], nanoseconds() - t);
+
+        t = nanoseconds();
+        for (int i = 0; i < n; i++) order[i] = i;
+        sort_records = records;
+        qsort(order, n, sizeof(int), compareRecords);
+        best[3] = fmin(best[3], nanoseconds() - t);
+
+        t = nanoseconds();
+        aos_length = recordRouteLength(records, order, n);
+        best[4] = fmin(best[4], nanoseconds() - t);
+
+        nearest_scan_limit = NEAREST_SCAN_LIMIT;
+        t = nanoseconds();
+        orderPlacementsNearest(&store, order);
+        best[5] = fmin(best[5], nanoseconds() - t);
+        grid_length = routeLength(&store, order, n);
+
+        /* the linear scan is quadratic, only time it once on large boards */
+        if (r == 0 || n <= 10000)
+        {
+            nearest_scan_limit = n;
+            t = nanoseconds();
+            orderPlacementsNearest(&store, order);
+            best[6] = fmin(best[6], nanoseconds() - t);
+            scan_length = routeLength(&store, order, n);
+        }
+    }
+
+    printf("%d parts, %d repeats, best of each pass in ns per part\n", n, repeats);
+    printf("  load centroid file (store)      %8.1f\n", best[0] / n);
+    printf("  order parts        (store)      %8.1f\n", best[1] / n);
+    printf("  route length       (store)      %8.1f  %.0f mm\n", best[2] / n, soa_length);
+    printf("  order parts        (records)    %8.1f\n", best[3] / n);
+    printf("  route length       (records)    %8.1f  %.0f mm\n", best[4] / n, aos_length);
+    printf("  nearest neighbour order (grid)  %8.1f  %.0f mm, %.1f ms\n", best[5] / n, grid_length, best[5] / 1e6);
+    printf("  nearest neighbour order (scan)  %8.1f  %.0f mm, %.1f ms\n", best[6] / n, scan_length, best[6] / 1e6);
+    printf("  planning memory per part: store %zu bytes, records %zu bytes\n",
+           3 * sizeof(double) + sizeof(int), sizeof(PlacementInfo));
+
+    remove(BENCH_CENTROID_FILE);
+    placementStoreFree(&store);
+    free(records);
+    free(order);
+    return 0;
+}
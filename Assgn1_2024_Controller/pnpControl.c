@@ -11,82 +11,156 @@
  *
  */
 
-#include "pnpControl.h"
-
-// state names and numbers
-#define HOME                0
-#define MOVE_TO_FEEDER      1
-#define WAIT_1              2
-#define LOWER_CNTR_NOZZLE   3       //lowering the centre nozzle
-#define VAC_CNTR_NOZZLE     4       //applying the vacuum for the centre nozzle
-#define RAISE_CNTR_NOZZLE   5       //raising the centre nozzle
-#define MOVE_TO_CAMERA      6
-#define LOOK_UP_PHOTO       7
-#define MOVE_TO_PCB         8
-#define LOOK_DOWN_PHOTO     9
-#define CHECK_ERROR         10
-#define CORRECT_ERRORS      11
-#define MOVE_TO_HOME        12
-#define FIX_NOZZLE_ERROR    13
-#define FIX_PREPLACE_ERROR  14
-#define LOWER_LEFT_NOZZLE   15
-#define VAC_LEFT_NOZZLE     16
-#define RAISE_LEFT_NOZZLE   17
-#define LOWER_RIGHT_NOZZLE  18
-#define VAC_RIGHT_NOZZLE    19
-#define RAISE_RIGHT_NOZZLE  20
+#include "pnpPlanner.h"
+#include "pnpRecovery.h"
+#include "pnpJournal.h"
+#include "pnpTeach.h"
+#include "pnpTrip.h"
+#include "pnpPeephole.h"
+#include "pnpStates.h"
+#include "pnpRemote.h"
+#include "pnpTelemetry.h"
 
 #define holdingpart         1
 #define not_holdingpart     0
 
-/* state_names of up to 19 characters (the 20th character is a null terminator), only required for display purposes */
-const char state_name[21][20] = {"HOME               ",
-                                "MOVE TO FEEDER     ",
-                                "WAIT 1             ",
-                                "LOWER CNTR NOZZLE  ",
-                                "VAC CNTR NOZZLE    ",
-                                "RAISE CNTR NOZZLE  ",
-                                "MOVE TO CAMERA     ",
-                                "LOOK UP PHOTO      ",
-                                "MOVE TO PCB        ",
-                                "LOOK DOWN PHOTO    ",
-                                "CHECK ERROR        ",
-                                "CORRECT ERRORS     ",
-                                "MOVE TO HOME       ",
-                                "FIX NOZZLE ERROR   ",
-                                "FIX PREPLACE ERROR ",
-                                "LOWER LEFT NOZZLE  ",
-                                "VAC LEFT NOZZLE    ",
-                                "RAISE LEFT NOZZLE  ",
-                                "LOWER RIGHT NOZZLE ",
-                                "VAC RIGHT NOZZLE   ",
-                                "RAISE RIGHT NOZZLE "};
-
-const double TAPE_FEEDER_X[NUMBER_OF_FEEDERS] = {FDR_0_X, FDR_1_X, FDR_2_X, FDR_3_X, FDR_4_X, FDR_5_X, FDR_6_X, FDR_7_X, FDR_8_X, FDR_9_X};
-const double TAPE_FEEDER_Y[NUMBER_OF_FEEDERS] = {FDR_0_Y, FDR_1_Y, FDR_2_Y, FDR_3_Y, FDR_4_Y, FDR_5_Y, FDR_6_Y, FDR_7_Y, FDR_8_Y, FDR_9_Y};
-
-const char nozzle_name[3][10] = {"left", "centre", "right"};
-
-
-int main()
+#define PRE_ROTATE_TOLERANCE 0.01   // degrees, a nozzle this close to the angle of its part is not turned before the pick
+
+/* the names of the states and the states each may move to, see pnpStates.h */
+const char state_name[NUMBER_OF_STATES][20] = {STATE_TABLE(STATE_NAME)};
+
+const unsigned int state_transitions[NUMBER_OF_STATES] = {STATE_TABLE(STATE_TRANSITIONS)};
+
+const char nozzle_name[NUMBER_OF_NOZZLES][16] = {"left nozzle", "centre nozzle", "right nozzle"};
+
+const char plan_name[3][20] = {"feeder and y", "nearest neighbour", "gang pick"};
+
+
+/*
+ * printComponentOrder - display the details of the parts in the order they will be picked
+ */
+void printComponentOrder(const PlacementStore *store, const int component_list[])
+{
+    int component_num;
+    for (int i = 0; i < store -> count; i++)
+    {
+        component_num = component_list[i];
+        printf("Part %d:\nDesignation: %s  Footprint: %s  Value: %.2f  x: %.2f  y: %.2f  theta: %.2f  Feeder: %d\n\n", component_num,
+            placementDesignation(store, component_num), placementFootprint(store, component_num), store -> value[component_num],
+            store -> x[component_num], store -> y[component_num], store -> theta[component_num], store -> feeder[component_num]);
+
+    }
+}
+
+
+/*
+ * nozzleName - the name of a nozzle of the head for display, the nozzles of the simulated head are named by position
+ */
+const char *nozzleName(int nozzle)
+{
+    static char name[MAX_NUMBER_OF_NOZZLES][20];
+
+    if (HEAD_NOZZLES == NUMBER_OF_NOZZLES) return nozzle_name[nozzle];
+    snprintf(name[nozzle], sizeof(name[nozzle]), "nozzle %d", nozzle);
+    return name[nozzle];
+}
+
+
+/*
+ * firstRejectNozzle - the first nozzle holding a part to drop in the reject bin, or -1 if there is none
+ */
+int firstRejectNozzle(const char nozzle_reject[])
+{
+    for (int n = 0; n < HEAD_NOZZLES; n++) if (nozzle_reject[n]) return n;
+    return -1;
+}
+
+
+/*
+ * countHeldParts - the number of nozzles holding a part to place
+ */
+int countHeldParts(const char nozzle_status[])
 {
+    int count = 0;
+    for (int n = 0; n < HEAD_NOZZLES; n++) if (nozzle_status[n] == holdingpart) count++;
+    return count;
+}
+
+
+/*
+ * turnNozzle - turns a nozzle to an angle, and returns the turn. The machine turns a nozzle by the angle it is given, so the
+ * nozzle is sent the shortest way round from its angle, which the look-up photo resets, see resetNozzleAngles()
+ */
+double turnNozzle(int nozzle, double theta, double nozzle_theta[])
+{
+    double turn = shortestTurn(nozzle_theta[nozzle], theta);
+
+    nozzle_theta[nozzle] += turn;
+    rotateNozzle(nozzle, turn);
+    return turn;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int resume = FALSE;  //continue the job interrupted in the journal, rather than starting at the first part
+    int quit_when_finished = FALSE;  //quit once the job is placed, for unattended runs such as training builds
+    int coroutines = FALSE;  //place an automatic mode job with the coroutines of pnpTrip.c rather than the state machine
+    int usage = FALSE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0) resume = TRUE;
+        else if (strcmp(argv[i], "-q") == 0) quit_when_finished = TRUE;
+        else if (strcmp(argv[i], "-c") == 0) coroutines = TRUE;
+        else if (strcmp(argv[i], "-n") == 0) setPeepholeOptimiser(FALSE);
+        else usage = TRUE;
+    }
+    if (usage || (resume && coroutines))
+    {  //the coroutine job is not journalled, so it cannot resume one
+        printf("usage: %s [-r | -c] [-q] [-n]\n  -r  resume the job recorded in %s from where it was interrupted\n"
+               "  -q  quit when the job is finished in automatic mode, rather than waiting for q\n"
+               "  -c  place an automatic mode job with the coroutine runtime, without the journal or remote control, so not with -r\n"
+               "  -n  pass every instruction to the simulator as it is generated, without the peephole optimiser\n", argv[0], JOURNAL_FILE);
+        return 1;
+    }
+
     pnpOpen();
+    telemetryOpen();  //the controller runs without the telemetry block for monitors if it cannot be mapped
 
     int operation_mode, number_of_components_to_place, res;
-    PlacementInfo pi[MAX_NUMBER_OF_COMPONENTS_TO_PLACE];
+    PlacementStore placements;
+
+    /* read the machine profile, the default geometry is used if there is no profile file */
+    res = loadMachineProfile(MACHINE_PROFILE_FILE, &machine);
+    if (res == MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE)
+    {
+        printf("Problem with machine profile, error code %d, press any key to continue\n", res);
+        getchar();
+        telemetryClose();
+        exit(res);
+    }
+    printMachineProfile(&machine);
 
     /*
      * read the centroid file to obtain the operation mode, number of components to place
      * and the placement information for those components
      */
-    res = getCentroidFileContents(&operation_mode, &number_of_components_to_place, pi);
+    placementStoreInit(&placements);
+    res = loadPlacementStore(CENTROID_FILE, &operation_mode, &placements);
+    number_of_components_to_place = placements.count;
 
     if (res != CENTROID_FILE_PRESENT_AND_READ)
     {  //throw an error if the centroid file is unreadable or not present
         printf("Problem with centroid file, error code %d, press any key to continue\n", res);
         getchar();
+        telemetryClose();
         exit(res);
     }
+    if (operation_mode == MANUAL_CONTROL || !coroutines)
+    {  //the coroutine job takes no remote commands, so it does not listen for any
+        remoteOpen();  //the controller runs without the remote endpoint if the socket cannot be created
+    }
 
     /*
     **********************************************
@@ -98,43 +172,90 @@ int main()
     if (operation_mode == MANUAL_CONTROL)
     {
         /* initialization of variables and controller window */
-        int state = HOME, finished = FALSE, part_counter = 0;
-        char c, part_placed, NozzleStatus = not_holdingpart;
+        int state = HOME, previous_state, finished = (number_of_components_to_place == 0), part_counter = 0;
+        char c, part_placed = FALSE, NozzleStatus = not_holdingpart;
+        ControllerStatus status = {.operation_mode = MANUAL_CONTROL, .number_of_nozzles = NUMBER_OF_NOZZLES, .number_of_components_to_place = number_of_components_to_place, .job_start_time = getSimulationTime()};
+        RemoteCommand command;
         double requested_theta = 0;  //the required angle theta of the nozzle position
+        double nozzle_theta[MAX_NUMBER_OF_NOZZLES] = {0};  //the angle of each nozzle since the last look-up photo, see turnNozzle()
         double preplace_diff_x = 0, preplace_diff_y = 0;  //difference in required gantry position and actual gantry position for preplacement
+        int feeder_at = NO_TAPE_FEEDER_AT_THIS_LOCATION;  //the feeder the head was last sent to, recorded with each pick
+        int assisting = FALSE, pick;  //TRUE while the machine runs the pick, inspect, correct and place macro for the current part
+        int ready;  //read once by the states which branch on it, a second read could find the simulator ready only for the second branch
+        char lookup_photo = FALSE;  //TRUE after an assisted look-up photo, whose pick is checked as in automatic mode
+        int part_keys = 0, keys[2] = {0}, parts[2] = {0};  //key presses and parts placed by hand [0] and assisted [1]
+        long long part_start_us = 0;  //wall clock time the operator started on the current part, operator latency included
+        double seconds[2] = {0};
+        TeachSummary taught;
+
+        //the session is recorded in the teach log and compiled into an automatic mode job when the operator quits
+        if (teachOpen(TEACH_FILE, &placements, getSimulationTime()) != 0) printf("WARNING  cannot create %s, the session is not recorded\n", TEACH_FILE);
 
         printf("Time: %7.2f  Initial state: %.15s  Operating in manual control mode, there are %d parts to place\n\n", getSimulationTime(), state_name[HOME], number_of_components_to_place);
         /* print details of part 0 */
+        if (number_of_components_to_place > 0)
         printf("Part 0 details:\nDesignation: %s\nFootprint: %s\nValue: %.2f\nx: %.2f\ny: %.2f\ntheta: %.2f\nFeeder: %d\n\n",
-               pi[0].component_designation, pi[0].component_footprint, pi[0].component_value, pi[0].x_target, pi[0].y_target, pi[0].theta_target, pi[0].feeder);
+               placementDesignation(&placements, 0), placementFootprint(&placements, 0), placements.value[0], placements.x[0], placements.y[0], placements.theta[0], placements.feeder[0]);
 
         /* loop until user quits */
         while(!isPnPSimulationQuitFlagOn())
         {
 
-            c = getKey();  //saves the value of the key pressed by the user
+            previous_state = state;
+            while (getRemoteCommand(&command) != REMOTE_NO_COMMAND)
+            {   //jobs are loaded and started by the operator in manual mode
+                remoteReply(&command, "ERR operating in manual control mode");
+            }
+
+            //saves the value of the key pressed by the user, key presses made while the machine is busy stay queued until it is ready for them
+            c = (state == HOME || state == WAIT_1) ? getKey() : NO_KEY;
+            if (c != NO_KEY && c != 'q' && c != 'Q')
+            {
+                part_keys++;
+                if (part_start_us == 0) part_start_us = monotonicMicroseconds();
+            }
 
             switch (state)
             {
                 case HOME:
                     //gantry in home position, waiting for input by user to initiate movement to feeder
 
-                    if (finished == FALSE && (c == '0' || c == '1' || c == '2' || c == '3' || c == '4' || c == '5' || c == '6' || c == '7' || c == '8' || c == '9'))
+                    if (finished == FALSE && (c >= '0' && c <= '9') && (c - '0') < machine.number_of_feeders)
                     {
                         //check if user inputs a feeder number that is not next in the centroid file
-                        if ((c - '0') != pi[part_counter].feeder)
+                        if ((c - '0') != placements.feeder[part_counter])
                         {   /* the expression (c - '0') obtains the integer value of the number key pressed */
-                            printf("Time: %7.2f  WARNING  The next part is in feeder %d.\n", getSimulationTime(), pi[part_counter].feeder);
+                            printf("Time: %7.2f  WARNING  The next part is in feeder %d.\n", getSimulationTime(), placements.feeder[part_counter]);
                         }
-                            setTargetPos(TAPE_FEEDER_X[c - '0'], TAPE_FEEDER_Y[c - '0']);
+                            setTargetPos(machine.feeder_x[c - '0'], machine.feeder_y[c - '0']);
+                            teachRecord(TEACH_MOVE, part_counter, machine.feeder_x[c - '0'], machine.feeder_y[c - '0'], getSimulationTime());
+                            feeder_at = c - '0';
                             state = MOVE_TO_FEEDER;
                             printf("Time: %7.2f  New state: %.20s  Issued instruction to move to tape feeder %c\n", getSimulationTime(), state_name[state], c);
                     }
+                    //'g' to have the machine pick the part from its feeder, inspect it, correct it and place it
+                    else if (finished == FALSE && c == 'g')
+                    {
+                        assisting = TRUE;
+                        feeder_at = placements.feeder[part_counter];
+                        setTargetPos(machine.feeder_x[feeder_at], machine.feeder_y[feeder_at]);
+                        teachRecord(TEACH_MOVE, part_counter, machine.feeder_x[feeder_at], machine.feeder_y[feeder_at], getSimulationTime());
+                        state = MOVE_TO_FEEDER;
+                        printf("Time: %7.2f  New state: %.20s  Assisting, placing part %d from tape feeder %d\n", getSimulationTime(), state_name[state], part_counter, feeder_at);
+                    }
                     break;
 
                 case MOVE_TO_FEEDER:
                     //waiting for the simulator to complete movement of the gantry
-                    if (isSimulatorReadyForNextInstruction())
+                    ready = isSimulatorReadyForNextInstruction();
+                    if (ready && assisting)
+                    {
+                        lowerNozzle(CENTRE_NOZZLE);
+                        teachRecord(TEACH_PICK, part_counter, feeder_at, 0, getSimulationTime());
+                        state = LOWER_CNTR_NOZZLE;
+                        printf("Time: %7.2f  New state: %.20s  Arrived at feeder. Lowering centre nozzle to pick up part\n", getSimulationTime(), state_name[state]);
+                    }
+                    else if (ready)
                     {
                         state = WAIT_1;
                         printf("Time: %7.2f  New state: %.20s  Arrived at feeder, waiting for next instruction\n", getSimulationTime(), state_name[state]);
@@ -146,6 +267,7 @@ int main()
                     if((c == 'p') && (NozzleStatus == not_holdingpart))  //checking if the nozzle is empty
                     {
                         lowerNozzle(CENTRE_NOZZLE);
+                        teachRecord(TEACH_PICK, part_counter, feeder_at, 0, getSimulationTime());
                         state = LOWER_CNTR_NOZZLE;
                         printf("Time: %7.2f  New state: %.20s  Issued instruction to pick up part. Lowering centre nozzle\n", getSimulationTime(), state_name[state]);
                     }
@@ -154,6 +276,7 @@ int main()
                     else if((c == 'p') && (NozzleStatus == holdingpart))
                     {
                         lowerNozzle(CENTRE_NOZZLE);
+                        teachRecord(TEACH_PLACE, part_counter, 0, 0, getSimulationTime());
                         state = LOWER_CNTR_NOZZLE;
                         printf("Time: %7.2f  New state: %.20s  Issued instruction to place part on PCB. Lowering nozzle\n", getSimulationTime(), state_name[state]);
                     }
@@ -161,7 +284,9 @@ int main()
                     //'c' for camera, should only go to the camera if the nozzle is holding a part
                     else if(c == 'c')
                     {
-                        setTargetPos(LOOKUP_CAMERA_X,LOOKUP_CAMERA_Y);  //the gantry will move to the position above the camera
+                        setTargetPos(machine.camera_x, machine.camera_y);  //the gantry will move to the position above the camera
+                        teachRecord(TEACH_MOVE, part_counter, machine.camera_x, machine.camera_y, getSimulationTime());
+                        feeder_at = NO_TAPE_FEEDER_AT_THIS_LOCATION;
                         state = MOVE_TO_CAMERA;      //after the nozzle picked up a part, send the gantry to the lookup camera
                         printf("Time: %7.2f  New state: %.20s  Issued instruction to move to look-up camera\n", getSimulationTime(), state_name[state]);
                     }
@@ -169,7 +294,8 @@ int main()
                     //'r' for rotate to fix the nozzle misalignment error
                     else if(c == 'r')
                     {
-                        rotateNozzle(CENTRE_NOZZLE, requested_theta);  //rotate the nozzle by the required calculated angle theta
+                        double turn = turnNozzle(CENTRE_NOZZLE, requested_theta, nozzle_theta);  //turn the nozzle the shortest way to the required angle theta
+                        teachRecord(TEACH_ROTATE, part_counter, turn, 0, getSimulationTime());
                         state = CORRECT_ERRORS;
                         printf("Time: %7.2f  New state: %.20s  Correcting part misalignment on nozzle\n", getSimulationTime(), state_name[state]);
                     }
@@ -178,28 +304,52 @@ int main()
                     else if(c == 'a')
                     {
                         amendPos(preplace_diff_x, preplace_diff_y); //corrects the position by the calculated difference x and y
+                        teachRecord(TEACH_AMEND, part_counter, preplace_diff_x, preplace_diff_y, getSimulationTime());
                         state = CORRECT_ERRORS;
                         printf("Time: %7.2f  New state: %.20s  Correcting preplace misalignment of gantry\n", getSimulationTime(), state_name[state]);
                     }
                     // 'h' for home. This will move the gantry back to its home position
                     else if(c == 'h')
                     {
-                        setTargetPos(HOME_X,HOME_Y);
+                        setTargetPos(machine.home_x, machine.home_y);
+                        teachRecord(TEACH_MOVE, part_counter, machine.home_x, machine.home_y, getSimulationTime());
+                        feeder_at = NO_TAPE_FEEDER_AT_THIS_LOCATION;
                         state = MOVE_TO_HOME;
                         printf("Time: %7.2f  New state: %.20s  Moving to home position\n", getSimulationTime(), state_name[state]);
                     }
                     // in case the user pressed the wrong number key and needs to change the feeder
-                    else if (c == '0' || c == '1' || c == '2' || c == '3' || c == '4' || c == '5' || c == '6' || c == '7' || c == '8' || c == '9')
+                    else if ((c >= '0' && c <= '9') && (c - '0') < machine.number_of_feeders)
                     {
                         //check if user inputs a feeder number that is not next in the centroid file
-                        if ((c - '0') != pi[part_counter].feeder)
+                        if ((c - '0') != placements.feeder[part_counter])
                         {   /* the expression (c - '0') obtains the integer value of the number key pressed */
-                            printf("Time: %7.2f             %19s  WARNING  The next part is in feeder %d.\n", getSimulationTime()," ", pi[part_counter].feeder);
+                            printf("Time: %7.2f             %19s  WARNING  The next part is in feeder %d.\n", getSimulationTime()," ", placements.feeder[part_counter]);
                         }
-                            setTargetPos(TAPE_FEEDER_X[c - '0'], TAPE_FEEDER_Y[c - '0']);
+                            setTargetPos(machine.feeder_x[c - '0'], machine.feeder_y[c - '0']);
+                            teachRecord(TEACH_MOVE, part_counter, machine.feeder_x[c - '0'], machine.feeder_y[c - '0'], getSimulationTime());
+                            feeder_at = c - '0';
                             state = MOVE_TO_FEEDER;
                             printf("Time: %7.2f  New state: %.20s  Issued instruction to move to tape feeder %c\n", getSimulationTime(), state_name[state], c);
                     }
+                    //'g' to have the machine finish the part, from its feeder if the nozzle is empty or from the camera if it holds the part
+                    else if ((c == 'g') && (NozzleStatus == not_holdingpart))
+                    {
+                        assisting = TRUE;
+                        feeder_at = placements.feeder[part_counter];
+                        setTargetPos(machine.feeder_x[feeder_at], machine.feeder_y[feeder_at]);
+                        teachRecord(TEACH_MOVE, part_counter, machine.feeder_x[feeder_at], machine.feeder_y[feeder_at], getSimulationTime());
+                        state = MOVE_TO_FEEDER;
+                        printf("Time: %7.2f  New state: %.20s  Assisting, placing part %d from tape feeder %d\n", getSimulationTime(), state_name[state], part_counter, feeder_at);
+                    }
+                    else if ((c == 'g') && (NozzleStatus == holdingpart))
+                    {
+                        assisting = TRUE;
+                        setTargetPos(machine.camera_x, machine.camera_y);
+                        teachRecord(TEACH_MOVE, part_counter, machine.camera_x, machine.camera_y, getSimulationTime());
+                        feeder_at = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+                        state = MOVE_TO_CAMERA;
+                        printf("Time: %7.2f  New state: %.20s  Assisting, placing part %d held by the centre nozzle\n", getSimulationTime(), state_name[state], part_counter);
+                    }
 
                     break;
 
@@ -237,7 +387,16 @@ int main()
                     //once nozzle is raised, if a part hasn't just been placed, then it is determined that a part has just been picked up
                     if (isSimulatorReadyForNextInstruction())
                     {
-                        if (part_placed==FALSE)
+                        if (part_placed==FALSE && assisting)
+                        {   //take the part to the look-up camera to check the pick
+                            NozzleStatus = holdingpart;
+                            setTargetPos(machine.camera_x, machine.camera_y);
+                            teachRecord(TEACH_MOVE, part_counter, machine.camera_x, machine.camera_y, getSimulationTime());
+                            feeder_at = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+                            state = MOVE_TO_CAMERA;
+                            printf("Time: %7.2f  New state: %.20s  Part acquired, moving to look-up camera\n", getSimulationTime(), state_name[state]);
+                        }
+                        else if (part_placed==FALSE)
                         {
                             NozzleStatus = holdingpart;
                             state = WAIT_1;
@@ -249,18 +408,28 @@ int main()
                             NozzleStatus = not_holdingpart;
                             part_placed = FALSE; //variable to change state actions based on whether a part has just been placed or not
                             part_counter++;  //increment counter to keep track of the part number in the centroid file that has been placed
+                            status.parts_placed++;
+                            //the time of a part runs from the placement of the one before, so it includes the operator's latency
+                            parts[assisting]++;
+                            keys[assisting] += part_keys;
+                            seconds[assisting] += (monotonicMicroseconds() - part_start_us) / 1e6;
+                            part_start_us = monotonicMicroseconds();
+                            part_keys = 0;
+                            assisting = FALSE;
                             if (part_counter != number_of_components_to_place)
                             {   //since there are still components to be placed, go back to Home to cycle again. Display the next set of part details
                                 state = HOME;
                                 printf("Time: %7.2f  New state: %.20s  Part %d placed on PCB successfully\n\n", getSimulationTime(), state_name[state], (part_counter-1));
                                 printf("Part %d details:\nDesignation: %s\nFootprint: %s\nValue: %.2f\nx: %.2f\ny: %.2f\ntheta: %.2f\nFeeder: %d\n\n", part_counter,
-                                pi[part_counter].component_designation, pi[part_counter].component_footprint, pi[part_counter].component_value, pi[part_counter].x_target,
-                                pi[part_counter].y_target, pi[part_counter].theta_target, pi[part_counter].feeder);
+                                placementDesignation(&placements, part_counter), placementFootprint(&placements, part_counter), placements.value[part_counter], placements.x[part_counter],
+                                placements.y[part_counter], placements.theta[part_counter], placements.feeder[part_counter]);
                             }
                             else if(part_counter == number_of_components_to_place)
                             {
                                 finished = TRUE;
-                                setTargetPos(HOME_X,HOME_Y);
+                                setTargetPos(machine.home_x, machine.home_y);
+                                teachRecord(TEACH_MOVE, part_counter, machine.home_x, machine.home_y, getSimulationTime());
+                                feeder_at = NO_TAPE_FEEDER_AT_THIS_LOCATION;
                                 state = MOVE_TO_HOME;
                                 printf("Time: %7.2f  New state: %.20s  All parts have been placed! Moving to home\n", getSimulationTime(), state_name[state]);
                             }
@@ -273,15 +442,26 @@ int main()
                     if (isSimulatorReadyForNextInstruction())
                     {
                         takePhoto(PHOTO_LOOKUP);
+                        teachRecord(TEACH_PHOTO, part_counter, PHOTO_LOOKUP, 0, getSimulationTime());
                         state = LOOK_UP_PHOTO;
                         printf("Time: %7.2f  New state: %.20s  Arrived at camera. Taking look-up photo of part\n", getSimulationTime(), state_name[state]);
                     }
                     break;
 
                 case LOOK_UP_PHOTO:
-                    if (isSimulatorReadyForNextInstruction())
+                    ready = isSimulatorReadyForNextInstruction();
+                    if (ready && assisting)
+                    {   //check the pick and correct the part on the nozzle before going to the PCB, as in automatic mode
+                        resetNozzleAngles(nozzle_theta);
+                        lookup_photo = TRUE;
+                        state = CHECK_ERROR;
+                        printf("Time: %7.2f  New state: %.20s  Look-up photo acquired. Checking the pick\n", getSimulationTime(), state_name[state]);
+                    }
+                    else if (ready)
                     {   //once look-up photo is taken, move the gantry to the PCB for part placement
-                        setTargetPos(pi[part_counter].x_target, pi[part_counter].y_target);
+                        resetNozzleAngles(nozzle_theta);
+                        setTargetPos(placements.x[part_counter], placements.y[part_counter]);
+                        teachRecord(TEACH_MOVE, part_counter, placements.x[part_counter], placements.y[part_counter], getSimulationTime());
                         state = MOVE_TO_PCB;
                         printf("Time: %7.2f  New state: %.20s  Look-up photo acquired. Moving to PCB\n", getSimulationTime(), state_name[state]);
                     }
@@ -299,21 +479,84 @@ int main()
                 case LOOK_DOWN_PHOTO:
                     //take the look-down photo, then move on to check for errors
                     takePhoto(PHOTO_LOOKDOWN);
+                    teachRecord(TEACH_PHOTO, part_counter, PHOTO_LOOKDOWN, 0, getSimulationTime());
                     state = CHECK_ERROR;
                     printf("Time: %7.2f  New state: %.20s  Look-down photo acquired. Checking for errors in alignment\n", getSimulationTime(), state_name[state]);
                     break;
 
                 case CHECK_ERROR:
-                    //wait until the look-down photo is taken, then calculate errors
-                    if (isSimulatorReadyForNextInstruction())
+                    //wait until the photo is taken, then calculate errors
+                    ready = isSimulatorReadyForNextInstruction();
+                    if (ready && lookup_photo == TRUE)
+                    {   //a pick automatic mode would retry or reject stops the assist, and the operator takes over
+                        lookup_photo = FALSE;
+                        if ((pick = checkPick(getPickStatus(CENTRE_NOZZLE), getPickErrorTheta(CENTRE_NOZZLE))) != PICK_OK)
+                        {
+                            assisting = FALSE;
+                            if (pick == PICK_MISSED)
+                            {
+                                NozzleStatus = not_holdingpart;
+                                printf("Time: %7.2f             %19s  Part %d missing from centre nozzle, mis-pick from feeder %d\n", getSimulationTime(), " ", part_counter, placements.feeder[part_counter]);
+                            }
+                            else
+                                printf("Time: %7.2f             %19s  Part %d misalignment error: %3.2f is beyond correction\n", getSimulationTime(), " ", part_counter, getPickErrorTheta(CENTRE_NOZZLE));
+                            state = WAIT_1;
+                            printf("Time: %7.2f  New state: %.20s  Assist stopped, waiting for next instruction\n", getSimulationTime(), state_name[state]);
+                        }
+                        else
+                        {
+                            double errortheta = getPickErrorTheta(CENTRE_NOZZLE);  //acquire the part misalignment from the look-up photo
+                            double turn;
+                            requested_theta = placements.theta[part_counter] - errortheta;  //calculate misalignment of the part on the nozzle
+                            turn = turnNozzle(CENTRE_NOZZLE, requested_theta, nozzle_theta);
+                            teachRecord(TEACH_ROTATE, part_counter, turn, 0, getSimulationTime());
+                            state = FIX_NOZZLE_ERROR;
+                            printf("Time: %7.2f             %19s  Part misalignment error: %3.2f  Correction required: %3.2f degrees\n", getSimulationTime(), " ", errortheta, turn);
+                            printf("Time: %7.2f  New state: %.20s  Correction made to centre nozzle for part alignment\n", getSimulationTime(), state_name[state]);
+                        }
+                    }
+                    else if (ready)
                     {
                         double errortheta = getPickErrorTheta(CENTRE_NOZZLE);  //acquire the part misalignment from the look-up photo
-                        requested_theta = pi[part_counter].theta_target - errortheta;  //calculate misalignment of the part on the nozzle
-                        preplace_diff_x = pi[part_counter].x_target - (pi[part_counter].x_target+getPreplaceErrorX()); //calculate the difference between the required x position and the actual x position of the gantry
-                        preplace_diff_y = pi[part_counter].y_target - (pi[part_counter].y_target+getPreplaceErrorY()); //calculate the difference between the required y position and the actual y position of the gantry
-                        state = WAIT_1;  //display the errors to the user so they are aware and then wait for instruction
-                        printf("Time: %7.2f             %19s  Part misalignment error: %3.2f, preplace misalignment error: x=%3.2f y=%3.2f\n", getSimulationTime()," ", errortheta, getPreplaceErrorX(), getPreplaceErrorY());
-                        printf("Time: %7.2f  New state: %.20s  Waiting for next instruction. Recommend error correction\n", getSimulationTime(),state_name[state]);
+                        requested_theta = placements.theta[part_counter] - errortheta;  //calculate misalignment of the part on the nozzle
+                        preplace_diff_x = placements.x[part_counter] - (placements.x[part_counter]+getPreplaceErrorX()); //calculate the difference between the required x position and the actual x position of the gantry
+                        preplace_diff_y = placements.y[part_counter] - (placements.y[part_counter]+getPreplaceErrorY()); //calculate the difference between the required y position and the actual y position of the gantry
+                        if (assisting)
+                        {   //the nozzle was corrected at the camera, so only the gantry position is left to fix
+                            printf("Time: %7.2f             %19s  Preplace misalignment error: x=%3.2f y=%3.2f\n", getSimulationTime(), " ", getPreplaceErrorX(), getPreplaceErrorY());
+                            amendPos(preplace_diff_x, preplace_diff_y);
+                            teachRecord(TEACH_AMEND, part_counter, preplace_diff_x, preplace_diff_y, getSimulationTime());
+                            state = FIX_PREPLACE_ERROR;
+                            printf("Time: %7.2f  New state: %.20s  Correction made to gantry position\n", getSimulationTime(), state_name[state]);
+                        }
+                        else
+                        {
+                            state = WAIT_1;  //display the errors to the user so they are aware and then wait for instruction
+                            printf("Time: %7.2f             %19s  Part misalignment error: %3.2f, preplace misalignment error: x=%3.2f y=%3.2f\n", getSimulationTime()," ", errortheta, getPreplaceErrorX(), getPreplaceErrorY());
+                            printf("Time: %7.2f  New state: %.20s  Waiting for next instruction. Recommend error correction\n", getSimulationTime(),state_name[state]);
+                        }
+                    }
+                    break;
+
+                case FIX_NOZZLE_ERROR:
+                    //once the part is square on the nozzle, take it to the PCB
+                    if (isSimulatorReadyForNextInstruction())
+                    {
+                        setTargetPos(placements.x[part_counter], placements.y[part_counter]);
+                        teachRecord(TEACH_MOVE, part_counter, placements.x[part_counter], placements.y[part_counter], getSimulationTime());
+                        state = MOVE_TO_PCB;
+                        printf("Time: %7.2f  New state: %.20s  No further errors. Moving to PCB\n", getSimulationTime(), state_name[state]);
+                    }
+                    break;
+
+                case FIX_PREPLACE_ERROR:
+                    //once the gantry is over the placement position, place the part
+                    if (isSimulatorReadyForNextInstruction())
+                    {
+                        lowerNozzle(CENTRE_NOZZLE);
+                        teachRecord(TEACH_PLACE, part_counter, 0, 0, getSimulationTime());
+                        state = LOWER_CNTR_NOZZLE;
+                        printf("Time: %7.2f  New state: %.20s  Now lowering centre nozzle to place part on PCB\n", getSimulationTime(), state_name[state]);
                     }
                     break;
 
@@ -334,11 +577,60 @@ int main()
                     break;
 
             }
-            sleepMilliseconds((long) 1000 / POLL_LOOP_RATE);
+
+            if (!IS_STATE_TRANSITION(previous_state, state))
+                printf("WARNING  unexpected change of state from %.20s to %.20s\n", state_name[previous_state], state_name[state]);
+
+            /* publish the controller status to remote clients and monitors */
+            status.state = state;
+            status.state_name = state_name[state];
+            status.part_counter = part_counter;
+            status.nozzle_status[CENTRE_NOZZLE] = NozzleStatus;
+            status.nozzle_part[CENTRE_NOZZLE] = part_counter;
+            status.theta_pick_error[CENTRE_NOZZLE] = getPickErrorTheta(CENTRE_NOZZLE);
+            status.x_preplace_error = getPreplaceErrorX();
+            status.y_preplace_error = getPreplaceErrorY();
+            status.sim_time = getSimulationTime();
+            remotePublish(&status);
+            telemetryPublish(&status);
+
+            if (state == previous_state && c == NO_KEY) waitForEvent(remoteWaitTimeout((long) 1000 / POLL_LOOP_RATE));  //nothing to do, sleep until a key press or the simulator is ready
         }
+
+        /* placements per hour by hand and assisted, from the wall clock so that the operator's latency counts */
+        for (int assisted = 0; assisted < 2; assisted++)
+        {
+            if (parts[assisted] == 0) continue;
+            printf("%s placed %d, %.1f key presses and %.1f s per part, %.0f placements per hour\n", assisted ? "Assisted:" : "Manual:  ", parts[assisted],
+                   (double) keys[assisted] / parts[assisted], seconds[assisted] / parts[assisted], seconds[assisted] > 0 ? parts[assisted] * 3600 / seconds[assisted] : 0);
+        }
+
+        printPeepholeStatistics(getPeepholeStatistics(), getInstructionStatistics());
+
+        /* compile the session into a job that automatic mode runs without keypress waits */
+        teachClose(getSimulationTime());
+        res = compileTeachLog(TEACH_FILE, &placements, TAUGHT_JOB_FILE, &taught);
+        if (res == TEACH_COMPILED)
+        {
+            printf("Taught %d of %d parts, %d picked from another feeder, %d placed without correcting both errors\n",
+                   taught.parts_taught, number_of_components_to_place, taught.feeders_changed, taught.corrections_skipped);
+            printf("Session: %ld instructions, %.0f mm of travel, %.2f s, %d redundant moves\n",
+                   taught.session_instructions, taught.session_travel, taught.session_time, taught.redundant_moves);
+            printf("Job:     %ld instructions, %.0f mm of travel, about %.2f s, written to %s\n",
+                   taught.job_instructions, taught.job_travel, taught.job_time, TAUGHT_JOB_FILE);
+        }
+        else if (res != TEACH_NOTHING_TAUGHT) printf("Problem compiling %s, error code %d, no job written\n", TEACH_FILE, res);
     } // end of manual mode
 
 
+    /* automatic mode on the coroutine runtime, see pnpTrip.c */
+    else if (coroutines)
+    {
+        if (placeJobWithCoroutines(&placements, quit_when_finished) == TRIP_NOT_ENOUGH_MEMORY)
+            printf("Not enough memory to plan %d parts\n", number_of_components_to_place);
+    }
+
+
     /*
     *****************************************************
     *
@@ -349,79 +641,161 @@ int main()
     else
     {
         /* initialization of variables and controller window */
-        int state = HOME, part_counter = 0, nozzle_errors_to_check = 0, left_nozzle_part_num = 0,
-            centre_nozzle_part_num = 0, right_nozzle_part_num = 0, component_num, req_target = 0;
-        char part_placed = FALSE, Centre_NozzleStatus = not_holdingpart, Left_NozzleStatus = not_holdingpart,
-            Right_NozzleStatus = not_holdingpart, lookup_photo = FALSE, lookdown_photo = FALSE;
-        double requested_theta_left = 0, requested_theta_centre = 0, requested_theta_right = 0;  //the required angle theta of the nozzle position
+        int state = HOME, previous_state, part_counter = 0, component_num = 0, req_target = 0;
+        int nozzle = 0;  //the nozzle picking or placing a part
+        int pick, reject_nozzle;  //the result of a pick checked at the look-up camera, and the next nozzle to empty in the reject bin
+        int gang = 1, gang_mask = NOZZLE_MASK(0);  //the number of parts picked together from nozzle on, and their nozzles, see gangPickSize()
+        int check_nozzle = -1;  //the next nozzle to correct after the look-up photo, nozzles below it are corrected after it
+        int rotate_mask = 0;  //the nozzles whose correction is worked out but not yet applied
+        int ready;  //read once by CHECK ERROR, whose branches both wait for the simulator
+        char flying = FALSE;  //the head is on its way to the PCB through the look-up camera, see moveHeadViaCamera()
+        double flight_start_time = 0;  //when the fly-by move was issued
+        int nozzle_part[MAX_NUMBER_OF_NOZZLES], place_sequence[MAX_NUMBER_OF_NOZZLES], place_step = 0, place_count = 0;
+        char part_placed = FALSE, nozzle_status[MAX_NUMBER_OF_NOZZLES], lookup_photo = FALSE, lookdown_photo = FALSE;
+        char nozzle_reject[MAX_NUMBER_OF_NOZZLES] = {0};  //nozzles holding a part to drop in the reject bin
+        RecoveryState recovery = {0}, loaded_recovery = {0};  //failed picks of each part and mis-picks of each feeder, see pnpRecovery.c
+        double requested_theta[MAX_NUMBER_OF_NOZZLES] = {0};  //the required angle theta of each nozzle position
+        double nozzle_theta[MAX_NUMBER_OF_NOZZLES] = {0};  //the angle of each nozzle since the last look-up photo, see turnNozzle()
+        int prerotate_mask = 0;  //the nozzles of the trip still to turn towards the angle of their part before the first pick
+        double sequence_saving = 0;  //travel saved by the placement order of each trip over placing in pick order
         double preplace_diff_x = 0, preplace_diff_y = 0;  //difference in required gantry position and actual gantry position for preplacement
+        ControllerStatus status = {.operation_mode = AUTONOMOUS_CONTROL, .number_of_nozzles = machine.number_of_nozzles, .number_of_components_to_place = number_of_components_to_place, .job_start_time = getSimulationTime()};
+        RemoteCommand command;
+        PlacementStore loaded_placements, swap;
+        int loaded_operation_mode, *loaded_component_list;
 
 
         printf("Time: %7.2f  Initial state: %.15s  Operating in automatic mode, there are %d parts to place\n\n", getSimulationTime(), state_name[HOME], number_of_components_to_place);
 
 
-        /* reorder the centroid list by feeder in ascending order and print details */
-
-        int component_list[number_of_components_to_place];
-        int feeder_num_compare[number_of_components_to_place];
-        int y_target_compare[number_of_components_to_place];
-        int i, j, hold_value;
-        for (i = 0; i < number_of_components_to_place; i++)
+        /* reorder the centroid list by feeder in ascending order and print details. The entry after the last part is read ahead after the last pick, but never used */
+        int *component_list = calloc(number_of_components_to_place + 1, sizeof(int)), plan;
+        if (component_list == NULL || (plan = planPlacements(&placements, component_list)) < 0 || recoveryInit(&recovery, number_of_components_to_place) != 0)
         {
-            feeder_num_compare[i] = pi[i].feeder;  //holds the feeder numbers in the centroid file
-            y_target_compare[i] = pi[i].y_target;  // holds the y coord values in the centroid file
-            component_list[i] = i;  //holds the indexes that correlate to the values
+            printf("Not enough memory to plan %d parts\n", number_of_components_to_place);
+            exit(-1);
         }
-        for (i = 0; i < number_of_components_to_place; i++)
+        printComponentOrder(&placements, component_list);
+        printf("Planned gantry travel: %.0f mm, %ld instructions, about %.0f s, %s order\n\n", routeLength(&placements, component_list, number_of_components_to_place),
+               planInstructions(&placements, component_list, number_of_components_to_place), planCycleTime(&placements, component_list, number_of_components_to_place), plan_name[plan]);
+        placementStoreInit(&loaded_placements);
+        for (int n = 0; n < MAX_NUMBER_OF_NOZZLES; n++)
         {
-            for (j = i+1; j < number_of_components_to_place; j++)
-            {
-                if (feeder_num_compare[i] > feeder_num_compare[j])
-                {  //reorder the indexed numbers based on the feeder numbers. Swaps the y-coords so they correlate
-                    hold_value = component_list[i];
-                    component_list[i] = component_list[j];
-                    component_list[j] = hold_value;
-                    hold_value = feeder_num_compare[i];
-                    feeder_num_compare[i] = feeder_num_compare[j];
-                    feeder_num_compare[j] = hold_value;
-                    hold_value = y_target_compare[i];
-                    y_target_compare[i] = y_target_compare[j];
-                    y_target_compare[j] = hold_value;
-                }
-                // sort by ascending y-coordinates if the feeder numbers are the same
-                else if (feeder_num_compare[i] == feeder_num_compare[j])
-                {
-                    if (y_target_compare[i] > y_target_compare[j])
-                    {
-                        hold_value = component_list[i];
-                        component_list[i] = component_list[j];
-                        component_list[j] = hold_value;
-                        hold_value = y_target_compare[i];
-                        y_target_compare[i] = y_target_compare[j];
-                        y_target_compare[j] = hold_value;
-                        hold_value = feeder_num_compare[i];
-                        feeder_num_compare[i] = feeder_num_compare[j];
-                        feeder_num_compare[j] = hold_value;
-                    }
-                }
+            nozzle_status[n] = not_holdingpart;
+            nozzle_part[n] = NO_PICKED_PART;
+        }
+
+        /* continue an interrupted job from its journal, or start a new journal */
+        JournalReplay replay;
+        res = resume ? replayJournal(JOURNAL_FILE, &placements, &replay) : JOURNAL_NOT_PRESENT;
+        if (res == JOURNAL_REPLAYED && (part_counter = orderForResume(&replay, component_list, number_of_components_to_place)) >= 0)
+        {
+            status.parts_placed = replay.placed;
+            printf("Resuming the job in %s: %d parts placed, %d skipped, %d left to place\n", JOURNAL_FILE, replay.placed, replay.skipped, number_of_components_to_place - part_counter);
+            for (int i = 0; i < number_of_components_to_place; i++)
+            {  //pick recovery carries on where it was, with the feeders it moved parts to and the failed picks so far
+                if (replay.feeder[i] != placements.feeder[i]) printf("Part %d is picked from feeder %d in place of feeder %d\n", i, replay.feeder[i], placements.feeder[i]);
+                placements.feeder[i] = replay.feeder[i];
+                recovery.attempts[i] = replay.attempts[i];
+                recovery.feeder_attempts[i] = replay.feeder_attempts[i];
             }
+            for (int n = 0; n < HEAD_NOZZLES; n++)
+            {  //whatever is on the nozzles now goes to the reject bin, the parts they held are picked again. A pick is only journalled
+               //once the nozzle is raised, so a nozzle the journal shows empty may hold a part lifted just before the interruption, and
+               //is emptied too: a part left on it would be placed in place of the next part it picks
+                if (replay.nozzle_part[n] != NO_PICKED_PART) printf("Part %d was on %s, it will be picked again\n", replay.nozzle_part[n], nozzleName(n));
+                nozzle_reject[n] = TRUE;
+            }
+            printf("\n");
+            lookup_photo = TRUE;
+            state = CHECK_ERROR;
+            journalOpen(JOURNAL_FILE, &replay);
         }
-        //display the new order of the part details
-        for (int i = 0; i < number_of_components_to_place; i++)
+        else
         {
-            component_num = component_list[i];
-            printf("Part %d:\nDesignation: %s  Footprint: %s  Value: %.2f  x: %.2f  y: %.2f  theta: %.2f  Feeder: %d\n\n", component_num,
-                pi[component_num].component_designation, pi[component_num].component_footprint, pi[component_num].component_value,
-                pi[component_num].x_target, pi[component_num].y_target, pi[component_num].theta_target, pi[component_num].feeder);
-
+            if (resume && res == JOURNAL_REPLAYED) printf("Not enough memory to resume the job, starting from the first part\n\n");
+            else if (resume && res == JOURNAL_NOT_PRESENT) printf("There is no job to resume in %s, starting from the first part\n\n", JOURNAL_FILE);
+            else if (resume && res == JOURNAL_OF_ANOTHER_JOB) printf("%s is the journal of another job, starting from the first part\n\n", JOURNAL_FILE);
+            else if (resume && res == JOURNAL_JOB_IS_FINISHED) printf("The job in %s is finished, starting it again from the first part\n\n", JOURNAL_FILE);
+            part_counter = 0;
+            journalOpen(JOURNAL_FILE, NULL);
+            journalStartJob(&placements);
         }
-
-
+        if (resume) journalReplayFree(&replay);
 
         /* loop until user quits */
         while(!isPnPSimulationQuitFlagOn())
         {
+            previous_state = state;
+            getKey();  //key presses other than q (handled by the input subsystem) are not used in automatic mode, discard them
 
+            /* handle commands from the line supervisor */
+            while (getRemoteCommand(&command) != REMOTE_NO_COMMAND)
+            {
+                if (command.command == REMOTE_PAUSE)
+                {   //the instruction being executed is completed, no further instructions are issued
+                    status.paused = TRUE;
+                    remoteReply(&command, "OK paused in state %d", state);
+                    printf("Time: %7.2f             %19s  Paused by remote command\n", getSimulationTime(), " ");
+                }
+                else if (command.command == REMOTE_START && !status.paused)
+                {   //the job is placing, or placed and back home
+                    if (state == HOME && part_counter == number_of_components_to_place) remoteReply(&command, "ERR the job is finished, LOAD another job to start");
+                    else remoteReply(&command, "OK already running");
+                }
+                else if (command.command == REMOTE_START)
+                {
+                    if (part_counter == 0) status.job_start_time = getSimulationTime();
+                    status.paused = FALSE;
+                    remoteReply(&command, "OK started");
+                    printf("Time: %7.2f             %19s  Started by remote command\n", getSimulationTime(), " ");
+                }
+                else if (command.command == REMOTE_LOAD)
+                {   //a new job can only be loaded while all nozzles are empty, and the current job is finished or paused
+                    if (state != HOME || (!status.paused && part_counter != number_of_components_to_place))
+                    {
+                        remoteReply(&command, "ERR pause the current job and wait for the HOME state before loading");
+                    }
+                    else if ((res = loadPlacementStore(command.argument, &loaded_operation_mode, &loaded_placements)) != CENTROID_FILE_PRESENT_AND_READ)
+                    {
+                        remoteReply(&command, "ERR problem with centroid file %s, error code %d", command.argument, res);
+                    }
+                    else if (loaded_operation_mode != AUTONOMOUS_CONTROL)
+                    {
+                        remoteReply(&command, "ERR centroid file %s is not for automatic mode", command.argument);
+                    }
+                    else if ((loaded_component_list = calloc(loaded_placements.count + 1, sizeof(int))) == NULL ||
+                             (plan = planPlacements(&loaded_placements, loaded_component_list)) < 0 || recoveryInit(&loaded_recovery, loaded_placements.count) != 0)
+                    {   //the new job is planned apart, so the paused job keeps its order and recovery state if any step fails
+                        free(loaded_component_list);
+                        remoteReply(&command, "ERR not enough memory to plan %d parts", loaded_placements.count);
+                    }
+                    else
+                    {   //the new job waits for a START command, the store of the previous job is kept for the next load
+                        free(component_list);
+                        component_list = loaded_component_list;
+                        swap = placements;
+                        placements = loaded_placements;
+                        loaded_placements = swap;
+                        recoveryFree(&recovery);
+                        recovery = loaded_recovery;
+                        memset(&loaded_recovery, 0, sizeof(RecoveryState));
+                        journalStartJob(&placements);
+                        number_of_components_to_place = placements.count;
+                        component_list[number_of_components_to_place] = 0;
+                        part_counter = 0;
+                        sequence_saving = 0;
+                        status.parts_placed = 0;
+                        status.paused = TRUE;
+                        status.number_of_components_to_place = number_of_components_to_place;
+                        printf("Time: %7.2f             %19s  Loaded %d parts from %s, %s order, waiting for remote start\n\n", getSimulationTime(), " ", number_of_components_to_place, command.argument, plan_name[plan]);
+                        printComponentOrder(&placements, component_list);
+                        remoteReply(&command, "OK loaded %d parts, send START to begin", number_of_components_to_place);
+                    }
+                }
+            }
+
+            if (!status.paused)
             switch (state)
             {
 
@@ -435,268 +809,189 @@ int main()
                           //Do nothing. Program is complete, wait for user to quit program.
                         }
                         else
-                        { //go to the first feeder in the list, +20 for the left nozzle positioning
-                            setTargetPos(TAPE_FEEDER_X[pi[component_num].feeder]+20, TAPE_FEEDER_Y[pi[component_num].feeder]);
-                            state = MOVE_TO_FEEDER;
-                            printf("Time: %7.2f  New state: %.20s  Moving to tape feeder %d\n", getSimulationTime(), state_name[state], pi[component_num].feeder);
-                        }
-                    }
-                    break;
-
-                case MOVE_TO_FEEDER:
-                    //waiting for the simulator to complete movement of the gantry
-                    if (isSimulatorReadyForNextInstruction())
-                    {
-                        if (Left_NozzleStatus == not_holdingpart) // if the nozzle is already holding a part, then skip to the next nozzle
-                        {  //left nozzle goes first due to order of the parts ascending by feeder number
-                            lowerNozzle(LEFT_NOZZLE);
-                            state = LOWER_LEFT_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Arrived at feeder, lowering left nozzle\n", getSimulationTime(), state_name[state]);
-                        }
-                        else if (Centre_NozzleStatus == not_holdingpart)
-                        { // centre nozzle picks up part after left nozzle
-                            lowerNozzle(CENTRE_NOZZLE);
-                            state = LOWER_CNTR_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Arrived at feeder, lowering centre nozzle\n", getSimulationTime(), state_name[state]);
-                        }
-                        else if (Right_NozzleStatus == not_holdingpart)
-                        {  //right nozzle is last to pick up part as it is closest to the higher feeder number
-                            lowerNozzle(RIGHT_NOZZLE);
-                            state = LOWER_RIGHT_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Arrived at feeder, lowering right nozzle\n", getSimulationTime(), state_name[state]);
+                        { //go to the first feeder in the list, positioned for the first nozzle
+                            nozzle = 0;
+                            gang = gangPickSize(&placements, component_list, part_counter, number_of_components_to_place, nozzle);
+                            gang_mask = ((1 << gang) - 1) << nozzle;
+                            if (machine.rotate_while_moving)
+                            {  //nozzle n picks the nth part of the trip, turn each towards the angle of its part first. Only a hypothetical
+                               //machine keeps the angle through the look-up photo, the simulator of the assignment would lose the turn there
+                                for (int n = 0; n < HEAD_NOZZLES && part_counter + n < number_of_components_to_place; n++) prerotate_mask |= NOZZLE_MASK(n);
+                                state = PRE_ROTATE_NOZZLES;
+                                printf("Time: %7.2f  New state: %.20s  Turning the nozzles towards their parts\n", getSimulationTime(), state_name[state]);
+                            }
+                            else
+                            {
+                                setTargetPos(machine.pick_x[nozzle][placements.feeder[component_num]], machine.pick_y[nozzle][placements.feeder[component_num]]);
+                                state = MOVE_TO_FEEDER;
+                                printf("Time: %7.2f  New state: %.20s  Moving to tape feeder %d", getSimulationTime(), state_name[state], placements.feeder[component_num]);
+                                if (gang > 1) printf(" to gang pick %d parts", gang);
+                                printf("\n");
+                            }
                         }
-
                     }
                     break;
 
-                case LOWER_LEFT_NOZZLE:
+                case PRE_ROTATE_NOZZLES:
                     if (isSimulatorReadyForNextInstruction())
-                    {
-                        if(Left_NozzleStatus == not_holdingpart)
-                        {   //vacuum will apply when the nozzle is empty
-                            applyVacuum(LEFT_NOZZLE);
-                            state = VAC_LEFT_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Applying vacuum\n", getSimulationTime(), state_name[state]);
-                        }
-                        else if(Left_NozzleStatus == holdingpart)
-                        {   //vacuum will release the part when the nozzle is holding something
-                            releaseVacuum(LEFT_NOZZLE);
-                            part_placed = TRUE;  //counter to indicate the part has been placed
-                            state = VAC_LEFT_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Releasing vacuum to place part\n", getSimulationTime(), state_name[state]);
+                    {  //the nozzles keep turning while the head moves to the feeders, so only the correction after the look-up photo is left
+                        for (int n = 0; n < HEAD_NOZZLES; n++)
+                        {  //a nozzle already at the angle of its part is not turned
+                            if (!(prerotate_mask & NOZZLE_MASK(n))) continue;
+                            requested_theta[n] = placements.theta[component_list[part_counter + n]];
+                            if (fabs(shortestTurn(nozzle_theta[n], requested_theta[n])) <= PRE_ROTATE_TOLERANCE) continue;
+                            turnNozzle(n, requested_theta[n], nozzle_theta);
+                            printf("Time: %7.2f             %19s  Turning %s to %.2f degrees for part %d\n", getSimulationTime(), " ", nozzleName(n),
+                                   requested_theta[n], component_list[part_counter + n]);
                         }
+                        prerotate_mask = 0;
+                        //the turns and the move are generated together, the move waits for none of them
+                        setTargetPos(machine.pick_x[nozzle][placements.feeder[component_num]], machine.pick_y[nozzle][placements.feeder[component_num]]);
+                        state = MOVE_TO_FEEDER;
+                        printf("Time: %7.2f  New state: %.20s  Moving to tape feeder %d", getSimulationTime(), state_name[state], placements.feeder[component_num]);
+                        if (gang > 1) printf(" to gang pick %d parts", gang);
+                        printf("\n");
                     }
-
                     break;
 
-                case LOWER_CNTR_NOZZLE:
+                case MOVE_TO_FEEDER:
+                    //waiting for the simulator to complete movement of the gantry
                     if (isSimulatorReadyForNextInstruction())
-                    {
-                        if(Centre_NozzleStatus == not_holdingpart)
-                        {   //vacuum will apply when the nozzle is empty
-                            applyVacuum(CENTRE_NOZZLE);
-                            state = VAC_CNTR_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Applying vacuum\n", getSimulationTime(), state_name[state]);
+                    {  //the nozzles pick in turn from the left, several at once when their feeders are under them together
+                        if (gang > 1)
+                        {
+                            lowerNozzles(gang_mask);
+                            state = LOWER_HEAD_NOZZLE;
+                            printf("Time: %7.2f  New state: %.20s  Arrived at feeder, lowering nozzles %d to %d together\n", getSimulationTime(), state_name[state], nozzle, nozzle + gang - 1);
                         }
-                        else if(Centre_NozzleStatus == holdingpart)
-                        {   //vacuum will release the part when the nozzle is holding something
-                            releaseVacuum(CENTRE_NOZZLE);
-                            part_placed = TRUE;  //counter to indicate the part has been placed
-                            state = VAC_CNTR_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Releasing vacuum to place part\n", getSimulationTime(), state_name[state]);
+                        else
+                        {
+                            lowerNozzle(nozzle);
+                            state = LOWER_HEAD_NOZZLE;
+                            printf("Time: %7.2f  New state: %.20s  Arrived at feeder, lowering %s\n", getSimulationTime(), state_name[state], nozzleName(nozzle));
                         }
                     }
-
                     break;
 
-                case LOWER_RIGHT_NOZZLE:
+                case LOWER_HEAD_NOZZLE:
                     if (isSimulatorReadyForNextInstruction())
                     {
-                        if(Right_NozzleStatus == not_holdingpart)
+                        if(nozzle_status[nozzle] == not_holdingpart)
                         {   //vacuum will apply when the nozzle is empty
-                            applyVacuum(RIGHT_NOZZLE);
-                            state = VAC_RIGHT_NOZZLE;
+                            if (gang > 1) applyVacuums(gang_mask);
+                            else applyVacuum(nozzle);
+                            state = VAC_HEAD_NOZZLE;
                             printf("Time: %7.2f  New state: %.20s  Applying vacuum\n", getSimulationTime(), state_name[state]);
                         }
-                        else if(Right_NozzleStatus == holdingpart)
-                        {   //vacuum will release the part when the nozzle is holding something
-                            releaseVacuum(RIGHT_NOZZLE);
+                        else if(nozzle_status[nozzle] == holdingpart)
+                        {   //vacuum will release the part when the nozzle is holding something, it is journalled as placed now so it is never placed twice
+                            releaseVacuum(nozzle);
+                            journalAppend(JOURNAL_PART_PLACED, nozzle_part[nozzle], nozzle, getSimulationTime());
                             part_placed = TRUE;  //counter to indicate the part has been placed
-                            state = VAC_RIGHT_NOZZLE;
+                            state = VAC_HEAD_NOZZLE;
                             printf("Time: %7.2f  New state: %.20s  Releasing vacuum to place part\n", getSimulationTime(), state_name[state]);
                         }
                     }
 
                     break;
 
-                case VAC_LEFT_NOZZLE:
+                case VAC_HEAD_NOZZLE:
                     //wait until the vacuum action is finished before raising the nozzle
                     if (isSimulatorReadyForNextInstruction())
                     {
-                        raiseNozzle(LEFT_NOZZLE);
-                        state = RAISE_LEFT_NOZZLE;
-                        printf("Time: %7.2f  New state: %.20s  Raising left nozzle\n", getSimulationTime(), state_name[state]);
+                        if (gang > 1) raiseNozzles(gang_mask);
+                        else raiseNozzle(nozzle);
+                        state = RAISE_HEAD_NOZZLE;
+                        if (gang > 1) printf("Time: %7.2f  New state: %.20s  Raising nozzles %d to %d\n", getSimulationTime(), state_name[state], nozzle, nozzle + gang - 1);
+                        else printf("Time: %7.2f  New state: %.20s  Raising %s\n", getSimulationTime(), state_name[state], nozzleName(nozzle));
                     }
                     break;
 
-                case VAC_CNTR_NOZZLE:
-                    //wait until the vacuum action is finished before raising the nozzle
-                    if (isSimulatorReadyForNextInstruction())
-                    {
-                        raiseNozzle(CENTRE_NOZZLE);
-                        state = RAISE_CNTR_NOZZLE;
-                        printf("Time: %7.2f  New state: %.20s  Raising centre nozzle\n", getSimulationTime(), state_name[state]);
-                    }
-                    break;
-
-                case VAC_RIGHT_NOZZLE:
-                    //wait until the vacuum action is finished before raising the nozzle
-                    if (isSimulatorReadyForNextInstruction())
-                    {
-                        raiseNozzle(RIGHT_NOZZLE);
-                        state = RAISE_RIGHT_NOZZLE;
-                        printf("Time: %7.2f  New state: %.20s  Raising right nozzle\n", getSimulationTime(), state_name[state]);
-                    }
-                    break;
-
-                case RAISE_LEFT_NOZZLE:
+                case RAISE_HEAD_NOZZLE:
 
                     if (isSimulatorReadyForNextInstruction())
                     {
                         if (part_placed==FALSE) // applies when the nozzle has not just placed a part
                         {
-                            left_nozzle_part_num = component_num;  //storing the index of the part number from the reordered list
-                            part_counter++;  //incrementing the number of parts that have been picked
+                            for (int g = 0; g < gang; g++)
+                            {  //a gang pick loads the nozzles from nozzle on with consecutive parts of the reordered list
+                                nozzle_part[nozzle + g] = component_list[part_counter];  //storing the index of the part number from the reordered list
+                                journalAppend(JOURNAL_PART_PICKED, nozzle_part[nozzle + g], nozzle + g, getSimulationTime());
+                                part_counter++;  //incrementing the number of parts that have been picked
+                                nozzle_status[nozzle + g] = holdingpart; //if a part hasn't just been placed then it is determined that a part has just been picked up
+                            }
+                            nozzle += gang - 1;
                             component_num = component_list[part_counter];  //hold the index value of the next component
-                            Left_NozzleStatus = holdingpart; //if a part hasn't just been placed then it is determined that a part has just been picked up
-                            nozzle_errors_to_check++;  //the picked up part needs to be checked for alignment errors
-                            if (part_counter == number_of_components_to_place)
-                            {  //if there is no other feeder in the file, then go to the camera
-                                setTargetPos(LOOKUP_CAMERA_X,LOOKUP_CAMERA_Y);
-                                state = MOVE_TO_CAMERA;
-                                printf("Time: %7.2f  New state: %.20s  Part acquired, moving to look-up camera\n", getSimulationTime(), state_name[state]);
+                            if (part_counter == number_of_components_to_place || nozzle + 1 == HEAD_NOZZLES)
+                            {  //if there is no other part, or no other nozzle, then go to the camera. The last nozzle to pick is the first to be corrected
+                                check_nozzle = nozzle;
+                                gang = 1;  //parts are placed one nozzle at a time
+                                if (machine.flyby_camera)
+                                {  //head straight for the first placement of the trip, as if every pick was good, and photograph the parts on the way
+                                    double trip_travel, pick_order_travel, flight_x, flight_y;
+                                    double next_x = part_counter < number_of_components_to_place ? machine.pick_x[0][placements.feeder[component_num]] : machine.home_x;
+                                    double next_y = part_counter < number_of_components_to_place ? machine.pick_y[0][placements.feeder[component_num]] : machine.home_y;
+
+                                    sequencePlacements(&placements, nozzle_status, nozzle_part, next_x, next_y, place_sequence, &trip_travel, &pick_order_travel);
+                                    flight_x = placements.x[nozzle_part[place_sequence[0]]] - machine.nozzle_x[place_sequence[0]];
+                                    flight_y = placements.y[nozzle_part[place_sequence[0]]];
+                                    flight_start_time = getSimulationTime();
+                                    flying = TRUE;
+                                    moveHeadViaCamera(flight_x, flight_y);
+                                    state = FLY_BY_CAMERA;
+                                    printf("Time: %7.2f  New state: %.20s  All parts acquired, moving to PCB over the look-up camera\n", getSimulationTime(), state_name[state]);
+                                }
+                                else
+                                {
+                                    setTargetPos(machine.camera_x, machine.camera_y);
+                                    state = MOVE_TO_CAMERA;
+                                    printf("Time: %7.2f  New state: %.20s  All parts acquired, moving to look-up camera\n", getSimulationTime(), state_name[state]);
+                                }
                             }
                             else
-                            {
-                                //if there is another feeder waiting, then go to the next feeder in the reordered list, positioned for the centre nozzle
-                                setTargetPos(TAPE_FEEDER_X[pi[component_num].feeder], TAPE_FEEDER_Y[pi[component_num].feeder]);
+                            {   //go to the feeder of the next part in the reordered list, positioned for the next nozzle
+                                nozzle++;
+                                gang = gangPickSize(&placements, component_list, part_counter, number_of_components_to_place, nozzle);
+                                gang_mask = ((1 << gang) - 1) << nozzle;
+                                setTargetPos(machine.pick_x[nozzle][placements.feeder[component_num]], machine.pick_y[nozzle][placements.feeder[component_num]]);
                                 state = MOVE_TO_FEEDER;
-                                printf("Time: %7.2f  New state: %.20s  Moving to feeder %d\n", getSimulationTime(), state_name[state], pi[component_num].feeder);
+                                printf("Time: %7.2f  New state: %.20s  Moving to feeder %d", getSimulationTime(), state_name[state], placements.feeder[component_num]);
+                                if (gang > 1) printf(" to gang pick %d parts", gang);
+                                printf("\n");
                             }
                         }
 
                         else if (part_placed==TRUE)
                         {
-                            Left_NozzleStatus = not_holdingpart; //if the vacuum has just released a part, then the part has been placed and the nozzle is free again
+                            nozzle_status[nozzle] = not_holdingpart; //if the vacuum has just released a part, then the part has been placed and the nozzle is free again
                             part_placed = FALSE;  //reset the variable
                             lookdown_photo = FALSE;  //reset the photo variable
-                            printf("Time: %7.2f             %19s  Part %d placed on PCB successfully\n\n", getSimulationTime(), " ", left_nozzle_part_num);
-
-                            if (Centre_NozzleStatus == holdingpart)
-                            {  //if the centre nozzle has a part, then move to the required position on the PCB
-                                req_target = centre_nozzle_part_num; // this is required to obtain the correct alignment errors
-                                setTargetPos(pi[centre_nozzle_part_num].x_target, pi[centre_nozzle_part_num].y_target);
+                            printf("Time: %7.2f             %19s  Part %d placed on PCB successfully\n\n", getSimulationTime(), " ", nozzle_part[nozzle]);
+                            status.parts_placed++;
+
+                            if (++place_step < place_count)
+                            {  //move the next nozzle of the placement sequence over its position on the PCB
+                                nozzle = place_sequence[place_step];
+                                req_target = nozzle_part[nozzle]; // this is required to obtain the correct alignment errors
+                                setTargetPos(placements.x[req_target] - machine.nozzle_x[nozzle], placements.y[req_target]);
                                 state = MOVE_TO_PCB;
-                                printf("Time: %7.2f  New state: %.20s  Moving to next position x: %3.2f y: %3.2f\n", getSimulationTime(), state_name[state],pi[centre_nozzle_part_num].x_target, pi[centre_nozzle_part_num].y_target);
+                                printf("Time: %7.2f  New state: %.20s  Moving to next position x: %3.2f y: %3.2f\n", getSimulationTime(), state_name[state], placements.x[req_target], placements.y[req_target]);
                             }
 
                             else if(part_counter == number_of_components_to_place)
                             {  //there are no more parts to place, so move gantry to home
-                                setTargetPos(HOME_X,HOME_Y);
+                                setTargetPos(machine.home_x, machine.home_y);
                                 state = MOVE_TO_HOME;
                                 printf("Time: %7.2f  New state: %.20s  All parts have been placed! Moving to home\n", getSimulationTime(), state_name[state]);
-                            }
-                        }
-                    }
-                    break;
-
-                case RAISE_CNTR_NOZZLE:
-
-                    if (isSimulatorReadyForNextInstruction())
-                    {
-                        if (part_placed==FALSE)  //applies if the nozzle has not just placed a part on the PCB
-                        {
-                            centre_nozzle_part_num = component_num;  //holding the indexed value of the component for the centre nozzle
-                            part_counter++;  //increment the part counter to ensure number of components are accounted for
-                            component_num = component_list[part_counter];  //hold the next part number index
-                            Centre_NozzleStatus = holdingpart; //if a part hasn't just been placed, then it is determined that a part has just been picked up
-                            nozzle_errors_to_check++;  //the part needs to be checked for alignment errors
-                            if (part_counter == number_of_components_to_place)
-                            {   //if no other feeder and no other parts to pick up, then go to the camera
-                                setTargetPos(LOOKUP_CAMERA_X,LOOKUP_CAMERA_Y);  //the gantry will move to the position above the camera
-                                state = MOVE_TO_CAMERA;
-                                printf("Time: %7.2f  New state: %.20s  Part acquired, moving to look-up camera\n", getSimulationTime(), state_name[state]);
+                                printf("Time: %7.2f             %19s  Placement sequencing saved %.0f mm of travel over pick order\n\n", getSimulationTime(), " ", sequence_saving);
+                                journalAppend(JOURNAL_JOB_FINISHED, NO_PICKED_PART, -1, getSimulationTime());
+                                printFeederStatistics(&recovery);
                             }
                             else
-                            {   //if there is another feeder number waiting, then go to the next feeder
-                                setTargetPos(TAPE_FEEDER_X[pi[component_num].feeder]-20, TAPE_FEEDER_Y[pi[component_num].feeder]);  //move to the next feeder for the right nozzle
-                                state = MOVE_TO_FEEDER;
-                                printf("Time: %7.2f  New state: %.20s  Moving to feeder %d\n", getSimulationTime(), state_name[state], pi[component_num].feeder);
-                            }
-                        }
-
-                        else if (part_placed==TRUE)
-                        {
-                            Centre_NozzleStatus = not_holdingpart; //if the vacuum has just released a part, then the part has been placed and the nozzle is free again
-                            lookdown_photo = FALSE;  //reset the photo variabla
-                            part_placed = FALSE;  //reset the variable
-                            printf("Time: %7.2f             %19s  Part %d placed on PCB successfully\n\n", getSimulationTime(), state_name[state], centre_nozzle_part_num);
-
-                            if (Right_NozzleStatus == holdingpart)
-                            {  //if the right nozzle has a part then, move to the required position on the PCB
-                                req_target = right_nozzle_part_num;  // this is required in order to calculate preplace errors
-                                setTargetPos(pi[right_nozzle_part_num].x_target, pi[right_nozzle_part_num].y_target); //right nozzle holding part_counter-1
-                                state = MOVE_TO_PCB;
-                                printf("Time: %7.2f  New state: %.20s  Moving to next position x: %3.2f y: %3.2f\n", getSimulationTime(), state_name[state],pi[right_nozzle_part_num].x_target, pi[right_nozzle_part_num].y_target);
-                            }
-
-                            else if(part_counter == number_of_components_to_place)
-                            {  //if there are no more parts to place then go to home
-                                setTargetPos(HOME_X,HOME_Y);
-                                state = MOVE_TO_HOME;
-                                printf("Time: %7.2f  New state: %.20s  All parts have been placed! Moving to home\n", getSimulationTime(), state_name[state]);
-                            }
-
-                        }
-                    }
-                    break;
-
-                case RAISE_RIGHT_NOZZLE:
-
-                    if (isSimulatorReadyForNextInstruction())
-                    {
-                        if (part_placed==FALSE)  // applies if the nozzle hasn't just placed a part on the PCB
-                        {
-                            right_nozzle_part_num = component_num;  //storing the indexed value of the component
-                            part_counter++;  //keeping a counter on the number of parts that have been picked up
-                            component_num = component_list[part_counter];  //storing the next part index
-                            Right_NozzleStatus = holdingpart;//once nozzle is raised, if a part hasn't just been placed, then it is determined that a part has just been picked up
-                            nozzle_errors_to_check++;  //right nozzle needs to be checked for alignment errors
-                            setTargetPos(LOOKUP_CAMERA_X,LOOKUP_CAMERA_Y);  //the right nozzle is the last to pick up a part, so the gantry will move to the camera
-                            state = MOVE_TO_CAMERA;
-                            printf("Time: %7.2f  New state: %.20s  All parts acquired, moving to look-up camera\n", getSimulationTime(), state_name[state]);
-                        }
-
-                        else if (part_placed==TRUE)
-                        {
-                            Right_NozzleStatus = not_holdingpart; //if the vacuum has just released a part, then the part has been placed and the nozzle is free again
-                            lookdown_photo = FALSE;  //reset the photo variable
-                            part_placed = FALSE;  //reset the variable
-                            printf("Time: %7.2f             %19s  Part %d placed on PCB successfully\n\n", getSimulationTime(), state_name[state], right_nozzle_part_num);
-
-                            if(part_counter == number_of_components_to_place)
-                            {  //if there are no more parts to place, then go to home
-                                setTargetPos(HOME_X,HOME_Y);
-                                state = MOVE_TO_HOME;
-                                printf("Time: %7.2f  New state: %.20s  Moving to home.\n", getSimulationTime(), state_name[state]);
-                            }
-                            else
-                            {   // once the part is placed, if there are more parts then go to home to obtain details for the next feeder
+                            {   // once the trip is placed, if there are more parts then go to home to obtain details for the next feeder
                                 state = HOME;
                                 printf("Time: %7.2f  New state: %.20s  Moving to next feeder\n\n", getSimulationTime(), state_name[state]);
-
                             }
-
                         }
                     }
                     break;
@@ -714,12 +1009,24 @@ int main()
                 case LOOK_UP_PHOTO:
                     if (isSimulatorReadyForNextInstruction())
                     {   //once look-up photo is taken, move on to calculate errors
+                        resetNozzleAngles(nozzle_theta);
                         lookup_photo = TRUE;
                         state = CHECK_ERROR;
                         printf("Time: %7.2f  New state: %.20s  Look-up photo acquired. Checking errors and calculating corrections\n", getSimulationTime(), state_name[state]);
                     }
                     break;
 
+                case FLY_BY_CAMERA:
+                    //the photo is taken as the head passes the camera, its results are published before the move ends
+                    if (getLookupPhotoTime() > flight_start_time || isSimulatorReadyForNextInstruction())
+                    {
+                        resetNozzleAngles(nozzle_theta);
+                        lookup_photo = TRUE;
+                        state = CHECK_ERROR;
+                        printf("Time: %7.2f  New state: %.20s  Look-up photo taken in flight. Checking errors and calculating corrections\n", getSimulationTime(), state_name[state]);
+                    }
+                    break;
+
                 case MOVE_TO_PCB:
                     //once the gantry has finished moving to the PCB, then it is ready to take a look-down photo
                     if (isSimulatorReadyForNextInstruction())
@@ -738,49 +1045,118 @@ int main()
                     break;
 
                 case CHECK_ERROR:
-                    //wait until the photo is taken, then calculate errors
-                    if (isSimulatorReadyForNextInstruction() && lookup_photo == TRUE)
-                    {   //for look-up photos, cycle through and correct errors one by one using nozzle_errors_to_check as a counter
-                        if (nozzle_errors_to_check == 3)
-                        {   //since the right nozzle is last to pick up a part, it is the first to be corrected
-                            double errortheta = getPickErrorTheta(RIGHT_NOZZLE);  //acquire the part misalignment from the look-up photo
-                            requested_theta_right = pi[right_nozzle_part_num].theta_target - errortheta;  //calculate misalignment of the part on the nozzle
-                            printf("Time: %7.2f             %19s  Right part misalignment error: %3.2f  Correction required: %3.2f degrees\n", getSimulationTime()," ", errortheta, requested_theta_right);
-                            state = FIX_NOZZLE_ERROR;
-                            printf("Time: %7.2f  New state: %.20s  Correction made to right nozzle for part alignment\n", getSimulationTime(), state_name[state]);
+                    //wait until the photo is taken, then calculate errors. The picks of a photo taken in flight are checked while the head is still moving
+                    ready = isSimulatorReadyForNextInstruction();
+                    if (lookup_photo == TRUE && (ready || (flying && check_nozzle >= 0)))
+                    {   //for look-up photos, correct the loaded nozzles one by one, from the last to pick down to the first
+                        if (check_nozzle >= 0 && (pick = checkPick(getPickStatus(check_nozzle), getPickErrorTheta(check_nozzle))) != PICK_OK)
+                        {  //a failed pick goes back into the pick order for a later trip, and the rest of the trip carries on
+                            int part = nozzle_part[check_nozzle], feeder = placements.feeder[part];
+
+                            recordPick(&recovery, feeder, pick);
+                            nozzle_status[check_nozzle] = not_holdingpart;
+                            nozzle_reject[check_nozzle] = pick == PICK_OUT_OF_RANGE;  //an empty nozzle has nothing to drop
+                            if (pick == PICK_MISSED) journalAppend(JOURNAL_NOZZLE_EMPTIED, NO_PICKED_PART, check_nozzle, getSimulationTime());
+                            if (pick == PICK_MISSED)
+                                printf("Time: %7.2f             %19s  Part %d missing from %s, mis-pick from feeder %d\n", getSimulationTime(), " ", part, nozzleName(check_nozzle), placements.feeder[part]);
+                            else
+                                printf("Time: %7.2f             %19s  Part %d on %s misalignment error: %3.2f is beyond correction, rejecting it\n", getSimulationTime(), " ", part, nozzleName(check_nozzle), getPickErrorTheta(check_nozzle));
+                            if (recoverPart(&recovery, &placements, part) == RECOVERY_REQUEUE)
+                            {  //the picked entries of component_list are not needed again, so the part takes the one before the next pick
+                                journalAppend(JOURNAL_PART_REQUEUED, part, -1, getSimulationTime());
+                                if (placements.feeder[part] != feeder) journalAppend(JOURNAL_FEEDER_CHANGED, part, placements.feeder[part], getSimulationTime());
+                                component_list[--part_counter] = part;
+                                component_num = part;
+                                printf("Time: %7.2f             %19s  Part %d will be picked again from feeder %d\n", getSimulationTime(), " ", part, placements.feeder[part]);
+                            }
+                            else
+                            {
+                                journalAppend(JOURNAL_PART_SKIPPED, part, -1, getSimulationTime());
+                                printf("Time: %7.2f             %19s  Part %d failed %d picks, skipping it\n", getSimulationTime(), " ", part, RECOVERY_MAX_ATTEMPTS);
+                            }
+                            check_nozzle--;
                         }
-                        else if (nozzle_errors_to_check == 2)
-                        {  //the centre nozzle is second to pick a part and is second to have the alignment corrected
-                            double errortheta = getPickErrorTheta(CENTRE_NOZZLE);  //acquire the part misalignment from the look-up photo
-                            requested_theta_centre = pi[centre_nozzle_part_num].theta_target - errortheta;  //calculate misalignment of the part on the nozzle
-                            printf("Time: %7.2f             %19s  Centre part misalignment error: %3.2f  Correction required: %3.2f degrees\n", getSimulationTime()," ", errortheta, requested_theta_centre);
-                            state = FIX_NOZZLE_ERROR;
-                            printf("Time: %7.2f  New state: %.20s  Correction made to centre nozzle for part alignment\n", getSimulationTime(), state_name[state]);
+
+                        else if (check_nozzle >= 0)
+                        {
+                            double errortheta = getPickErrorTheta(check_nozzle);  //acquire the part misalignment from the look-up photo
+                            recordPick(&recovery, placements.feeder[nozzle_part[check_nozzle]], PICK_OK);
+                            requested_theta[check_nozzle] = placements.theta[nozzle_part[check_nozzle]] - errortheta;  //calculate misalignment of the part on the nozzle
+                            printf("Time: %7.2f             %19s  Part on %s misalignment error: %3.2f  Correction required: %3.2f degrees\n", getSimulationTime()," ", nozzleName(check_nozzle), errortheta,
+                                   shortestTurn(nozzle_theta[check_nozzle], requested_theta[check_nozzle]));
+                            rotate_mask |= NOZZLE_MASK(check_nozzle);  //the nozzle is turned once the head has stopped
+                            check_nozzle--;
                         }
 
-                        else if (nozzle_errors_to_check == 1)
-                        {  //the left nozzle was first to pick up a part, and if it is the only nozzle used then only one error to check
-                            double errortheta = getPickErrorTheta(LEFT_NOZZLE);  //acquire the part misalignment from the look-up photo
-                            requested_theta_left = pi[left_nozzle_part_num].theta_target - errortheta;  //calculate misalignment of the part on the nozzle
-                            printf("Time: %7.2f             %19s  Left part misalignment error: %3.2f  Correction required: %3.2f degrees\n", getSimulationTime()," ", errortheta, requested_theta_left);
+                        else if (rotate_mask != 0)
+                        {  //apply the corrections from the last nozzle to pick down to the first, all of them at once
                             state = FIX_NOZZLE_ERROR;
-                            printf("Time: %7.2f  New state: %.20s  Correction made to left nozzle for part alignment\n", getSimulationTime(), state_name[state]);
+                            for (int n = HEAD_NOZZLES - 1; n >= 0; n--)
+                            {
+                                if (!(rotate_mask & NOZZLE_MASK(n))) continue;
+                                turnNozzle(n, requested_theta[n], nozzle_theta);  //turn the nozzle the shortest way to the required angle theta
+                                printf("Time: %7.2f  New state: %.20s  Correction made to %s for part alignment\n", getSimulationTime(), state_name[state], nozzleName(n));
+                            }
+                            rotate_mask = 0;
+                        }
+
+                        else if ((reject_nozzle = firstRejectNozzle(nozzle_reject)) >= 0)
+                        {  //drop the parts picked at an angle beyond correction in the reject bin, one nozzle at a time
+                            flying = FALSE;
+                            nozzle = reject_nozzle;
+                            setTargetPos(machine.reject_x - machine.nozzle_x[nozzle], machine.reject_y);
+                            state = MOVE_TO_REJECT_BIN;
+                            printf("Time: %7.2f  New state: %.20s  Taking the part on %s to the reject bin\n", getSimulationTime(), state_name[state], nozzleName(nozzle));
+                        }
+
+                        else if (countHeldParts(nozzle_status) == 0)
+                        {  //every pick of the trip failed, start the next trip
+                            lookup_photo = FALSE;
+                            flying = FALSE;
+                            if (part_counter == number_of_components_to_place)
+                            {
+                                setTargetPos(machine.home_x, machine.home_y);
+                                state = MOVE_TO_HOME;
+                                printf("Time: %7.2f  New state: %.20s  No parts left to place, moving to home\n\n", getSimulationTime(), state_name[state]);
+                                journalAppend(JOURNAL_JOB_FINISHED, NO_PICKED_PART, -1, getSimulationTime());
+                                printFeederStatistics(&recovery);
+                            }
+                            else
+                            {
+                                state = HOME;
+                                printf("Time: %7.2f  New state: %.20s  No parts to place on this trip, moving to next feeder\n\n", getSimulationTime(), state_name[state]);
+                            }
                         }
 
                         else
-                        {  //if no more nozzle errors to check, then reset the photo variable and go to the PCB to place parts
+                        {  //if no more nozzle errors to check, then reset the photo variable, choose the placement order and go to the PCB
+                            double pick_order_travel, trip_travel;
+                            char order_text[4 * MAX_NUMBER_OF_NOZZLES + 1] = "";
+
+                            //the trip ends at the first pick of the next trip, or at home after the last part
+                            double next_x = part_counter < number_of_components_to_place ? machine.pick_x[0][placements.feeder[component_num]] : machine.home_x;
+                            double next_y = part_counter < number_of_components_to_place ? machine.pick_y[0][placements.feeder[component_num]] : machine.home_y;
+                            place_count = sequencePlacements(&placements, nozzle_status, nozzle_part, next_x, next_y, place_sequence, &trip_travel, &pick_order_travel);
+                            for (int s = 0; s < place_count; s++) sprintf(order_text + strlen(order_text), " %d", place_sequence[s]);
+                            place_step = 0;
+                            sequence_saving += pick_order_travel - trip_travel;
+                            printf("Time: %7.2f             %19s  Placement order: nozzles%s, %.0f mm, %.0f mm shorter than pick order\n", getSimulationTime(), " ", order_text, trip_travel, pick_order_travel - trip_travel);
+
                             lookup_photo = FALSE;
-                            req_target = left_nozzle_part_num;  //this is needed to obtain and calculate the relevant misalignment errors
-                            setTargetPos(pi[left_nozzle_part_num].x_target, pi[left_nozzle_part_num].y_target);
+                            flying = FALSE;
+                            nozzle = place_sequence[0];
+                            req_target = nozzle_part[nozzle];  //this is needed to obtain and calculate the relevant misalignment errors
+                            //a fly-by move ends over the first placement unless a failed pick changed the order, the peephole optimiser then drops this move
+                            setTargetPos(placements.x[req_target] - machine.nozzle_x[nozzle], placements.y[req_target]);
                             state = MOVE_TO_PCB;
                             printf("Time: %7.2f  New state: %.20s  No furthers errors. Moving to PCB\n", getSimulationTime(), state_name[state]);
                         }
                     }
 
-                    else if (isSimulatorReadyForNextInstruction() && lookdown_photo == TRUE)
+                    else if (ready && lookdown_photo == TRUE)
                     {  //calculate the difference  between the required target and the error of the gantry over the PCB
-                        preplace_diff_x = pi[req_target].x_target - (pi[req_target].x_target+getPreplaceErrorX()); //calculate the difference between the required x position and the actual x position of the gantry
-                        preplace_diff_y = pi[req_target].y_target - (pi[req_target].y_target+getPreplaceErrorY()); //calculate the difference between the required y position and the actual y position of the gantry
+                        preplace_diff_x = placements.x[req_target] - (placements.x[req_target]+getPreplaceErrorX()); //calculate the difference between the required x position and the actual x position of the gantry
+                        preplace_diff_y = placements.y[req_target] - (placements.y[req_target]+getPreplaceErrorY()); //calculate the difference between the required y position and the actual y position of the gantry
                         printf("Time: %7.2f             %19s  Preplace misalignment error: x=%3.2f y=%3.2f\n", getSimulationTime(), " ", getPreplaceErrorX(), getPreplaceErrorY());
                         amendPos(preplace_diff_x, preplace_diff_y);  //fix the gantry preplace position over the PCB
                         state = FIX_PREPLACE_ERROR;
@@ -791,53 +1167,37 @@ int main()
 
                 case FIX_NOZZLE_ERROR:
                     if (isSimulatorReadyForNextInstruction())
-                    {  //apply correction to nozzle rotation for part alignment
-                        if (nozzle_errors_to_check == 3)
-                        {   //using nozzle_errors_to_check as a counter to ensure the correct nozzle is addressed
-                            rotateNozzle(RIGHT_NOZZLE, requested_theta_right);  //rotate the nozzle by the required calculated angle theta
-                            nozzle_errors_to_check--;  //decrement to track the errors needed for correction
-                            state = CHECK_ERROR;
-                            printf("Time: %7.2f  New state: %.20s  Checking for errors...\n", getSimulationTime(),state_name[state]);
-                        }
-                        else if (nozzle_errors_to_check == 2)
-                        {   //centre nozzle is second to be corrected
-                            rotateNozzle(CENTRE_NOZZLE, requested_theta_centre);  //rotate the nozzle by the required calculated angle theta
-                            nozzle_errors_to_check--;
-                            state = CHECK_ERROR;
-                            printf("Time: %7.2f  New state: %.20s  Checking for errors...\n", getSimulationTime(),state_name[state]);
-                        }
-                        else if (nozzle_errors_to_check == 1)
-                        {   //since the left nozzle was first to pick up a part, it is last to be corrected. Applies if it is the only nozzle in use for a singular part
-                            rotateNozzle(LEFT_NOZZLE, requested_theta_left);  //rotate the nozzle by the required calculated angle theta
-                            nozzle_errors_to_check--;
-                            state = CHECK_ERROR;
-                            printf("Time: %7.2f  New state: %.20s  Checking for errors...\n", getSimulationTime(),state_name[state]);
-                        }
+                    {  //once the nozzles have turned, go on with the trip
+                        state = CHECK_ERROR;
+                        printf("Time: %7.2f  New state: %.20s  Checking for errors...\n", getSimulationTime(),state_name[state]);
                     }
                     break;
 
                 case FIX_PREPLACE_ERROR:
                     if (isSimulatorReadyForNextInstruction())
-                    {
-                        if (Left_NozzleStatus == holdingpart)
-                        {  //only need to apply correction if the nozzle is holding a part
-                            lowerNozzle(LEFT_NOZZLE);
-                            state = LOWER_LEFT_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Now lowering left nozzle to place part on PCB\n", getSimulationTime(),state_name[state]);
-                        }
-                        else if (Centre_NozzleStatus == holdingpart)
-                        {//only need to apply correction if the nozzle is holding a part
-                            lowerNozzle(CENTRE_NOZZLE);
-                            state = LOWER_CNTR_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Now lowering centre nozzle to place part on PCB\n", getSimulationTime(),state_name[state]);
-                        }
-                        else if (Right_NozzleStatus == holdingpart)
-                        {//only need to apply correction if the nozzle is holding a part
-                            lowerNozzle(RIGHT_NOZZLE);
-                            state = LOWER_RIGHT_NOZZLE;
-                            printf("Time: %7.2f  New state: %.20s  Now lowering right nozzle to place part on PCB\n", getSimulationTime(),state_name[state]);
-                        }
+                    {  //the head is over the position of the nozzle whose turn it is in the placement sequence
+                        lowerNozzle(nozzle);
+                        state = LOWER_HEAD_NOZZLE;
+                        printf("Time: %7.2f  New state: %.20s  Now lowering %s to place part on PCB\n", getSimulationTime(),state_name[state], nozzleName(nozzle));
+                    }
+                    break;
 
+                case MOVE_TO_REJECT_BIN:
+                    if (isSimulatorReadyForNextInstruction())
+                    {   //the part falls into the bin when the vacuum is released
+                        releaseVacuum(nozzle);
+                        journalAppend(JOURNAL_NOZZLE_EMPTIED, NO_PICKED_PART, nozzle, getSimulationTime());
+                        nozzle_reject[nozzle] = FALSE;
+                        state = REJECT_PART;
+                        printf("Time: %7.2f  New state: %.20s  Releasing vacuum over the reject bin\n", getSimulationTime(), state_name[state]);
+                    }
+                    break;
+
+                case REJECT_PART:
+                    if (isSimulatorReadyForNextInstruction())
+                    {   //reject any other parts, then place the rest of the trip
+                        state = CHECK_ERROR;
+                        printf("Time: %7.2f  New state: %.20s  Part rejected\n", getSimulationTime(), state_name[state]);
                     }
                     break;
 
@@ -846,15 +1206,46 @@ int main()
                     {   //moves the gantry to home position once placement of all components is complete
                         state = HOME;
                         printf("Time: %7.2f  New state: %.20s  Gantry in Home position. Placement complete. Press q to quit.\n", getSimulationTime(), state_name[state]);
+                        printPeepholeStatistics(getPeepholeStatistics(), getInstructionStatistics());
+                        if (quit_when_finished) setPnPSimulationQuitFlag();
                     }
                     break;
-
                 } //closing switch
-            sleepMilliseconds((long) 1000 / POLL_LOOP_RATE);
+
+            if (!IS_STATE_TRANSITION(previous_state, state))
+                printf("WARNING  unexpected change of state from %.20s to %.20s\n", state_name[previous_state], state_name[state]);
+
+            /* publish the controller status to remote clients and monitors */
+            status.state = state;
+            status.state_name = state_name[state];
+            status.part_counter = part_counter;
+            for (int n = 0; n < HEAD_NOZZLES; n++)
+            {
+                status.nozzle_status[n] = nozzle_status[n];
+                status.nozzle_part[n] = nozzle_part[n];
+                status.theta_pick_error[n] = getPickErrorTheta(n);
+            }
+            status.x_preplace_error = getPreplaceErrorX();
+            status.y_preplace_error = getPreplaceErrorY();
+            status.sim_time = getSimulationTime();
+            remotePublish(&status);
+            telemetryPublish(&status);
+
+            if (state == previous_state && !(state == CHECK_ERROR && lookup_photo && check_nozzle >= 0))  //the picks of a look-up photo are checked without a pause
+                waitForEvent(remoteWaitTimeout((long) 1000 / POLL_LOOP_RATE));  //nothing changed, sleep until the simulator is ready or a remote command arrives
             }//closing while loop
+
+        journalClose();
+        free(component_list);
+        placementStoreFree(&loaded_placements);
+        recoveryFree(&recovery);
+        recoveryFree(&loaded_recovery);
         }
 
 
+    placementStoreFree(&placements);
+    telemetryClose();
+    remoteClose();
     pnpClose();
     return 0;
 }
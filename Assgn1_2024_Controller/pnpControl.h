@@ -7,6 +7,9 @@
  *
  */
 
+#ifndef PNPCONTROL_H
+#define PNPCONTROL_H
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -16,12 +19,18 @@
 #include <pthread.h>
 #include <termios.h>
 #include <math.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <string.h>
 
 #define MANUAL_CONTROL 1
 #define AUTONOMOUS_CONTROL 2
 
 #define MEMORY_MAPPED_FILE "pnp_shared_file"
 #define CENTROID_FILE "centroid.txt"
+#define CONTROL_FIFO "pnp_control_fifo"             // bytes written to this FIFO are handled exactly like key presses
+#define SIMULATOR_NOTIFY_FIFO "pnp_ready_fifo"      // optional, a simulator may write one byte here whenever it becomes ready
 
 #define MAX_NUMBER_OF_COMPONENTS_TO_PLACE 100
 #define NUMBER_OF_FIELDS_IN_PLACEMENT_INFO 7
@@ -31,6 +40,7 @@
 #define CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE -2
 #define CENTROID_FILE_HAS_TOO_MANY_COMPONENTS -3
 
+/* the geometry of the simulated machine, which is the default machine profile, see pnpMachineProfile.c */
 #define HOME_X 0.0
 #define HOME_Y 0.0
 #define MIN_X -200.0
@@ -64,10 +74,28 @@
 
 #define LOOKUP_CAMERA_X -100
 #define LOOKUP_CAMERA_Y +100
+#define REJECT_BIN_X -100          // parts picked at an angle beyond correction are dropped here
+#define REJECT_BIN_Y -100
 #define PHOTO_LOOKUP 0
 #define PHOTO_LOOKDOWN 1
 
-#define POLL_LOOP_RATE 50          // poll loops per second - DANGER, changing this can result in unstable or incorrect operation
+/* whether the look-up photo shows a part on a nozzle, simulators which cannot tell leave PICK_STATUS_UNKNOWN */
+#define PICK_STATUS_UNKNOWN 0
+#define PICK_STATUS_PART_PRESENT 1
+#define PICK_STATUS_NOZZLE_EMPTY 2
+
+#define POLL_LOOP_RATE 50          // poll loops per second - only used as the idle wakeup rate of waitForEvent()
+
+#define KEY_QUEUE_SIZE 256         // key presses buffered between calls to getKey(), must be a power of 2
+#define MAX_INPUT_SOURCES 8        // additional file descriptors that can be multiplexed by waitForEvent()
+#define READY_CHECK_SLICE_MS 1     // how often the shared ready flag is sampled while the simulator is busy
+#define NOTIFIED_READY_CHECK_SLICE_MS 10   // safety net sampling period once the simulator is known to notify readiness
+
+#define EVENT_NONE 0
+#define EVENT_KEY 1
+#define EVENT_SIMULATOR_READY 2
+#define EVENT_INPUT_SOURCE 4
+#define EVENT_TIMEOUT 8
 
 #define TRUE 1
 #define FALSE 0
@@ -81,6 +109,8 @@
 
 #define NOZZLE_X_SEPARATION 20
 
+#define MAX_NUMBER_OF_NOZZLES 12   // largest head of the autonomous state machine, nozzles from NUMBER_OF_NOZZLES on use the PnPExtension block
+
 #define NO_INSTRUCTION 0
 #define MOVE_HEAD 1
 #define ROTATE_NOZZLE 2
@@ -90,6 +120,16 @@
 #define RELEASE_VACUUM 6
 #define TAKE_PHOTO 7
 #define AMEND_HEAD_POSITION 8
+#define LOWER_NOZZLES 9            // the gang pick instructions, instruction_argument_3 is a mask of nozzles, see NOZZLE_MASK()
+#define RAISE_NOZZLES 10           // only machines with gang_pick set in their profile accept these
+#define APPLY_VACUUMS 11
+#define MOVE_HEAD_VIA_CAMERA 12    // a move over the look-up camera which photographs the nozzles as the head passes it, only
+                                   // machines with flyby_camera set in their profile accept it
+#define NUMBER_OF_INSTRUCTION_TYPES 13
+
+#define NOZZLE_MASK(nozzle) (1 << (nozzle))
+
+#define LATENCY_HISTOGRAM_BINS 24      // bin b counts values from 2^(b-1) up to 2^b units, bin 0 counts values below 1 unit
 
 typedef struct
 {
@@ -106,6 +146,19 @@ typedef struct
 
 } PnP;
 
+/*
+ * follows the PnP block in the memory mapped file, for simulators of heads with more than NUMBER_OF_NOZZLES
+ * nozzles, and for simulators which report the pick status of every nozzle with the look-up photo.
+ * Simulators that only know the PnP block never write it, so it reads as zero.
+ */
+typedef struct
+{
+    double theta_pick_error[MAX_NUMBER_OF_NOZZLES - NUMBER_OF_NOZZLES];
+    int pick_status[MAX_NUMBER_OF_NOZZLES];
+    double lookup_photo_time;       // simulation time of the last look-up photo, written before a MOVE_HEAD_VIA_CAMERA ends
+
+} PnPExtension;
+
 typedef struct
 {
     char component_designation[10];
@@ -118,12 +171,56 @@ typedef struct
 
 } PlacementInfo;
 
+/* snapshot of the controller state, published to remote clients and monitors */
+typedef struct
+{
+    int operation_mode;
+    int state;
+    const char *state_name;
+    int paused;
+    int part_counter;
+    int parts_placed;
+    int number_of_components_to_place;
+    int number_of_nozzles;
+    char nozzle_status[MAX_NUMBER_OF_NOZZLES];
+    int nozzle_part[MAX_NUMBER_OF_NOZZLES];
+    double theta_pick_error[MAX_NUMBER_OF_NOZZLES];
+    double x_preplace_error;
+    double y_preplace_error;
+    double job_start_time;
+    double sim_time;
+
+} ControllerStatus;
+
+/* counters kept by the interface routines for every instruction passed to the simulator */
+typedef struct
+{
+    unsigned long long issued[NUMBER_OF_INSTRUCTION_TYPES];
+    unsigned long long completed;
+    unsigned long long latency_histogram[LATENCY_HISTOGRAM_BINS];   // wall time from issue until the simulator is ready, in microseconds
+
+} InstructionStatistics;
+
+/* counters kept by the peephole optimiser for every instruction generated by the controller, see pnpPeephole.h */
+typedef struct
+{
+    unsigned long long generated;
+    unsigned long long merged_motions;          // moves and amendments of the head merged into the head motion after them
+    unsigned long long zero_motions;            // moves to where the head already is and amendments by nothing, dropped
+    unsigned long long zero_rotations;          // turns of a nozzle to the angle it is already at, dropped
+    unsigned long long folded_rotations;        // turns replaced by a later turn of the same nozzle
+    unsigned long long reordered;               // turns moved ahead of instructions they do not depend on
+
+} PeepholeStatistics;
+
 struct termios setTerminalSettings();
 
 void resetTerminalSettings(struct termios);
 
 int getCentroidFileContents(int*, int*, PlacementInfo[MAX_NUMBER_OF_COMPONENTS_TO_PLACE]);
 
+int getNamedCentroidFileContents(const char*, int*, int*, PlacementInfo[MAX_NUMBER_OF_COMPONENTS_TO_PLACE]);
+
 void setTargetPos(double, double);
 
 void amendPos(double, double);
@@ -132,6 +229,14 @@ void lowerNozzle(int);
 
 void raiseNozzle(int);
 
+void lowerNozzles(int);
+
+void raiseNozzles(int);
+
+void applyVacuums(int);
+
+void moveHeadViaCamera(double, double);
+
 void rotateNozzle(int, double);
 
 void applyVacuum(int);
@@ -158,11 +263,38 @@ double getPickErrorY(int);
 
 double getPickErrorTheta(int);
 
+int getPickStatus(int);
+
+double getLookupPhotoTime();
+
 int isSimulatorReadyForNextInstruction();
 
 char getKey();
 
+void inputOpen();
+
+void inputClose();
+
+int waitForEvent(long);
+
+int addInputSource(int, void (*)(int));
+
+void removeInputSource(int);
+
+void queueKey(char);
+
+void setPnPSimulationQuitFlag();
+
 int isPnPSimulationQuitFlagOn();
 
 void sleepMilliseconds(long);
 
+const InstructionStatistics *getInstructionStatistics();
+
+void setPeepholeOptimiser(int);
+
+const PeepholeStatistics *getPeepholeStatistics();
+
+int histogramBin(double);
+
+#endif
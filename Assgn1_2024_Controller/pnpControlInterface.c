@@ -10,13 +10,24 @@
  *
  */
 
-#include "pnpControl.h"
+#include "pnpPeephole.h"
 
 PnP *pnp;
+PnPExtension *pnp_extension;
+PnPSharedV2 *pnp_v2;
+int shared_layout = SHARED_LAYOUT_V1;
+PnPSnapshot snapshot;                   // the copy of the PnPSharedV2 results the getters read
+unsigned int snapshot_generation = 0;   // the generation of the copy, 0 if none has been taken
 int fd;
 struct termios old_term;
-pthread_t key_thread;
-char key_pressed;
+InstructionStatistics instruction_statistics;
+struct timespec instruction_issue_time;
+int instruction_in_flight = FALSE;
+PnPInstruction pending_instruction[MAX_PENDING_INSTRUCTIONS];  // generated but not yet passed to the simulator, see pnpPeephole.h
+int pending_count = 0;
+HeadModel head_model;                   // the head as the instructions passed so far leave it
+PeepholeStatistics peephole_statistics;
+int peephole_optimiser = TRUE;
 
 /*
  Function: setTerminalSettings
@@ -95,12 +106,33 @@ void resetTerminalSettings(struct termios old_term) {
  int res = getCentroidFileContents(&operation_mode, &number_of_components_to_place, placementInfo);
  */
 int getCentroidFileContents(int *operation_mode, int *number_of_components_to_place, PlacementInfo pi[MAX_NUMBER_OF_COMPONENTS_TO_PLACE])
+{
+    return getNamedCentroidFileContents(CENTROID_FILE, operation_mode, number_of_components_to_place, pi);
+}
+
+/*
+ Function: getNamedCentroidFileContents
+ --------------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ as getCentroidFileContents(), but reads the named centroid file so that a new job can be loaded
+ while the controller is running
+ Argument(s):
+ const char *file_name - the centroid file to read
+ int *operation_mode, int *number_of_components_to_place, PlacementInfo pi[] - as getCentroidFileContents()
+ Return Value:
+ as getCentroidFileContents()
+ Usage:
+ int res = getNamedCentroidFileContents("job.txt", &operation_mode, &number_of_components_to_place, placementInfo);
+ */
+int getNamedCentroidFileContents(const char *file_name, int *operation_mode, int *number_of_components_to_place, PlacementInfo pi[MAX_NUMBER_OF_COMPONENTS_TO_PLACE])
 {
 
     char dummy_char = 'z';
     char * operation_mode_char = &dummy_char;
 
-    FILE *fp = fopen(CENTROID_FILE, "r");
+    FILE *fp = fopen(file_name, "r");
 
     if (fp == NULL) return CENTROID_FILE_NOT_PRESENT;
 
@@ -115,26 +147,232 @@ int getCentroidFileContents(int *operation_mode, int *number_of_components_to_pl
 
     for (int i = 0; i < *number_of_components_to_place; i++)
     {
-        if (fscanf(fp, "%s %s %lf %lf %lf %lf %i", &pi[i].component_designation[0], &pi[i].component_footprint[0], &pi[i].component_value, &pi[i].x_target, &pi[i].y_target, &pi[i].theta_target, &pi[i].feeder) != NUMBER_OF_FIELDS_IN_PLACEMENT_INFO) {fclose(fp); return CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;};
+        if (fscanf(fp, "%9s %9s %lf %lf %lf %lf %i", &pi[i].component_designation[0], &pi[i].component_footprint[0], &pi[i].component_value, &pi[i].x_target, &pi[i].y_target, &pi[i].theta_target, &pi[i].feeder) != NUMBER_OF_FIELDS_IN_PLACEMENT_INFO) {fclose(fp); return CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;};
     }
     fclose(fp);
     return CENTROID_FILE_PRESENT_AND_READ;
 
 }
 
+/*
+ Function: histogramBin
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ finds the bin of a logarithmic histogram with LATENCY_HISTOGRAM_BINS bins, where bin b counts
+ values from 2^(b-1) up to 2^b and bin 0 counts values below 1
+ Argument(s):
+ double value - the value to count
+ Return Value: the bin, from 0 to LATENCY_HISTOGRAM_BINS - 1
+ Usage: histogram[histogramBin(latency_us)]++;
+ */
+int histogramBin(double value)
+{
+    int bin = 0;
+
+    while (value >= 1.0 && bin < LATENCY_HISTOGRAM_BINS - 1)
+    {
+        value /= 2.0;
+        bin++;
+    }
+    return bin;
+}
+
+/*
+ Function: recordInstruction
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ counts an instruction that has just been passed to the simulator and starts timing it, the timing
+ ends when isSimulatorReadyForNextInstruction() first reports the simulator ready again
+ Argument(s):
+ int instruction - the instruction, MOVE_HEAD to APPLY_VACUUMS
+ Return Value: none
+ Usage: recordInstruction(MOVE_HEAD);
+ */
+void recordInstruction(int instruction)
+{
+    instruction_statistics.issued[instruction]++;
+    clock_gettime(CLOCK_MONOTONIC, &instruction_issue_time);
+    instruction_in_flight = TRUE;
+}
+
+/*
+ Function: passInstruction
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ passes an instruction, whose arguments have been written to the PnP block, to the simulator and records it.
+ The PnPSharedV2 block is used from the first instruction a live simulator is found advertising it, until
+ then the instruction is passed through the PnP block as before.
+ Argument(s):
+ int instruction - the instruction, MOVE_HEAD to APPLY_VACUUMS
+ Return Value: none
+ Usage: passInstruction(MOVE_HEAD);
+ */
+void passInstruction(int instruction)
+{
+    if (shared_layout == SHARED_LAYOUT_V1 && isSimulatorServingV2(pnp_v2))
+    {
+        shared_layout = SHARED_LAYOUT_V2;
+        snapshot_generation = 0;
+        printf("Simulator serves the version 2 shared memory layout\n");
+    }
+
+    if (shared_layout == SHARED_LAYOUT_V2)
+        publishInstructionV2(pnp_v2, instruction, pnp -> instruction_argument_1, pnp -> instruction_argument_2, pnp -> instruction_argument_3);
+    else
+        pnp -> instruction_to_execute = instruction;
+    recordInstruction(instruction);
+}
+
+/*
+ Function: passPendingInstruction
+ --------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ optimises the pending instructions, unless the peephole optimiser is off, and passes the first of them to the
+ simulator, which must be ready for it
+ Argument(s): none
+ Return Value: TRUE if an instruction was passed, FALSE if the optimiser dropped every pending instruction
+ Usage: if (ready && pending_count > 0 && passPendingInstruction()) ready = FALSE;
+ */
+int passPendingInstruction()
+{
+    PnPInstruction next;
+
+    if (peephole_optimiser) pending_count = optimiseInstructions(pending_instruction, pending_count, &head_model, &peephole_statistics);
+    if (pending_count == 0) return FALSE;
+
+    next = pending_instruction[0];
+    memmove(&pending_instruction[0], &pending_instruction[1], --pending_count * sizeof(PnPInstruction));
+    pnp -> instruction_argument_1 = next.argument_1;
+    pnp -> instruction_argument_2 = next.argument_2;
+    pnp -> instruction_argument_3 = next.argument_3;
+    passInstruction(next.instruction);
+    modelInstruction(&head_model, &next);
+    return TRUE;
+}
+
+/*
+ Function: generateInstruction
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ appends an instruction to the pending instructions, it is passed to the simulator by isSimulatorReadyForNextInstruction()
+ once the simulator has executed the instructions before it. The caller waits, polling the simulator, while
+ MAX_PENDING_INSTRUCTIONS instructions are pending.
+ Argument(s):
+ int instruction - the instruction, MOVE_HEAD to MOVE_HEAD_VIA_CAMERA
+ double argument_1, double argument_2, int argument_3 - its arguments, those the instruction does not use are 0
+ Return Value: none
+ Usage: generateInstruction(MOVE_HEAD, x_target, y_target, 0);
+ */
+void generateInstruction(int instruction, double argument_1, double argument_2, int argument_3)
+{
+    while (pending_count == MAX_PENDING_INSTRUCTIONS && !isPnPSimulationQuitFlagOn())
+    {
+        if (!isSimulatorReadyForNextInstruction()) sleepMilliseconds(READY_CHECK_SLICE_MS);
+    }
+    if (pending_count == MAX_PENDING_INSTRUCTIONS) return;
+
+    pending_instruction[pending_count].instruction = instruction;
+    pending_instruction[pending_count].argument_1 = argument_1;
+    pending_instruction[pending_count].argument_2 = argument_2;
+    pending_instruction[pending_count++].argument_3 = argument_3;
+    peephole_statistics.generated++;
+}
+
+/*
+ Function: refreshSnapshot
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ brings the copy of the results in the PnPSharedV2 block up to date, a copy is only taken when the
+ simulator has published new results, and the last copy is kept if a consistent one cannot be taken
+ Argument(s): none
+ Return Value: a pointer to the copy
+ Usage: double sim_time = refreshSnapshot() -> sim_time;
+ */
+const PnPSnapshot *refreshSnapshot()
+{
+    PnPSnapshot copy;
+    unsigned int generation;
+
+    if (atomic_load_explicit(&pnp_v2 -> generation, memory_order_relaxed) != snapshot_generation &&
+        (generation = readSnapshotV2(pnp_v2, &copy)) != 0)
+    {
+        snapshot = copy;
+        snapshot_generation = generation;
+    }
+    return &snapshot;
+}
+
+/*
+ Function: getInstructionStatistics
+ ----------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gets the counters kept for every instruction passed to the simulator
+ Argument(s): none
+ Return Value: a pointer to the counters, which are updated as instructions are issued and completed
+ Usage: const InstructionStatistics *statistics = getInstructionStatistics();
+ */
+const InstructionStatistics *getInstructionStatistics()
+{
+    return &instruction_statistics;
+}
+
+/*
+ Function: setPeepholeOptimiser
+ ------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: turns the peephole optimiser on, which it is from the start, or off, so every instruction is passed to the simulator as it was generated
+ Argument(s): int on - TRUE or FALSE
+ Return Value: none
+ Usage: setPeepholeOptimiser(FALSE);
+ */
+void setPeepholeOptimiser(int on)
+{
+    peephole_optimiser = on;
+}
+
+/*
+ Function: getPeepholeStatistics
+ -------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gets the counters of the instructions generated and of what the peephole optimiser did to them
+ Argument(s): none
+ Return Value: a pointer to the counters, which are updated as instructions are generated and optimised
+ Usage: printPeepholeStatistics(getPeepholeStatistics(), getInstructionStatistics());
+ */
+const PeepholeStatistics *getPeepholeStatistics()
+{
+    return &peephole_statistics;
+}
+
 /*
  Function: setTargetPos
  ----------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to move the gantry head to the specified target position
  Argument(s):
  double x_target - the target x-coordinate of the gantry head
  double y_target - the target y-coordinate of the gantry head
  Return Value:
- None, the instruction to move the head to the specified target position will always be passed to the simulator, check the simulator
+ None, the instruction to move the head to the specified target position will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  setTargetPos(x_target, y_target);
@@ -142,10 +380,7 @@ int getCentroidFileContents(int *operation_mode, int *number_of_components_to_pl
 void setTargetPos(double x_target, double y_target)
 {
 
-    pnp -> instruction_argument_1 = x_target;
-    pnp -> instruction_argument_2 = y_target;
-    pnp -> instruction_argument_3 = 0; // instruction_argument_3 is not used with the MOVE_HEAD instruction
-    pnp -> instruction_to_execute = MOVE_HEAD;
+    generateInstruction(MOVE_HEAD, x_target, y_target, 0);
 
 }
 
@@ -154,14 +389,15 @@ void setTargetPos(double x_target, double y_target)
  ------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to finely tune the gantry head position to eliminate alignment errors
  Argument(s):
  double del_x - the requested positive or negtive change in the x-coordinate of the gantry head
  double del_y - the requested positive or negtive change in the y-coordinate of the gantry head
  Return Value:
- None, the instruction to finely tune the head position by the specified amount will always be passed to the simulator, check the simulator
+ None, the instruction to finely tune the head position by the specified amount will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  amendPos(del_x, del_y);
@@ -169,10 +405,7 @@ void setTargetPos(double x_target, double y_target)
 void amendPos(double del_x, double del_y)
 {
 
-    pnp -> instruction_argument_1 = del_x;
-    pnp -> instruction_argument_2 = del_y;
-    pnp -> instruction_argument_3 = 0; // instruction_argument_3 is not used with the AMEND_HEAD instruction
-    pnp -> instruction_to_execute = AMEND_HEAD_POSITION;
+    generateInstruction(AMEND_HEAD_POSITION, del_x, del_y, 0);
 
 }
 
@@ -181,13 +414,14 @@ void amendPos(double del_x, double del_y)
  ---------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to lower the specified nozzle
  Argument(s):
  int nozzle - the nozzle to lower
  Return Value:
- None, the instruction to lower the specified nozzle will always be passed to the simulator, check the simulator
+ None, the instruction to lower the specified nozzle will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  lowerNozzle(nozzle);
@@ -195,10 +429,7 @@ void amendPos(double del_x, double del_y)
 void lowerNozzle(int nozzle)
 {
 
-    pnp -> instruction_argument_1 = 0.0;    // instruction_argument_1 is not used with the LOWER_NOZZLE instruction
-    pnp -> instruction_argument_2 = 0.0;    // instruction_argument_2 is not used with the LOWER_NOZZLE instruction
-    pnp -> instruction_argument_3 = nozzle;
-    pnp -> instruction_to_execute = LOWER_NOZZLE;
+    generateInstruction(LOWER_NOZZLE, 0.0, 0.0, nozzle);
 
 }
 
@@ -207,13 +438,14 @@ void lowerNozzle(int nozzle)
  ---------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to raise the specified nozzle
  Argument(s):
  int nozzle - the nozzle to raise
  Return Value:
- None, the instruction to raise the specified nozzle will always be passed to the simulator, check the simulator
+ None, the instruction to raise the specified nozzle will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  raiseNozzle(nozzle);
@@ -221,10 +453,106 @@ void lowerNozzle(int nozzle)
 void raiseNozzle(int nozzle)
 {
 
-    pnp -> instruction_argument_1 = 0.0;    // instruction_argument_1 is not used with the RAISE_NOZZLE instruction
-    pnp -> instruction_argument_2 = 0.0;    // instruction_argument_2 is not used with the RAISE_NOZZLE instruction
-    pnp -> instruction_argument_3 = nozzle;
-    pnp -> instruction_to_execute = RAISE_NOZZLE;
+    generateInstruction(RAISE_NOZZLE, 0.0, 0.0, nozzle);
+
+}
+
+/*
+ Function: lowerNozzles
+ ----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ instructs the simulator to lower several nozzles at once, as one instruction. Only machines with gang_pick set
+ in their profile accept it, the simulator of the assignment does not
+ Argument(s):
+ int nozzle_mask - the nozzles to lower, bit n set for nozzle n, see NOZZLE_MASK()
+ Return Value:
+ None, the instruction will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator display output to see whether or not
+ the simulator acted upon the instruction
+ Usage:
+ lowerNozzles(NOZZLE_MASK(LEFT_NOZZLE) | NOZZLE_MASK(CENTRE_NOZZLE));
+ */
+void lowerNozzles(int nozzle_mask)
+{
+
+    generateInstruction(LOWER_NOZZLES, 0.0, 0.0, nozzle_mask);
+
+}
+
+/*
+ Function: raiseNozzles
+ ----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ instructs the simulator to raise several nozzles at once, as one instruction. Only machines with gang_pick set
+ in their profile accept it, the simulator of the assignment does not
+ Argument(s):
+ int nozzle_mask - the nozzles to raise, bit n set for nozzle n, see NOZZLE_MASK()
+ Return Value:
+ None, the instruction will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator display output to see whether or not
+ the simulator acted upon the instruction
+ Usage:
+ raiseNozzles(NOZZLE_MASK(LEFT_NOZZLE) | NOZZLE_MASK(CENTRE_NOZZLE));
+ */
+void raiseNozzles(int nozzle_mask)
+{
+
+    generateInstruction(RAISE_NOZZLES, 0.0, 0.0, nozzle_mask);
+
+}
+
+/*
+ Function: applyVacuums
+ ----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ instructs the simulator to apply vacuum suction to several nozzles at once, as one instruction. Only machines with gang_pick set
+ in their profile accept it, the simulator of the assignment does not
+ Argument(s):
+ int nozzle_mask - the nozzles to apply vacuum suction to, bit n set for nozzle n, see NOZZLE_MASK()
+ Return Value:
+ None, the instruction will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator display output to see whether or not
+ the simulator acted upon the instruction
+ Usage:
+ applyVacuums(NOZZLE_MASK(LEFT_NOZZLE) | NOZZLE_MASK(CENTRE_NOZZLE));
+ */
+void applyVacuums(int nozzle_mask)
+{
+
+    generateInstruction(APPLY_VACUUMS, 0.0, 0.0, nozzle_mask);
+
+}
+
+/*
+ Function: moveHeadViaCamera
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ instructs the simulator to move the gantry head to the specified target position through the look-up camera, without
+ stopping there. The nozzles are photographed as the head passes the camera, and the results of the photo can be read
+ once getLookupPhotoTime() changes, before the move ends. Only machines with flyby_camera set in their profile accept it,
+ the simulator of the assignment does not
+ Argument(s):
+ double x_target - the target x-coordinate of the gantry head
+ double y_target - the target y-coordinate of the gantry head
+ Return Value:
+ None, the instruction will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator display output to see whether or not
+ the simulator acted upon the instruction
+ Usage:
+ moveHeadViaCamera(x_target, y_target);
+ */
+void moveHeadViaCamera(double x_target, double y_target)
+{
+
+    generateInstruction(MOVE_HEAD_VIA_CAMERA, x_target, y_target, 0);
 
 }
 
@@ -233,14 +561,15 @@ void raiseNozzle(int nozzle)
  ----------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to rotate the specified nozzle by a specified positive or negative angle in degrees
  Argument(s):
  int nozzle - the nozzle to rotate
  double angleInDegrees - the positive or negative angle of rotation in degrees
  Return Value:
- None, the instruction to rotate the specified nozzle will always be passed to the simulator, check the simulator
+ None, the instruction to rotate the specified nozzle will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  rotateNozzle(nozzle, angleInDegrees);
@@ -248,10 +577,7 @@ void raiseNozzle(int nozzle)
 void rotateNozzle(int nozzle, double angleInDegrees)
 {
 
-    pnp -> instruction_argument_1 = angleInDegrees;
-    pnp -> instruction_argument_2 = 0.0;    // instruction_argument_2 is not used with the ROTATE_NOZZLE instruction
-    pnp -> instruction_argument_3 = nozzle;
-    pnp -> instruction_to_execute = ROTATE_NOZZLE;
+    generateInstruction(ROTATE_NOZZLE, angleInDegrees, 0.0, nozzle);
 
 }
 
@@ -260,13 +586,14 @@ void rotateNozzle(int nozzle, double angleInDegrees)
  ---------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to apply vacuum suction to the specified nozzle
  Argument(s):
  int nozzle - the nozzle to apply the vacuum suction to
  Return Value:
- None, the instruction to apply vacuum suction to the specified nozzle will always be passed to the simulator, check the simulator
+ None, the instruction to apply vacuum suction to the specified nozzle will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  applyVacuum(nozzle);
@@ -274,10 +601,7 @@ void rotateNozzle(int nozzle, double angleInDegrees)
 void applyVacuum(int nozzle)
 {
 
-    pnp -> instruction_argument_1 = 0.0;    // instruction_argument_1 is not used with the APPLY_VACUUM instruction
-    pnp -> instruction_argument_2 = 0.0;    // instruction_argument_2 is not used with the APPLY_VACUUM instruction
-    pnp -> instruction_argument_3 = nozzle;
-    pnp -> instruction_to_execute = APPLY_VACUUM;
+    generateInstruction(APPLY_VACUUM, 0.0, 0.0, nozzle);
 
 }
 
@@ -286,13 +610,14 @@ void applyVacuum(int nozzle)
  -----------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to release vacuum suction from the specified nozzle
  Argument(s):
  int nozzle - the nozzle to release the vacuum suction from
  Return Value:
- None, the instruction to release vacuum suction from the specified nozzle will always be passed to the simulator, check the simulator
+ None, the instruction to release vacuum suction from the specified nozzle will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  releaseVacuum(nozzle);
@@ -300,10 +625,7 @@ void applyVacuum(int nozzle)
 void releaseVacuum(int nozzle)
 {
 
-    pnp -> instruction_argument_1 = 0.0;    // instruction_argument_1 is not used with the RELEASE_VACUUM instruction
-    pnp -> instruction_argument_2 = 0.0;    // instruction_argument_2 is not used with the RELEASE_VACUUM instruction
-    pnp -> instruction_argument_3 = nozzle;
-    pnp -> instruction_to_execute = RELEASE_VACUUM;
+    generateInstruction(RELEASE_VACUUM, 0.0, 0.0, nozzle);
 
 }
 
@@ -312,13 +634,14 @@ void releaseVacuum(int nozzle)
  -------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  instructs the simulator to take a photo using the specified camera
  Argument(s):
  int camera - the camera with which to take the photo (should be the lookup or lookdown camera)
  Return Value:
- None, the instruction to take the photo with the specified camera will always be passed to the simulator, check the simulator
+ None, the instruction to take the photo with the specified camera will be passed to the simulator once it has executed the instructions generated
+ before it, unless the peephole optimiser drops it or merges it into another, check the simulator
  display output to see whether or not the simulator acted upon the instruction
  Usage:
  takePhoto(camera);
@@ -326,47 +649,19 @@ void releaseVacuum(int nozzle)
 void takePhoto(int camera)
 {
 
-    pnp -> instruction_argument_1 = 0.0;    // instruction_argument_1 is not used with the TAKE_PHOTO instruction
-    pnp -> instruction_argument_2 = 0.0;    // instruction_argument_2 is not used with the TAKE_PHOTO instruction
-    pnp -> instruction_argument_3 = camera;
-    pnp -> instruction_to_execute = TAKE_PHOTO;
+    generateInstruction(TAKE_PHOTO, 0.0, 0.0, camera);
 
 }
 
-/*
- Function: getKeyPress
- ---------------------
- Written by Jason Brown
- Date: 30/03/2024
- Version 1.0
- Purpose:
- thread function to handle keyboard input, called as part
- of creation of a new thread
- Argument(s):  None
- Return Value: none
- Usage: not called directly but via pthread_create()
- */
-void *getKeyPress(void *arguments)
-{
-    do {
-
-        key_pressed = getchar();
-
-    } while ((key_pressed != 'q') && (key_pressed != 'Q'));
-
-    pnp -> quit = TRUE;
-    return NULL;
-}
-
 /*
  Function: pnpOpen
  -------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
- Purpose: sets the terminal settings, creates a separate thread to handle
- keyboard input, initializes and memory maps a file so that a shared memory
- segment is created with the simulator
+ Version 1.1
+ Purpose: sets the terminal settings, opens the input subsystem which multiplexes
+ keyboard input, the control FIFO and simulator notifications, initializes and
+ memory maps a file so that a shared memory segment is created with the simulator and maps the PnPSharedV2 block after it
  Argument(s): none
  Return Value: none
  Usage: pnpOpen();
@@ -376,14 +671,6 @@ void pnpOpen()
     /* disable character echoing and line buffering */
     old_term = setTerminalSettings();
 
-    /* create separate thread to handle keyboard input */
-    int res = pthread_create(&key_thread, NULL, getKeyPress, NULL);
-    if (res != 0)
-    {
-        perror("Problem creating thread to handle user input");
-        exit(1);
-    }
-
     /* initialize file */
     fd = open(MEMORY_MAPPED_FILE, (O_CREAT | O_RDWR), 0666);
     if (fd < 0)
@@ -391,16 +678,30 @@ void pnpOpen()
         perror("creation/opening of file failed");
         exit(1);
     }
-    ftruncate(fd, sizeof(PnP));
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || (file_status.st_size < (off_t)(PNP_V2_OFFSET + sizeof(PnPSharedV2)) &&
+                                         ftruncate(fd, PNP_V2_OFFSET + sizeof(PnPSharedV2)) != 0))
+    {  //a larger file, such as one the simulator has already extended, is left as it is
+        perror("sizing of file failed");
+        close(fd);
+        exit(1);
+    }
 
-    /* map the file to memory */
-    pnp = (PnP *)mmap(0, sizeof(PnP), (PROT_READ | PROT_WRITE),  MAP_SHARED, fd, (off_t)0);
+    /* map the file to memory, the extension block for larger heads follows the PnP block, and the version 2
+       block follows them at PNP_V2_OFFSET, the file is only ever grown so the simulator of the assignment is unaffected */
+    pnp = (PnP *)mmap(0, PNP_V2_OFFSET + sizeof(PnPSharedV2), (PROT_READ | PROT_WRITE),  MAP_SHARED, fd, (off_t)0);
     if (pnp == MAP_FAILED)
     {
         perror("memory mapping of file failed");
         close(fd);
         exit(2);
     }
+    pnp_extension = (PnPExtension *)(pnp + 1);
+    pnp_v2 = (PnPSharedV2 *)((char *)pnp + PNP_V2_OFFSET);
+    shared_layout = SHARED_LAYOUT_V1;
+
+    /* open the input subsystem once the shared memory segment exists, as a 'q' key press sets the quit flag */
+    inputOpen();
 }
 
 /*
@@ -410,8 +711,8 @@ void pnpOpen()
  Date: 30/03/2024
  Version 1.0
  Purpose: indicates to the simulator that the controller is quitting,
- unmaps the memory mapped file, closes the associated file descriptor
- and resets the terminal settings
+ closes the input subsystem, unmaps the memory mapped file, closes the
+ associated file descriptor and resets the terminal settings
  Argument(s): none
  Return Value: none
  Usage: pnpClose();
@@ -419,7 +720,8 @@ void pnpOpen()
 void pnpClose()
 {
     pnp -> quit = TRUE;
-    munmap(pnp, sizeof(PnP));
+    inputClose();
+    munmap(pnp, PNP_V2_OFFSET + sizeof(PnPSharedV2));
     close(fd);
 
     /* reset terminal settings to original values */
@@ -431,7 +733,7 @@ void pnpClose()
  --------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  gets the current simulation time from the simulator in seconds,
  this is not necessarily real time
@@ -444,7 +746,7 @@ void pnpClose()
  */
 double getSimTime()
 {
-    return round(10.0 * pnp -> sim_time)/10.0;
+    return round(10.0 * getSimulationTime())/10.0;
 }
 
 /*
@@ -452,10 +754,11 @@ double getSimTime()
  ---------------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  gets the current simulation time from the simulator in seconds,
- this is not necessarily real time
+ this is not necessarily real time,
+ from the PnPSharedV2 block when the simulator serves it
  Argument(s):
  none
  Return Value:
@@ -465,6 +768,7 @@ double getSimTime()
  */
 double getSimulationTime()
 {
+    if (shared_layout == SHARED_LAYOUT_V2) return refreshSnapshot() -> sim_time;
     return pnp -> sim_time;
 }
 
@@ -473,7 +777,7 @@ double getSimulationTime()
  ---------------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  gets the error in the x-positioning of the gantry head when about to place a part (assuming a lookdown photo has already been taken)
  Argument(s):
@@ -485,6 +789,7 @@ double getSimulationTime()
  */
 double getPreplaceErrorX()
 {
+    if (shared_layout == SHARED_LAYOUT_V2) return refreshSnapshot() -> x_preplace_error;
     return pnp -> x_preplace_error;
 }
 
@@ -493,7 +798,7 @@ double getPreplaceErrorX()
  ---------------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.1
  Purpose:
  gets the error in the y-positioning of the gantry head when about to place a part (assuming a lookdown photo has already been taken)
  Argument(s):
@@ -505,6 +810,7 @@ double getPreplaceErrorX()
  */
 double getPreplaceErrorY()
 {
+    if (shared_layout == SHARED_LAYOUT_V2) return refreshSnapshot() -> y_preplace_error;
     return pnp -> y_preplace_error;
 }
 
@@ -513,9 +819,10 @@ double getPreplaceErrorY()
  ---------------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.2
  Purpose:
- gets the error in the angular rotation of the picked part on the specified nozzle (assuming a lookup photo has already been taken)
+ gets the error in the angular rotation of the picked part on the specified nozzle (assuming a lookup photo has already been taken),
+ nozzles from NUMBER_OF_NOZZLES on are read from the PnPExtension block, or from the PnPSharedV2 block when the simulator serves it
  Argument(s):
  int nozzle - the nozzle for which the pick error must be determined
  Return Value:
@@ -525,52 +832,88 @@ double getPreplaceErrorY()
  */
 double getPickErrorTheta(int nozzle)
 {
+    if (shared_layout == SHARED_LAYOUT_V2) return refreshSnapshot() -> theta_pick_error[nozzle];
+    if (nozzle >= NUMBER_OF_NOZZLES) return pnp_extension -> theta_pick_error[nozzle - NUMBER_OF_NOZZLES];
     return pnp -> theta_pick_error[nozzle];
 }
 
 /*
- Function: isSimulatorReadyForNextInstruction
- --------------------------------------------
- Written by Jason Brown
- Date: 30/03/2024
- Version 1.0
+ Function: getPickStatus
+ -----------------------
+ Date: 18/10/2026
+ Version 1.1
  Purpose:
- provides information on whether the simulator has finished executing the previous instruction
+ gets whether the look-up photo shows a part on the specified nozzle (assuming a lookup photo has already been taken),
+ from the PnPExtension block, or from
+ the PnPSharedV2 block when the simulator serves it
  Argument(s):
- none
+ int nozzle - the nozzle
  Return Value:
- an int representing whether the simulator has finished executing the previous instruction (1) or not (0)
+ PICK_STATUS_PART_PRESENT, PICK_STATUS_NOZZLE_EMPTY, or PICK_STATUS_UNKNOWN if the simulator does not report it
  Usage:
- int simulatorIsReadyForNextInstruction = isSimulatorReadyForNextInstruction();
+ if (getPickStatus(nozzle) == PICK_STATUS_NOZZLE_EMPTY) ...
  */
-int isSimulatorReadyForNextInstruction()
+int getPickStatus(int nozzle)
 {
-    return pnp -> ready_for_next_instruction;
+    if (shared_layout == SHARED_LAYOUT_V2) return refreshSnapshot() -> pick_status[nozzle];
+    return pnp_extension -> pick_status[nozzle];
 }
 
 /*
- Function: getKey
- -------------------
+ Function: getLookupPhotoTime
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ gets the simulation time at which the last look-up photo was taken, from the PnPExtension block, or from the PnPSharedV2
+ block when the simulator serves it. A photo taken in flight by MOVE_HEAD_VIA_CAMERA is reported while the head is still
+ moving, so a change of the time tells the controller the pick errors of the photo can be read.
+ Argument(s): none
+ Return Value: the time in seconds, or 0 if the simulator does not report it
+ Usage: if (getLookupPhotoTime() > flight_start_time) ...
+ */
+double getLookupPhotoTime()
+{
+    if (shared_layout == SHARED_LAYOUT_V2) return refreshSnapshot() -> lookup_photo_time;
+    return pnp_extension -> lookup_photo_time;
+}
+
+/*
+ Function: isSimulatorReadyForNextInstruction
+ --------------------------------------------
  Written by Jason Brown
  Date: 30/03/2024
- Version 1.0
+ Version 1.2
  Purpose:
- gets the most recent key press by the user which has not already been handled, then resets
- the key to NO_KEY to prevent handling the same key press more than once
+ provides information on whether the simulator has finished executing the previous instruction. The simulator
+ clears instruction_to_execute when it accepts an instruction, so an instruction that has been issued but not
+ yet accepted is reported as not ready. This removes the need to sleep after issuing an instruction. When the
+ simulator serves the PnPSharedV2 block it is ready once it has executed every instruction published. While
+instructions generated by the controller are pending, the next of them is passed to the simulator as soon as it
+is ready, and the simulator is not ready until it has executed all of them.
  Argument(s):
  none
  Return Value:
- the most recent key press by the user which has not already been handled as a char,
- otherwise NO_KEY (0)
+ an int representing whether the simulator has finished executing the instructions generated so far (1) or not (0)
  Usage:
- char c = getKey();
+ int simulatorIsReadyForNextInstruction = isSimulatorReadyForNextInstruction();
  */
-char getKey()
+int isSimulatorReadyForNextInstruction()
 {
-    char c;
-    c = key_pressed;
-    key_pressed = NO_KEY;
-    return c;
+    int ready = shared_layout == SHARED_LAYOUT_V2 ? isInstructionDoneV2(pnp_v2) :
+                (pnp -> instruction_to_execute == NO_INSTRUCTION) && pnp -> ready_for_next_instruction;
+
+    if (ready && instruction_in_flight)
+    {   /* first time ready since the last instruction was issued, record how long it took */
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double latency_us = (now.tv_sec - instruction_issue_time.tv_sec) * 1e6 + (now.tv_nsec - instruction_issue_time.tv_nsec) / 1e3;
+        instruction_statistics.latency_histogram[histogramBin(latency_us)]++;
+        instruction_statistics.completed++;
+        instruction_in_flight = FALSE;
+    }
+    if (ready && pending_count > 0 && passPendingInstruction()) ready = FALSE;
+    return ready;
 }
 
 /*
@@ -595,6 +938,25 @@ int isPnPSimulationQuitFlagOn()
     return pnp -> quit;
 }
 
+/*
+ Function: setPnPSimulationQuitFlag
+ ----------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ sets the quit flag so that both the simulator and the controller quit, used by the input
+ subsystem when a 'q' key press is received
+ Argument(s):
+ none
+ Return Value: none
+ Usage:
+ setPnPSimulationQuitFlag();
+ */
+void setPnPSimulationQuitFlag()
+{
+    pnp -> quit = TRUE;
+}
+
 /*
  Function: sleepMilliseconds
  ---------------------------
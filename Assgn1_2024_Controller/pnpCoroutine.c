@@ -0,0 +1,128 @@
+/*
+ *
+ * pnpCoroutine.c - the scheduler of the coroutine runtime, which runs coroutines written with the
+ * CO_... macros of pnpCoroutine.h on the one thread of the controller
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpCoroutine.h"
+
+/*
+ Function: coSchedulerInit
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: starts a scheduler with no coroutines
+ Argument(s): CoScheduler *scheduler - the scheduler
+ Return Value: none
+ Usage: coSchedulerInit(&scheduler);
+ */
+void coSchedulerInit(CoScheduler *scheduler)
+{
+    memset(scheduler, 0, sizeof(CoScheduler));
+}
+
+/*
+ Function: coSpawn
+ -----------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ adds a coroutine to a scheduler, it first runs in the current round of coRun(), or the first round if the
+ scheduler is not running. The coroutine and its context belong to the caller, and must last until it is done.
+ Argument(s):
+ CoScheduler *scheduler - the scheduler
+ Coroutine *co - the coroutine
+ int (*body)(Coroutine*) - the function of the coroutine
+ void *context - what the coroutine keeps across waits
+ Return Value: 0 if the coroutine was added, -1 if the scheduler already runs MAX_COROUTINES
+ Usage: coSpawn(&scheduler, &flow -> co, correctNozzle, flow);
+ */
+int coSpawn(CoScheduler *scheduler, Coroutine *co, int (*body)(Coroutine*), void *context)
+{
+    if (scheduler -> count == MAX_COROUTINES) return -1;
+
+    memset(co, 0, sizeof(Coroutine));
+    co -> body = body;
+    co -> context = context;
+    co -> scheduler = scheduler;
+    scheduler -> coroutine[scheduler -> count++] = co;
+    scheduler -> progress++;
+    return 0;
+}
+
+/*
+ Function: coClaimSimulator
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gives a coroutine the simulator for its next instruction, if no other coroutine has it and it is ready
+ Argument(s): Coroutine *co - the coroutine
+ Return Value: TRUE if the coroutine may issue its instruction, otherwise FALSE
+ Usage: not called directly but via CO_INSTRUCTION()
+ */
+int coClaimSimulator(Coroutine *co)
+{
+    if (co -> scheduler -> simulator_owner != NULL || !isSimulatorReadyForNextInstruction()) return FALSE;
+
+    co -> scheduler -> simulator_owner = co;
+    return TRUE;
+}
+
+/*
+ Function: coReleaseSimulator
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: frees the simulator for the other coroutines, once it has executed the instruction of the coroutine
+ Argument(s): Coroutine *co - the coroutine which issued the instruction
+ Return Value: TRUE if the instruction has been executed, otherwise FALSE
+ Usage: not called directly but via CO_INSTRUCTION()
+ */
+int coReleaseSimulator(Coroutine *co)
+{
+    if (!isSimulatorReadyForNextInstruction()) return FALSE;
+
+    if (co -> scheduler -> simulator_owner == co) co -> scheduler -> simulator_owner = NULL;
+    return TRUE;
+}
+
+/*
+ Function: coRun
+ ---------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ runs the coroutines of a scheduler in turn, in the order they were spawned, until all of them are done or
+ the quit flag is set. When a round passes no wait the scheduler sleeps until the simulator is ready or a key
+ is pressed. Key presses other than q are not used, and are discarded.
+ Argument(s): CoScheduler *scheduler - the scheduler
+ Return Value: 0 if all the coroutines are done, -1 if the controller quit first
+ Usage: res = coRun(&scheduler);
+ */
+int coRun(CoScheduler *scheduler)
+{
+    while (scheduler -> count > 0 && !isPnPSimulationQuitFlagOn())
+    {
+        long progress = scheduler -> progress;
+        int running = 0;
+
+        getKey();
+        for (int i = 0; i < scheduler -> count; i++)
+        {   //coroutines spawned in the round run in it too
+            if (!scheduler -> coroutine[i] -> done) scheduler -> coroutine[i] -> body(scheduler -> coroutine[i]);
+        }
+        for (int i = 0; i < scheduler -> count; i++)
+        {
+            if (!scheduler -> coroutine[i] -> done) scheduler -> coroutine[running++] = scheduler -> coroutine[i];
+        }
+        if (running < scheduler -> count) scheduler -> progress++;
+        scheduler -> count = running;
+
+        if (scheduler -> progress == progress) waitForEvent(1000 / POLL_LOOP_RATE);
+    }
+    return scheduler -> count == 0 ? 0 : -1;
+}
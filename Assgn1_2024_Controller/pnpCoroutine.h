@@ -0,0 +1,102 @@
+/*
+ *
+ * pnpCoroutine.h - declarations for the coroutine runtime, which lets a sequence of instructions to the
+ * simulator be written as straight-line code rather than as states of a state machine
+ *
+ * A coroutine is a function written between CO_BEGIN() and CO_END(). CO_INSTRUCTION() issues an
+ * instruction and returns from the function until the simulator has executed it; the scheduler calls the
+ * function again later, and it carries on from where it returned. The coroutines are stackless, so a local
+ * variable does not survive a wait, and whatever a coroutine needs across waits is kept in its context.
+ * CO_BEGIN() opens a switch, so a coroutine cannot use a switch of its own around a wait.
+ *
+ * The scheduler runs its coroutines in turn on the one thread, and sleeps in waitForEvent() when none of
+ * them can go on, so they are resumed as soon as the simulator signals that it is ready. The simulator
+ * executes one instruction at a time, so the coroutines take turns to issue instructions, and coroutines of
+ * independent flows, such as the correction of each nozzle, interleave their instructions.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPCOROUTINE_H
+#define PNPCOROUTINE_H
+
+#include "pnpControl.h"
+
+#define MAX_COROUTINES 16          // coroutines a scheduler runs at once
+
+/* the result of a step of a coroutine */
+#define CO_WAITING 0
+#define CO_DONE 1
+
+typedef struct CoScheduler CoScheduler;
+typedef struct Coroutine Coroutine;
+
+struct Coroutine
+{
+    int resume;                     // the line the coroutine carries on from, 0 before it starts
+    int done;                       // TRUE once it has returned from CO_END()
+    char issued;                    // TRUE once the instruction of the CO_INSTRUCTION() it waits in has been issued
+    int (*body)(Coroutine*);        // the function of the coroutine, which returns CO_WAITING or CO_DONE
+    void *context;                  // what the coroutine keeps across waits
+    CoScheduler *scheduler;
+};
+
+struct CoScheduler
+{
+    Coroutine *coroutine[MAX_COROUTINES];
+    int count;
+    Coroutine *simulator_owner;     // the coroutine whose instruction the simulator is executing, or NULL
+    long progress;                  // counts the waits passed, the scheduler sleeps when a round passes none
+};
+
+/* the case label of a wait is reached by falling through as well as by resuming, which -Wextra would warn of */
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define CO_FALL_THROUGH __attribute__((fallthrough))
+#else
+#define CO_FALL_THROUGH
+#endif
+
+/* the body of a coroutine is enclosed by CO_BEGIN(co) and CO_END(co) */
+#define CO_BEGIN(co) switch ((co) -> resume) { case 0:
+
+#define CO_END(co) } (co) -> done = TRUE; return CO_DONE
+
+/* returns from the coroutine until condition is TRUE, the condition is evaluated each time the coroutine is resumed */
+#define CO_WAIT_UNTIL(co, condition) \
+    do \
+    { \
+        (co) -> resume = __LINE__; CO_FALL_THROUGH; case __LINE__: \
+        if (!(condition)) return CO_WAITING; \
+        (co) -> scheduler -> progress++; \
+    } while (0)
+
+/* issues an instruction once the simulator is free, e.g. CO_INSTRUCTION(co, lowerNozzle(n)), and returns from the
+   coroutine until it has been executed */
+#define CO_INSTRUCTION(co, instruction) \
+    do \
+    { \
+        (co) -> issued = FALSE; \
+        (co) -> resume = __LINE__; CO_FALL_THROUGH; case __LINE__: \
+        if (!(co) -> issued) \
+        { \
+            if (!coClaimSimulator(co)) return CO_WAITING; \
+            instruction; \
+            (co) -> issued = TRUE; \
+        } \
+        if (!coReleaseSimulator(co)) return CO_WAITING; \
+        (co) -> scheduler -> progress++; \
+    } while (0)
+
+void coSchedulerInit(CoScheduler*);
+
+int coSpawn(CoScheduler*, Coroutine*, int (*)(Coroutine*), void*);
+
+int coClaimSimulator(Coroutine*);
+
+int coReleaseSimulator(Coroutine*);
+
+int coRun(CoScheduler*);
+
+#endif
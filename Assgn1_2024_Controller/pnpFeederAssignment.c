@@ -0,0 +1,310 @@
+/*
+ *
+ * pnpFeederAssignment.c - the feeder slot assignment optimiser, which proposes which feeder each part type
+ * is loaded into
+ *
+ * Parts are grouped into units, by footprint and value where each type can have its own feeder, or by
+ * their current feeder otherwise. Each unit is assigned a feeder by the Hungarian method, minimising a
+ * travel model in which every pick costs the move from the placement of the part to the feeder and from
+ * the feeder to the look-up camera. Units are then swapped in pairs while that shortens the route found
+ * by the planner, which accounts for trips that pick from several feeders with the nozzles of the machine
+ * profile.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpFeederAssignment.h"
+#include "pnpKernels.h"
+
+/*
+ Function: assignmentMinimum
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ solves the square assignment problem with the Hungarian method in O(n^3), finding the one to one
+ assignment of rows to columns with the smallest total cost
+ Argument(s):
+ int n - the number of rows and columns
+ const double *cost - the n by n cost matrix, cost[row * n + column]
+ int column_of_row[] - set to the column assigned to each row
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: assignmentMinimum(machine.number_of_feeders, cost, unit_feeder);
+ */
+int assignmentMinimum(int n, const double *cost, int column_of_row[])
+{
+    /* potentials and matching of the rows 1 to n and columns 1 to n, column 0 is the unmatched start */
+    double *u = calloc(n + 1, sizeof(double)), *v = calloc(n + 1, sizeof(double)), *min_slack = malloc((n + 1) * sizeof(double));
+    int *row_of_column = calloc(n + 1, sizeof(int)), *previous = malloc((n + 1) * sizeof(int));
+    char *visited = malloc(n + 1);
+
+    if (u == NULL || v == NULL || min_slack == NULL || row_of_column == NULL || previous == NULL || visited == NULL)
+    {
+        free(u); free(v); free(min_slack); free(row_of_column); free(previous); free(visited);
+        return -1;
+    }
+
+    for (int row = 1; row <= n; row++)
+    {
+        int column = 0;
+
+        row_of_column[0] = row;
+        for (int j = 0; j <= n; j++)
+        {
+            min_slack[j] = INFINITY;
+            visited[j] = FALSE;
+        }
+        /* grow an alternating tree from the row until it reaches an unmatched column */
+        do
+        {
+            int i = row_of_column[column], next = 0;
+            double delta = INFINITY;
+
+            visited[column] = TRUE;
+            for (int j = 1; j <= n; j++)
+            {
+                if (visited[j]) continue;
+                double slack = cost[(i - 1) * n + (j - 1)] - u[i] - v[j];
+                if (slack < min_slack[j])
+                {
+                    min_slack[j] = slack;
+                    previous[j] = column;
+                }
+                if (min_slack[j] < delta)
+                {
+                    delta = min_slack[j];
+                    next = j;
+                }
+            }
+            for (int j = 0; j <= n; j++)
+            {
+                if (visited[j])
+                {
+                    u[row_of_column[j]] += delta;
+                    v[j] -= delta;
+                }
+                else min_slack[j] -= delta;
+            }
+            column = next;
+        } while (row_of_column[column] != 0);
+
+        /* flip the matching along the path back to the start */
+        do
+        {
+            int j = previous[column];
+            row_of_column[column] = row_of_column[j];
+            column = j;
+        } while (column != 0);
+    }
+
+    for (int j = 1; j <= n; j++) column_of_row[row_of_column[j] - 1] = j - 1;
+
+    free(u); free(v); free(min_slack); free(row_of_column); free(previous); free(visited);
+    return 0;
+}
+
+/*
+ Function: plannedRoute
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: plans a job with the feeder of each part replaced, and measures the route
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ const int feeder[] - the feeder of each part to plan with
+ int order[] - working space for store -> count part indexes
+ Return Value: the planned gantry travel in mm, or INFINITY if memory could not be allocated
+ Usage: double route = plannedRoute(store, remapped, order);
+ */
+double plannedRoute(const PlacementStore *store, const int feeder[], int order[])
+{
+    PlacementStore remapped = *store;
+
+    remapped.feeder = (int *) feeder;
+    if (planPlacements(&remapped, order) < 0) return INFINITY;
+    return routeLength(&remapped, order, remapped.count);
+}
+
+/*
+ Function: optimise
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: the body of optimiseFeeders(), given its working space
+ Argument(s):
+ as optimiseFeeders(), and working space of store -> count entries in unit[], order[], distance[], x[] and y[]
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: res = optimise(store, swap_passes, assignment, remapped_feeder, unit, order, distance, x, y);
+ */
+int optimise(const PlacementStore *store, int swap_passes, FeederAssignment *assignment, int remapped_feeder[],
+             int unit[], int order[], double distance[], double x[], double y[])
+{
+    int n = store -> count, feeders = machine.number_of_feeders, feeder_of_row[MAX_NUMBER_OF_FEEDERS];
+    double cost[MAX_FEEDER_UNITS * MAX_NUMBER_OF_FEEDERS];
+
+    /* group by footprint and value, falling back to the current feeders if there are more types than feeders */
+    assignment -> grouping = UNITS_BY_PART_TYPE;
+    for (int i = 0; i < n; i++)
+    {
+        int u;
+        for (u = 0; u < assignment -> number_of_units; u++)
+        {
+            int e = assignment -> unit_example[u];
+            if (store -> footprint[e] == store -> footprint[i] && store -> value[e] == store -> value[i]) break;
+        }
+        if (u == assignment -> number_of_units)
+        {
+            if (u == feeders)
+            {
+                assignment -> grouping = UNITS_BY_FEEDER;
+                break;
+            }
+            assignment -> unit_example[assignment -> number_of_units++] = i;
+        }
+        unit[i] = u;
+    }
+    if (assignment -> grouping == UNITS_BY_FEEDER)
+    {
+        assignment -> number_of_units = 0;
+        for (int f = 0; f < feeders; f++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                if (store -> feeder[i] != f) continue;
+                if (assignment -> unit_parts[assignment -> number_of_units] == 0) assignment -> unit_example[assignment -> number_of_units] = i;
+                assignment -> unit_parts[assignment -> number_of_units]++;
+                unit[i] = assignment -> number_of_units;
+            }
+            if (assignment -> unit_parts[assignment -> number_of_units]) assignment -> number_of_units++;
+        }
+    }
+    else for (int i = 0; i < n; i++) assignment -> unit_parts[unit[i]]++;
+
+    /*
+     * the travel model cost of each unit in each feeder, rows beyond the units are empty feeders which cost nothing.
+     * The parts of a unit are gathered so that the kernel measures them in one call per feeder.
+     */
+    for (int i = 0; i < feeders * feeders; i++) cost[i] = 0;
+    for (int u = 0; u < assignment -> number_of_units; u++)
+    {
+        int m = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (unit[i] != u) continue;
+            x[m] = store -> x[i];
+            y[m++] = store -> y[i];
+        }
+        for (int f = 0; f < feeders; f++)
+        {
+            double sum = 0;
+            pointDistances(machine.feeder_x[f], machine.feeder_y[f], x, y, m, distance);
+            for (int i = 0; i < m; i++) sum += distance[i];
+            cost[u * feeders + f] = sum + m * machine.feeder_to_camera[f];
+        }
+    }
+
+    /* the model cost of the current feeders, part by part as a type may be spread over several feeders */
+    for (int i = 0; i < n; i++)
+    {
+        int f = store -> feeder[i];
+        assignment -> model_cost_before += hypot(store -> x[i] - machine.feeder_x[f], store -> y[i] - machine.feeder_y[f]) + machine.feeder_to_camera[f];
+    }
+
+    if (assignmentMinimum(feeders, cost, feeder_of_row) != 0) return -1;
+    for (int u = 0; u < assignment -> number_of_units; u++)
+    {
+        assignment -> unit_feeder[u] = feeder_of_row[u];
+        assignment -> model_cost_after += cost[u * feeders + feeder_of_row[u]];
+    }
+
+    /* pairwise swaps of feeders, including empty ones, judged by the planned route */
+    if ((assignment -> route_before = plannedRoute(store, store -> feeder, order)) == INFINITY) return -1;
+    for (int i = 0; i < n; i++) remapped_feeder[i] = feeder_of_row[unit[i]];
+    assignment -> route_after = plannedRoute(store, remapped_feeder, order);
+
+    for (int pass = 0, improved = TRUE; pass < swap_passes && improved; pass++)
+    {
+        improved = FALSE;
+        for (int a = 0; a < feeders; a++)
+        {
+            for (int b = a + 1; b < feeders; b++)
+            {
+                if (a >= assignment -> number_of_units && b >= assignment -> number_of_units) continue;
+
+                int swapped = feeder_of_row[a];
+                feeder_of_row[a] = feeder_of_row[b];
+                feeder_of_row[b] = swapped;
+                for (int i = 0; i < n; i++) remapped_feeder[i] = feeder_of_row[unit[i]];
+
+                double route = plannedRoute(store, remapped_feeder, order);
+                if (route < assignment -> route_after - 1e-9)
+                {
+                    assignment -> route_after = route;
+                    assignment -> swaps++;
+                    improved = TRUE;
+                }
+                else
+                {
+                    feeder_of_row[b] = feeder_of_row[a];
+                    feeder_of_row[a] = swapped;
+                }
+            }
+        }
+    }
+
+    /* keep the current feeders if the proposal does not shorten the planned route */
+    if (assignment -> route_after >= assignment -> route_before)
+    {
+        for (int i = 0; i < n; i++) remapped_feeder[i] = store -> feeder[i];
+        for (int u = 0; u < assignment -> number_of_units; u++) assignment -> unit_feeder[u] = store -> feeder[assignment -> unit_example[u]];
+        assignment -> route_after = assignment -> route_before;
+        assignment -> model_cost_after = assignment -> model_cost_before;
+    }
+    else
+    {
+        assignment -> model_cost_after = 0;
+        for (int u = 0; u < assignment -> number_of_units; u++)
+        {
+            assignment -> unit_feeder[u] = feeder_of_row[u];
+            assignment -> model_cost_after += cost[u * feeders + feeder_of_row[u]];
+        }
+        for (int i = 0; i < n; i++) remapped_feeder[i] = feeder_of_row[unit[i]];
+    }
+    return 0;
+}
+
+/*
+ Function: optimiseFeeders
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ proposes the feeder of each part type of a job, see the top of this file. The proposal is never worse
+ than the current feeders by the planned route.
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ int swap_passes - the largest number of passes of the pairwise swap search, 0 for none
+ FeederAssignment *assignment - set to the units, the proposed feeders and the predicted savings
+ int remapped_feeder[] - set to the proposed feeder of each part, store -> count entries
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: optimiseFeeders(&store, 10, &assignment, remapped_feeder);
+ */
+int optimiseFeeders(const PlacementStore *store, int swap_passes, FeederAssignment *assignment, int remapped_feeder[])
+{
+    int n = store -> count, *unit = malloc((n ? n : 1) * sizeof(int)), *order = malloc((n ? n : 1) * sizeof(int));
+    double *distance = malloc((n ? n : 1) * sizeof(double)), *x = malloc((n ? n : 1) * sizeof(double)), *y = malloc((n ? n : 1) * sizeof(double));
+    int res = -1;
+
+    memset(assignment, 0, sizeof(FeederAssignment));
+    if (unit != NULL && order != NULL && distance != NULL && x != NULL && y != NULL)
+        res = optimise(store, swap_passes, assignment, remapped_feeder, unit, order, distance, x, y);
+
+    free(unit);
+    free(order);
+    free(distance);
+    free(x);
+    free(y);
+    return res;
+}
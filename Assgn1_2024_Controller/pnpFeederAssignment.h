@@ -0,0 +1,39 @@
+/*
+ *
+ * pnpFeederAssignment.h - declarations for the feeder slot assignment optimiser, which proposes which
+ * feeder each part type is loaded into
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPFEEDERASSIGNMENT_H
+#define PNPFEEDERASSIGNMENT_H
+
+#include "pnpPlanner.h"
+
+#define MAX_FEEDER_UNITS MAX_NUMBER_OF_FEEDERS
+
+/* what is moved between feeders */
+#define UNITS_BY_PART_TYPE 0        // all parts with the same footprint and value, when there are no more types than feeders
+#define UNITS_BY_FEEDER 1           // the contents of each feeder, otherwise
+
+typedef struct
+{
+    int grouping;                   // UNITS_BY_PART_TYPE or UNITS_BY_FEEDER
+    int number_of_units;
+    int unit_example[MAX_FEEDER_UNITS];     // a part of each unit, for reports
+    int unit_parts[MAX_FEEDER_UNITS];
+    int unit_feeder[MAX_FEEDER_UNITS];      // the proposed feeder of each unit
+    double model_cost_before, model_cost_after;     // the travel model minimised by the assignment, in mm
+    double route_before, route_after;               // the planned gantry travel with the current and proposed feeders, in mm
+    int swaps;                      // improvements found by the route based search after the assignment
+
+} FeederAssignment;
+
+int assignmentMinimum(int, const double*, int[]);
+
+int optimiseFeeders(const PlacementStore*, int, FeederAssignment*, int[]);
+
+#endif
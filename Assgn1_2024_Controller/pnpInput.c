@@ -0,0 +1,290 @@
+/*
+ *
+ * pnpInput.c - the input subsystem for the pick and place machine controller, which multiplexes
+ * the terminal, the control FIFO, simulator readiness notifications and any other registered
+ * file descriptors into one event loop
+ *
+ * Key presses from the terminal and bytes written to the control FIFO are queued in arrival order,
+ * so no key press is lost or handled twice. The control loop calls waitForEvent() when it has
+ * nothing to do and is woken as soon as any input arrives or the simulator becomes ready.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpControl.h"
+
+typedef struct
+{
+    int fd;
+    void (*handler)(int);
+
+} InputSource;
+
+char key_queue[KEY_QUEUE_SIZE];
+unsigned int key_queue_head = 0, key_queue_tail = 0;
+
+int terminal_fd = STDIN_FILENO;
+int control_fifo_fd = -1, control_fifo_keepalive_fd = -1;
+int simulator_notify_fd = -1, simulator_notifies = FALSE;
+
+InputSource input_sources[MAX_INPUT_SOURCES];
+int number_of_input_sources = 0;
+
+/*
+ Function: queueKey
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ adds a key press to the end of the key queue, a 'q' or 'Q' key press also sets the quit flag.
+ If the queue is full the key press is dropped and a warning is printed.
+ Argument(s):
+ char c - the key press to queue
+ Return Value: none
+ Usage: queueKey(c);
+ */
+void queueKey(char c)
+{
+    if (c == NO_KEY) return;
+
+    if (key_queue_tail - key_queue_head == KEY_QUEUE_SIZE)
+    {
+        printf("WARNING  Key queue full, key press '%c' ignored\n", c);
+        return;
+    }
+    key_queue[key_queue_tail++ & (KEY_QUEUE_SIZE - 1)] = c;
+
+    if ((c == 'q') || (c == 'Q')) setPnPSimulationQuitFlag();
+}
+
+/*
+ Function: getKey
+ ----------------
+ Date: 18/10/2026
+ Version 2.0
+ Purpose:
+ gets the oldest key press by the user which has not already been handled and removes it from the
+ key queue, so that the same key press is never handled more than once
+ Argument(s):
+ none
+ Return Value:
+ the oldest key press by the user which has not already been handled as a char,
+ otherwise NO_KEY (0)
+ Usage:
+ char c = getKey();
+ */
+char getKey()
+{
+    if (key_queue_head == key_queue_tail) return NO_KEY;
+    return key_queue[key_queue_head++ & (KEY_QUEUE_SIZE - 1)];
+}
+
+/*
+ Function: readKeys
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ reads all available bytes from a readable file descriptor into the key queue
+ Argument(s):
+ int fd - the file descriptor to read from
+ Return Value:
+ the number of bytes read, 0 on end of file, or -1 if nothing could be read
+ Usage: int n = readKeys(fd);
+ */
+int readKeys(int fd)
+{
+    char buffer[64];
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+
+    for (ssize_t i = 0; i < n; i++) queueKey(buffer[i]);
+    return (int) n;
+}
+
+/*
+ Function: inputOpen
+ -------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ opens the input subsystem. Creates and opens the control FIFO and opens the simulator
+ notification FIFO if a simulator has created it. Both are optional, the terminal on its
+ own is enough for manual control.
+ Argument(s): none
+ Return Value: none
+ Usage: inputOpen();
+ */
+void inputOpen()
+{
+    if ((mkfifo(CONTROL_FIFO, 0666) == 0) || (errno == EEXIST))
+    {
+        control_fifo_fd = open(CONTROL_FIFO, O_RDONLY | O_NONBLOCK);
+        /* hold a write end open so the FIFO does not report end of file after every writer closes */
+        if (control_fifo_fd >= 0) control_fifo_keepalive_fd = open(CONTROL_FIFO, O_WRONLY | O_NONBLOCK);
+    }
+    if (control_fifo_fd < 0) perror("WARNING  control FIFO unavailable");
+
+    simulator_notify_fd = open(SIMULATOR_NOTIFY_FIFO, O_RDONLY | O_NONBLOCK);
+}
+
+/*
+ Function: inputClose
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ closes the file descriptors opened by inputOpen() and forgets all registered input sources
+ Argument(s): none
+ Return Value: none
+ Usage: inputClose();
+ */
+void inputClose()
+{
+    if (control_fifo_keepalive_fd >= 0) close(control_fifo_keepalive_fd);
+    if (control_fifo_fd >= 0) close(control_fifo_fd);
+    if (simulator_notify_fd >= 0) close(simulator_notify_fd);
+    control_fifo_fd = control_fifo_keepalive_fd = simulator_notify_fd = -1;
+    number_of_input_sources = 0;
+}
+
+/*
+ Function: addInputSource
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ registers an additional file descriptor with the event loop, the handler is called from
+ waitForEvent() whenever the file descriptor becomes readable
+ Argument(s):
+ int fd - the file descriptor to watch
+ void (*handler)(int) - the function called with fd when it is readable
+ Return Value:
+ 0 on success, -1 if MAX_INPUT_SOURCES sources are already registered
+ Usage: addInputSource(listen_fd, acceptConnection);
+ */
+int addInputSource(int fd, void (*handler)(int))
+{
+    if (number_of_input_sources == MAX_INPUT_SOURCES) return -1;
+
+    input_sources[number_of_input_sources].fd = fd;
+    input_sources[number_of_input_sources].handler = handler;
+    number_of_input_sources++;
+    return 0;
+}
+
+/*
+ Function: removeInputSource
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ removes a file descriptor previously registered with addInputSource(), it is safe to call
+ from within the handler of that file descriptor
+ Argument(s):
+ int fd - the file descriptor to stop watching
+ Return Value: none
+ Usage: removeInputSource(client_fd);
+ */
+void removeInputSource(int fd)
+{
+    for (int i = 0; i < number_of_input_sources; i++)
+    {
+        if (input_sources[i].fd == fd)
+        {
+            input_sources[i] = input_sources[--number_of_input_sources];
+            return;
+        }
+    }
+}
+
+/*
+ Function: waitForEvent
+ ----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ blocks until a new key press is queued, an input source has been handled, the simulator becomes
+ ready for the next instruction, or the timeout expires. Key presses that were already queued do
+ not end the wait, so a caller that is not ready to handle them can leave them queued. While the
+ simulator is busy the shared ready flag is sampled every READY_CHECK_SLICE_MS, or less often once
+ the simulator has shown that it writes to the notification FIFO.
+ Argument(s):
+ long timeout_ms - the longest time to wait in ms
+ Return Value:
+ a combination of EVENT_KEY, EVENT_SIMULATOR_READY, EVENT_INPUT_SOURCE, or EVENT_TIMEOUT
+ Usage: waitForEvent(1000 / POLL_LOOP_RATE);
+ */
+int waitForEvent(long timeout_ms)
+{
+    struct pollfd fds[3 + MAX_INPUT_SOURCES];
+    int sources_fd[MAX_INPUT_SOURCES];
+    void (*sources_handler[MAX_INPUT_SOURCES])(int);
+    int events = EVENT_NONE;
+    int simulator_was_busy = !isSimulatorReadyForNextInstruction();
+
+    while ((events == EVENT_NONE) && !isPnPSimulationQuitFlagOn())
+    {
+        int nfds = 0, terminal_index = -1, fifo_index = -1, notify_index = -1, number_of_sources;
+        unsigned int keys_queued = key_queue_tail;  //only keys queued from here on end the wait
+        long slice = timeout_ms;
+
+        if (terminal_fd >= 0) {terminal_index = nfds; fds[nfds].fd = terminal_fd; fds[nfds++].events = POLLIN;}
+        if (control_fifo_fd >= 0) {fifo_index = nfds; fds[nfds].fd = control_fifo_fd; fds[nfds++].events = POLLIN;}
+        if (simulator_notify_fd >= 0) {notify_index = nfds; fds[nfds].fd = simulator_notify_fd; fds[nfds++].events = POLLIN;}
+
+        /* copy the sources, as handlers may add or remove sources while they are being dispatched */
+        number_of_sources = number_of_input_sources;
+        for (int i = 0; i < number_of_sources; i++)
+        {
+            sources_fd[i] = input_sources[i].fd;
+            sources_handler[i] = input_sources[i].handler;
+            fds[nfds].fd = sources_fd[i];
+            fds[nfds++].events = POLLIN;
+        }
+
+        if (simulator_was_busy)
+        {
+            long check = simulator_notifies ? NOTIFIED_READY_CHECK_SLICE_MS : READY_CHECK_SLICE_MS;
+            if (check < slice) slice = check;
+        }
+
+        int res = poll(fds, nfds, (int) slice);
+        if ((res < 0) && (errno != EINTR))
+        {
+            perror("poll failed in waitForEvent");
+            sleepMilliseconds(slice);
+        }
+
+        if (res > 0)
+        {
+            if ((terminal_index >= 0) && fds[terminal_index].revents)
+            {
+                /* stop watching the terminal at end of file, e.g. when input is redirected from a file */
+                if (readKeys(terminal_fd) <= 0) terminal_fd = -1;
+            }
+            if ((fifo_index >= 0) && fds[fifo_index].revents) readKeys(control_fifo_fd);
+            if ((notify_index >= 0) && fds[notify_index].revents)
+            {
+                char drain[64];
+                if (read(simulator_notify_fd, drain, sizeof(drain)) > 0) simulator_notifies = TRUE;
+            }
+            for (int i = 0; i < number_of_sources; i++)
+            {
+                if (fds[nfds - number_of_sources + i].revents)
+                {
+                    sources_handler[i](sources_fd[i]);
+                    events |= EVENT_INPUT_SOURCE;
+                }
+            }
+            if (key_queue_tail != keys_queued) events |= EVENT_KEY;
+        }
+
+        if (simulator_was_busy && isSimulatorReadyForNextInstruction()) events |= EVENT_SIMULATOR_READY;
+
+        timeout_ms -= slice;
+        if ((events == EVENT_NONE) && (timeout_ms <= 0)) events = EVENT_TIMEOUT;
+    }
+    return events;
+}
@@ -0,0 +1,387 @@
+/*
+ *
+ * pnpJournal.c - the job journal, an append-only record of the parts picked and placed from which an
+ * interrupted job is resumed
+ *
+ * Every record is written with one write() as it happens, so a record is in the journal as soon as the
+ * controller moves on, even if the controller is killed. Making the records durable against a power loss
+ * is left to a background thread, which calls fdatasync() whenever records have been appended since its
+ * last call, so records appended while a sync is under way are made durable together by the next one and
+ * the state machine never waits for the disk. Each record carries its sequence number and a hash, so a
+ * record torn by a crash ends the replay at the last whole record.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <limits.h>
+#include "pnpJournal.h"
+#include "pnpMachineProfile.h"
+
+int journal_fd = -1;
+unsigned int journal_sequence = 0;
+int journal_write_failed = FALSE;
+pthread_t journal_syncer;
+pthread_mutex_t journal_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t journal_appended = PTHREAD_COND_INITIALIZER;
+int journal_dirty = FALSE, journal_stopping = FALSE;
+
+/*
+ Function: fnv1a
+ ---------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: continues a 32 bit FNV-1a hash over a block of memory
+ Argument(s):
+ unsigned int hash - the hash so far, 2166136261 to start
+ const void *data - the block
+ size_t length - the bytes in the block
+ Return Value: the hash
+ Usage: hash = fnv1a(hash, store -> x, store -> count * sizeof(double));
+ */
+unsigned int fnv1a(unsigned int hash, const void *data, size_t length)
+{
+    const unsigned char *byte = data;
+
+    for (size_t i = 0; i < length; i++) hash = (hash ^ byte[i]) * 16777619u;
+    return hash;
+}
+
+/*
+ Function: placementFingerprint
+ ------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: hashes the positions, rotations and feeders of the parts of a job, to tell whether a journal is of the job
+ Argument(s): const PlacementStore *store - the parts of the job
+ Return Value: the fingerprint
+ Usage: unsigned int job = placementFingerprint(&placements);
+ */
+unsigned int placementFingerprint(const PlacementStore *store)
+{
+    unsigned int hash = fnv1a(2166136261u, &store -> count, sizeof(int));
+
+    hash = fnv1a(hash, store -> x, store -> count * sizeof(double));
+    hash = fnv1a(hash, store -> y, store -> count * sizeof(double));
+    hash = fnv1a(hash, store -> theta, store -> count * sizeof(double));
+    return fnv1a(hash, store -> feeder, store -> count * sizeof(int));
+}
+
+/*
+ Function: syncJournal
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: the background thread which makes appended records durable, until journalClose() stops it
+ Argument(s): void *unused - not used
+ Return Value: NULL
+ Usage: pthread_create(&journal_syncer, NULL, syncJournal, NULL);
+ */
+void *syncJournal(void *unused)
+{
+    pthread_mutex_lock(&journal_mutex);
+    while (TRUE)
+    {
+        while (!journal_dirty && !journal_stopping) pthread_cond_wait(&journal_appended, &journal_mutex);
+        if (!journal_dirty) break;
+        journal_dirty = FALSE;
+        pthread_mutex_unlock(&journal_mutex);
+        fdatasync(journal_fd);
+        pthread_mutex_lock(&journal_mutex);
+    }
+    pthread_mutex_unlock(&journal_mutex);
+    return NULL;
+}
+
+/*
+ Function: journalOpen
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ opens the journal and starts the thread which makes it durable. A resumed job continues the journal after
+ its last whole record, otherwise the journal is emptied, see journalStartJob()
+ Argument(s):
+ const char *file_name - the journal
+ const JournalReplay *replay - the replay of the journal of a resumed job, or NULL
+ Return Value: 0 on success, -1 if the journal could not be opened, in which case the controller runs without it
+ Usage: journalOpen(JOURNAL_FILE, NULL);
+ */
+int journalOpen(const char *file_name, const JournalReplay *replay)
+{
+    journal_fd = open(file_name, (O_CREAT | O_WRONLY | O_APPEND), 0666);
+    if (journal_fd < 0 || ftruncate(journal_fd, replay != NULL ? replay -> length : 0) != 0)
+    {
+        perror("WARNING  job journal unavailable");
+        if (journal_fd >= 0) close(journal_fd);
+        journal_fd = -1;
+        return -1;
+    }
+    journal_sequence = replay != NULL ? replay -> records : 0;
+    journal_dirty = journal_stopping = journal_write_failed = FALSE;
+    if (pthread_create(&journal_syncer, NULL, syncJournal, NULL) != 0)
+    {
+        printf("WARNING  job journal unavailable, its thread could not be started\n");
+        close(journal_fd);
+        journal_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ Function: journalClose
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: makes the journal durable, stops its thread and closes it
+ Argument(s): none
+ Return Value: none
+ Usage: journalClose();
+ */
+void journalClose()
+{
+    if (journal_fd < 0) return;
+    pthread_mutex_lock(&journal_mutex);
+    journal_stopping = TRUE;
+    pthread_cond_signal(&journal_appended);
+    pthread_mutex_unlock(&journal_mutex);
+    pthread_join(journal_syncer, NULL);
+    close(journal_fd);
+    journal_fd = -1;
+}
+
+/*
+ Function: appendRecord
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes a record at the end of the journal and wakes the thread which makes it durable
+ Argument(s):
+ int type - the record type, see pnpJournal.h
+ int part - the part, or the number of parts for JOURNAL_JOB_STARTED
+ int nozzle - the nozzle, or -1
+ unsigned int job - the fingerprint of the job for JOURNAL_JOB_STARTED, otherwise 0
+ double sim_time - the simulation time
+ Return Value: none
+ Usage: appendRecord(JOURNAL_PART_PLACED, part, nozzle, 0, getSimulationTime());
+ */
+void appendRecord(int type, int part, int nozzle, unsigned int job, double sim_time)
+{
+    JournalRecord record;
+
+    if (journal_fd < 0) return;
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.part = part;
+    record.nozzle = nozzle;
+    record.job = job;
+    record.sim_time = sim_time;
+    record.sequence = journal_sequence++;
+    record.check = fnv1a(2166136261u, &record, offsetof(JournalRecord, check));
+    if (write(journal_fd, &record, sizeof(record)) != sizeof(record) && !journal_write_failed)
+    {
+        perror("WARNING  job journal write failed, the job may not be resumable");
+        journal_write_failed = TRUE;
+    }
+
+    pthread_mutex_lock(&journal_mutex);
+    journal_dirty = TRUE;
+    pthread_cond_signal(&journal_appended);
+    pthread_mutex_unlock(&journal_mutex);
+}
+
+/*
+ Function: journalStartJob
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: empties the journal and records the start of a job
+ Argument(s): const PlacementStore *store - the parts of the job
+ Return Value: none
+ Usage: journalStartJob(&placements);
+ */
+void journalStartJob(const PlacementStore *store)
+{
+    if (journal_fd < 0) return;
+    if (ftruncate(journal_fd, 0) != 0) perror("WARNING  job journal could not be emptied");
+    journal_sequence = 0;
+    appendRecord(JOURNAL_JOB_STARTED, store -> count, -1, placementFingerprint(store), 0);
+}
+
+/*
+ Function: journalAppend
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: records a pick, placement or change of plan for a part or nozzle of the job
+ Argument(s):
+ int type - JOURNAL_PART_PICKED to JOURNAL_FEEDER_CHANGED
+ int part - the part, or NO_PICKED_PART
+ int nozzle - the nozzle, the new feeder of the part for JOURNAL_FEEDER_CHANGED, or -1
+ double sim_time - the simulation time
+ Return Value: none
+ Usage: journalAppend(JOURNAL_PART_PLACED, nozzle_part[nozzle], nozzle, getSimulationTime());
+ */
+void journalAppend(int type, int part, int nozzle, double sim_time)
+{
+    appendRecord(type, part, nozzle, 0, sim_time);
+}
+
+/*
+ Function: replayJournal
+ -----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ reads a journal to find the state of a job when it was interrupted, including the feeders pick recovery
+ moved parts to and the failed picks of each part. The replay stops at the first record which is torn, out
+ of sequence or out of range.
+ Argument(s):
+ const char *file_name - the journal
+ const PlacementStore *store - the parts of the job, as loaded from the centroid file
+ JournalReplay *replay - set to the state of the job, free with journalReplayFree()
+ Return Value:
+ one of:
+ JOURNAL_REPLAYED (0)
+ JOURNAL_NOT_PRESENT (-1), there is no journal, or it has no whole records
+ JOURNAL_OF_ANOTHER_JOB (-2)
+ JOURNAL_JOB_IS_FINISHED (-3), replay is set, but there is nothing to resume
+ Usage: res = replayJournal(JOURNAL_FILE, &placements, &replay);
+ */
+int replayJournal(const char *file_name, const PlacementStore *store, JournalReplay *replay)
+{
+    FILE *fp;
+    JournalRecord record;
+    int res = JOURNAL_NOT_PRESENT, finished = FALSE;
+
+    memset(replay, 0, sizeof(JournalReplay));
+    for (int n = 0; n < MAX_NUMBER_OF_NOZZLES; n++) replay -> nozzle_part[n] = NO_PICKED_PART;
+    if ((fp = fopen(file_name, "rb")) == NULL) return JOURNAL_NOT_PRESENT;
+
+    while (fread(&record, sizeof(record), 1, fp) == 1)
+    {
+        if (record.check != fnv1a(2166136261u, &record, offsetof(JournalRecord, check)) || record.sequence != replay -> records) break;
+        if (replay -> records == 0)
+        {   //the first record names the job
+            if (record.type != JOURNAL_JOB_STARTED) break;
+            if (record.part != store -> count || record.job != placementFingerprint(store))
+            {
+                res = JOURNAL_OF_ANOTHER_JOB;
+                break;
+            }
+            int size = store -> count ? store -> count : 1;
+            replay -> done = calloc(size, 1);
+            replay -> feeder = malloc(size * sizeof(int));
+            replay -> attempts = calloc(size, 1);
+            replay -> feeder_attempts = calloc(size, 1);
+            if (replay -> done == NULL || replay -> feeder == NULL || replay -> attempts == NULL || replay -> feeder_attempts == NULL) break;
+            memcpy(replay -> feeder, store -> feeder, store -> count * sizeof(int));
+            res = JOURNAL_REPLAYED;
+        }
+        else if (record.type == JOURNAL_JOB_FINISHED)
+        {
+            finished = TRUE;
+        }
+        else
+        {
+            int needs_part = record.type != JOURNAL_NOZZLE_EMPTIED;
+            int needs_nozzle = record.type != JOURNAL_PART_REQUEUED && record.type != JOURNAL_PART_SKIPPED && record.type != JOURNAL_FEEDER_CHANGED;
+
+            if (record.type < JOURNAL_PART_PICKED || record.type > JOURNAL_FEEDER_CHANGED) break;
+            if (needs_part && (record.part < 0 || record.part >= store -> count)) break;
+            if (needs_nozzle && (record.nozzle < 0 || record.nozzle >= MAX_NUMBER_OF_NOZZLES)) break;
+            if (record.type == JOURNAL_FEEDER_CHANGED && (record.nozzle < 0 || record.nozzle >= MAX_NUMBER_OF_FEEDERS)) break;
+            switch (record.type)
+            {
+                case JOURNAL_PART_PICKED:
+                    replay -> nozzle_part[record.nozzle] = record.part;
+                    break;
+
+                case JOURNAL_PART_PLACED:
+                case JOURNAL_PART_SKIPPED:
+                    if (!replay -> done[record.part])
+                    {
+                        replay -> done[record.part] = TRUE;
+                        if (record.type == JOURNAL_PART_PLACED) replay -> placed++;
+                        else replay -> skipped++;
+                    }
+                    if (record.type == JOURNAL_PART_PLACED) replay -> nozzle_part[record.nozzle] = NO_PICKED_PART;
+                    break;
+
+                case JOURNAL_NOZZLE_EMPTIED:
+                    replay -> nozzle_part[record.nozzle] = NO_PICKED_PART;
+                    break;
+
+                case JOURNAL_PART_REQUEUED:
+                    if (replay -> attempts[record.part] < UCHAR_MAX) replay -> attempts[record.part]++;
+                    if (replay -> feeder_attempts[record.part] < UCHAR_MAX) replay -> feeder_attempts[record.part]++;
+                    break;
+
+                case JOURNAL_FEEDER_CHANGED:
+                    replay -> feeder[record.part] = record.nozzle;
+                    replay -> feeder_attempts[record.part] = 0;
+                    break;
+            }
+        }
+        replay -> records++;
+    }
+    fclose(fp);
+
+    replay -> length = (off_t) replay -> records * sizeof(JournalRecord);
+    if (res == JOURNAL_REPLAYED && finished) return JOURNAL_JOB_IS_FINISHED;
+    return res;
+}
+
+/*
+ Function: journalReplayFree
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: frees the memory of a replay
+ Argument(s): JournalReplay *replay - the replay
+ Return Value: none
+ Usage: journalReplayFree(&replay);
+ */
+void journalReplayFree(JournalReplay *replay)
+{
+    free(replay -> done);
+    free(replay -> feeder);
+    free(replay -> attempts);
+    free(replay -> feeder_attempts);
+    replay -> done = NULL;
+    replay -> feeder = NULL;
+    replay -> attempts = NULL;
+    replay -> feeder_attempts = NULL;
+}
+
+/*
+ Function: orderForResume
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ moves the parts already placed or skipped to the front of a pick order, keeping the order of the rest, so
+ that the job continues from the first part not done
+ Argument(s):
+ const JournalReplay *replay - the replay of the journal of the job
+ int order[] - the store index of each part in pick order
+ int n - the number of parts in order[]
+ Return Value: the number of parts done, the index in order[] of the next part to pick, or -1 if memory could not be allocated
+ Usage: part_counter = orderForResume(&replay, component_list, number_of_components_to_place);
+ */
+int orderForResume(const JournalReplay *replay, int order[], int n)
+{
+    int *rest = malloc((n ? n : 1) * sizeof(int)), done = 0, remaining = 0;
+
+    if (rest == NULL) return -1;
+    for (int i = 0; i < n; i++)
+    {
+        if (replay -> done[order[i]]) order[done++] = order[i];
+        else rest[remaining++] = order[i];
+    }
+    memcpy(order + done, rest, remaining * sizeof(int));
+    free(rest);
+    return done;
+}
@@ -0,0 +1,77 @@
+/*
+ *
+ * pnpJournal.h - declarations for the job journal, an append-only record of the parts picked and placed
+ * from which an interrupted job is resumed
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPJOURNAL_H
+#define PNPJOURNAL_H
+
+#include <stddef.h>
+#include "pnpPlacementStore.h"
+
+#define JOURNAL_FILE "pnp_job_journal"
+
+/* record types */
+#define JOURNAL_JOB_STARTED 1       // part is the number of parts, job the fingerprint of the job
+#define JOURNAL_PART_PICKED 2       // part is on nozzle
+#define JOURNAL_PART_PLACED 3       // part is placed and nozzle is empty
+#define JOURNAL_PART_REQUEUED 4     // part will be picked again
+#define JOURNAL_PART_SKIPPED 5      // part will not be placed
+#define JOURNAL_NOZZLE_EMPTIED 6    // nozzle dropped its part, or never held it
+#define JOURNAL_JOB_FINISHED 7
+#define JOURNAL_FEEDER_CHANGED 8    // part is picked from the feeder given as nozzle from now on
+
+/* replayJournal() return values */
+#define JOURNAL_REPLAYED 0
+#define JOURNAL_NOT_PRESENT -1
+#define JOURNAL_OF_ANOTHER_JOB -2
+#define JOURNAL_JOB_IS_FINISHED -3
+
+typedef struct
+{
+    int type;
+    int part;
+    int nozzle;
+    unsigned int job;
+    double sim_time;
+    unsigned int sequence;          // counts the records of the journal from 0
+    unsigned int check;             // FNV-1a hash of the fields above, a torn or stale record does not match
+
+} JournalRecord;
+
+/* the state of a job at the end of its journal */
+typedef struct
+{
+    char *done;                                     // TRUE for each part placed or skipped
+    int *feeder;                                    // the feeder each part is picked from, changed by pick recovery
+    unsigned char *attempts;                        // failed picks of each part, see RecoveryState
+    unsigned char *feeder_attempts;                 // failed picks of each part from its current feeder
+    int placed, skipped;
+    int nozzle_part[MAX_NUMBER_OF_NOZZLES];         // the part on each nozzle, or NO_PICKED_PART
+    off_t length;                                   // bytes of whole, valid records, the journal is continued from here
+    unsigned int records;
+
+} JournalReplay;
+
+unsigned int placementFingerprint(const PlacementStore*);
+
+int journalOpen(const char*, const JournalReplay*);
+
+void journalClose();
+
+void journalStartJob(const PlacementStore*);
+
+void journalAppend(int, int, int, double);
+
+int replayJournal(const char*, const PlacementStore*, JournalReplay*);
+
+void journalReplayFree(JournalReplay*);
+
+int orderForResume(const JournalReplay*, int[], int);
+
+#endif
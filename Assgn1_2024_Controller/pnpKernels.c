@@ -0,0 +1,401 @@
+/*
+ *
+ * pnpKernels.c - the batched distance and cost kernels used by the placement planner, with scalar,
+ * SSE2 and AVX2 versions selected at run time
+ *
+ * All versions return the same nearest point, ties going to the lowest index. Sums may differ in
+ * the last bits, as the vector versions add in a different order.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include "pnpKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+typedef struct
+{
+    void (*point_distances)(double, double, const double*, const double*, int, double*);
+    void (*point_chebyshev_costs)(double, double, const double*, const double*, int, double, double, double*);
+    double (*path_length)(const double*, const double*, int);
+    int (*nearest_point)(double, double, const double*, const double*, int, double*);
+
+} KernelTable;
+
+const char kernel_level_name[NUMBER_OF_KERNEL_LEVELS][8] = {"scalar", "sse2", "avx2"};
+
+const KernelTable *kernels = NULL;
+int kernel_level = KERNELS_SCALAR;
+
+/* scalar versions, also used for the elements left over by the vector versions */
+
+void pointDistancesScalar(double px, double py, const double *x, const double *y, int n, double *out)
+{
+    for (int i = 0; i < n; i++) out[i] = sqrt((x[i] - px) * (x[i] - px) + (y[i] - py) * (y[i] - py));
+}
+
+void pointChebyshevCostsScalar(double px, double py, const double *x, const double *y, int n, double scale_x, double scale_y, double *out)
+{
+    for (int i = 0; i < n; i++) out[i] = fmax(fabs(x[i] - px) * scale_x, fabs(y[i] - py) * scale_y);
+}
+
+double pathLengthScalar(const double *x, const double *y, int n)
+{
+    double length = 0;
+
+    for (int i = 0; i + 1 < n; i++) length += sqrt((x[i + 1] - x[i]) * (x[i + 1] - x[i]) + (y[i + 1] - y[i]) * (y[i + 1] - y[i]));
+    return length;
+}
+
+/* finds the nearest of points first to n - 1, best and best_d2 hold the nearest found so far */
+int nearestPointFrom(double px, double py, const double *x, const double *y, int first, int n, int best, double *best_d2)
+{
+    for (int i = first; i < n; i++)
+    {
+        double d2 = (x[i] - px) * (x[i] - px) + (y[i] - py) * (y[i] - py);
+        if (d2 < *best_d2)
+        {
+            *best_d2 = d2;
+            best = i;
+        }
+    }
+    return best;
+}
+
+int nearestPointScalar(double px, double py, const double *x, const double *y, int n, double *distance_squared)
+{
+    double best_d2 = INFINITY;
+    int best = nearestPointFrom(px, py, x, y, 0, n, -1, &best_d2);
+
+    if (distance_squared != NULL) *distance_squared = best_d2;
+    return best;
+}
+
+const KernelTable scalar_kernels = {pointDistancesScalar, pointChebyshevCostsScalar, pathLengthScalar, nearestPointScalar};
+
+#ifdef KERNELS_X86
+
+__attribute__((target("sse2")))
+void pointDistancesSSE2(double px, double py, const double *x, const double *y, int n, double *out)
+{
+    __m128d vpx = _mm_set1_pd(px), vpy = _mm_set1_pd(py);
+    int i = 0;
+
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), vpx), dy = _mm_sub_pd(_mm_loadu_pd(y + i), vpy);
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    pointDistancesScalar(px, py, x + i, y + i, n - i, out + i);
+}
+
+__attribute__((target("sse2")))
+void pointChebyshevCostsSSE2(double px, double py, const double *x, const double *y, int n, double scale_x, double scale_y, double *out)
+{
+    __m128d vpx = _mm_set1_pd(px), vpy = _mm_set1_pd(py), vsx = _mm_set1_pd(scale_x), vsy = _mm_set1_pd(scale_y);
+    __m128d sign = _mm_set1_pd(-0.0);
+    int i = 0;
+
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d dx = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(x + i), vpx));
+        __m128d dy = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(y + i), vpy));
+        _mm_storeu_pd(out + i, _mm_max_pd(_mm_mul_pd(dx, vsx), _mm_mul_pd(dy, vsy)));
+    }
+    pointChebyshevCostsScalar(px, py, x + i, y + i, n - i, scale_x, scale_y, out + i);
+}
+
+__attribute__((target("sse2")))
+double pathLengthSSE2(const double *x, const double *y, int n)
+{
+    __m128d sum = _mm_setzero_pd();
+    double lanes[2];
+    int i = 0;
+
+    for (; i + 3 <= n; i += 2)
+    {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i + 1), _mm_loadu_pd(x + i));
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i + 1), _mm_loadu_pd(y + i));
+        sum = _mm_add_pd(sum, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + pathLengthScalar(x + i, y + i, n - i);
+}
+
+/*
+ * The vector versions of nearestPoint() make two passes. The first finds the smallest squared distance
+ * with independent minimum accumulators, the second finds the first point at that distance. This is
+ * faster than tracking the index of the minimum in each lane, which makes every step wait for the last.
+ * The passes only agree if they round alike, so this file is built with -ffp-contract=off, else a fused
+ * multiply add in one pass may not be matched by the other. The second pass takes the first point no
+ * further than the minimum, and the scalar version is used if it still finds none.
+ */
+__attribute__((target("sse2")))
+int nearestPointSSE2(double px, double py, const double *x, const double *y, int n, double *distance_squared)
+{
+    __m128d vpx = _mm_set1_pd(px), vpy = _mm_set1_pd(py);
+    __m128d m0 = _mm_set1_pd(INFINITY), m1 = m0;
+    double lanes[2], d2 = INFINITY;
+    int i = 0, best = -1;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d dx0 = _mm_sub_pd(_mm_loadu_pd(x + i), vpx), dy0 = _mm_sub_pd(_mm_loadu_pd(y + i), vpy);
+        __m128d dx1 = _mm_sub_pd(_mm_loadu_pd(x + i + 2), vpx), dy1 = _mm_sub_pd(_mm_loadu_pd(y + i + 2), vpy);
+        m0 = _mm_min_pd(m0, _mm_add_pd(_mm_mul_pd(dx0, dx0), _mm_mul_pd(dy0, dy0)));
+        m1 = _mm_min_pd(m1, _mm_add_pd(_mm_mul_pd(dx1, dx1), _mm_mul_pd(dy1, dy1)));
+    }
+    _mm_storeu_pd(lanes, _mm_min_pd(m0, m1));
+    d2 = fmin(lanes[0], lanes[1]);
+    nearestPointFrom(px, py, x, y, i, n, -1, &d2);
+
+    __m128d target = _mm_set1_pd(d2);
+    for (i = 0; i + 2 <= n && best < 0; i += 2)
+    {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), vpx), dy = _mm_sub_pd(_mm_loadu_pd(y + i), vpy);
+        int found = _mm_movemask_pd(_mm_cmple_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), target));
+        if (found) best = i + __builtin_ctz(found);
+    }
+    for (; i < n && best < 0; i++)
+    {
+        if ((x[i] - px) * (x[i] - px) + (y[i] - py) * (y[i] - py) <= d2) best = i;
+    }
+    if (best < 0 && n > 0) return nearestPointScalar(px, py, x, y, n, distance_squared);
+
+    if (distance_squared != NULL) *distance_squared = d2;
+    return best;
+}
+
+const KernelTable sse2_kernels = {pointDistancesSSE2, pointChebyshevCostsSSE2, pathLengthSSE2, nearestPointSSE2};
+
+__attribute__((target("avx2")))
+void pointDistancesAVX2(double px, double py, const double *x, const double *y, int n, double *out)
+{
+    __m256d vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), vpx), dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), vpy);
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    pointDistancesScalar(px, py, x + i, y + i, n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+void pointChebyshevCostsAVX2(double px, double py, const double *x, const double *y, int n, double scale_x, double scale_y, double *out)
+{
+    __m256d vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py), vsx = _mm256_set1_pd(scale_x), vsy = _mm256_set1_pd(scale_y);
+    __m256d sign = _mm256_set1_pd(-0.0);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d dx = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(x + i), vpx));
+        __m256d dy = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(y + i), vpy));
+        _mm256_storeu_pd(out + i, _mm256_max_pd(_mm256_mul_pd(dx, vsx), _mm256_mul_pd(dy, vsy)));
+    }
+    pointChebyshevCostsScalar(px, py, x + i, y + i, n - i, scale_x, scale_y, out + i);
+}
+
+__attribute__((target("avx2")))
+double pathLengthAVX2(const double *x, const double *y, int n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    double lanes[4];
+    int i = 0;
+
+    for (; i + 5 <= n; i += 4)
+    {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i + 1), _mm256_loadu_pd(x + i));
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i + 1), _mm256_loadu_pd(y + i));
+        sum = _mm256_add_pd(sum, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    _mm256_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + pathLengthScalar(x + i, y + i, n - i);
+}
+
+__attribute__((target("avx2")))
+int nearestPointAVX2(double px, double py, const double *x, const double *y, int n, double *distance_squared)
+{
+    __m256d vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py);
+    __m256d m0 = _mm256_set1_pd(INFINITY), m1 = m0;
+    double lanes[4], d2 = INFINITY;
+    int i = 0, best = -1;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), vpx), dy0 = _mm256_sub_pd(_mm256_loadu_pd(y + i), vpy);
+        __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), vpx), dy1 = _mm256_sub_pd(_mm256_loadu_pd(y + i + 4), vpy);
+        m0 = _mm256_min_pd(m0, _mm256_add_pd(_mm256_mul_pd(dx0, dx0), _mm256_mul_pd(dy0, dy0)));
+        m1 = _mm256_min_pd(m1, _mm256_add_pd(_mm256_mul_pd(dx1, dx1), _mm256_mul_pd(dy1, dy1)));
+    }
+    _mm256_storeu_pd(lanes, _mm256_min_pd(m0, m1));
+    d2 = fmin(fmin(lanes[0], lanes[1]), fmin(lanes[2], lanes[3]));
+    nearestPointFrom(px, py, x, y, i, n, -1, &d2);
+
+    __m256d target = _mm256_set1_pd(d2);
+    for (i = 0; i + 4 <= n && best < 0; i += 4)
+    {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), vpx), dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), vpy);
+        int found = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), target, _CMP_LE_OQ));
+        if (found) best = i + __builtin_ctz(found);
+    }
+    for (; i < n && best < 0; i++)
+    {
+        if ((x[i] - px) * (x[i] - px) + (y[i] - py) * (y[i] - py) <= d2) best = i;
+    }
+    if (best < 0 && n > 0) return nearestPointScalar(px, py, x, y, n, distance_squared);
+
+    if (distance_squared != NULL) *distance_squared = d2;
+    return best;
+}
+
+const KernelTable avx2_kernels = {pointDistancesAVX2, pointChebyshevCostsAVX2, pathLengthAVX2, nearestPointAVX2};
+
+#endif
+
+/*
+ Function: selectKernels
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ selects the version of the kernels used by all following calls. A level the processor does not
+ support falls back to the next lower level. Calling this is optional, the first kernel call
+ selects KERNELS_BEST.
+ Argument(s):
+ int level - KERNELS_BEST, KERNELS_SCALAR, KERNELS_SSE2 or KERNELS_AVX2
+ Return Value: the level selected
+ Usage: selectKernels(KERNELS_SCALAR);
+ */
+int selectKernels(int level)
+{
+    if (level == KERNELS_BEST || level >= NUMBER_OF_KERNEL_LEVELS) level = KERNELS_AVX2;
+
+    kernels = &scalar_kernels;
+    kernel_level = KERNELS_SCALAR;
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (level >= KERNELS_AVX2 && __builtin_cpu_supports("avx2"))
+    {
+        kernels = &avx2_kernels;
+        kernel_level = KERNELS_AVX2;
+    }
+    else if (level >= KERNELS_SSE2 && __builtin_cpu_supports("sse2"))
+    {
+        kernels = &sse2_kernels;
+        kernel_level = KERNELS_SSE2;
+    }
+#endif
+    return kernel_level;
+}
+
+/*
+ Function: kernelsName
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gets the name of a kernel level, for reports
+ Argument(s):
+ int level - the level, or KERNELS_BEST for the level currently selected
+ Return Value: "scalar", "sse2" or "avx2"
+ Usage: printf("kernels: %s\n", kernelsName(KERNELS_BEST));
+ */
+const char *kernelsName(int level)
+{
+    if (level < 0 || level >= NUMBER_OF_KERNEL_LEVELS)
+    {
+        if (kernels == NULL) selectKernels(KERNELS_BEST);
+        level = kernel_level;
+    }
+    return kernel_level_name[level];
+}
+
+/*
+ Function: pointDistances
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: calculates the Euclidean distance from one point to each of n points
+ Argument(s):
+ double px, double py - the point
+ const double *x, const double *y - the n points
+ int n - the number of points
+ double *out - set to the n distances
+ Return Value: none
+ Usage: pointDistances(LOOKUP_CAMERA_X, LOOKUP_CAMERA_Y, store.x, store.y, store.count, distance);
+ */
+void pointDistances(double px, double py, const double *x, const double *y, int n, double *out)
+{
+    if (kernels == NULL) selectKernels(KERNELS_BEST);
+    kernels -> point_distances(px, py, x, y, n, out);
+}
+
+/*
+ Function: pointChebyshevCosts
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ calculates the move time cost from one point to each of n points for a gantry whose x and y axes
+ move at the same time, which is that of the slower axis
+ Argument(s):
+ double px, double py - the point
+ const double *x, const double *y - the n points
+ int n - the number of points
+ double scale_x, double scale_y - the cost of moving 1 mm along each axis, e.g. the inverse axis speed
+ double *out - set to the n costs
+ Return Value: none
+ Usage: pointChebyshevCosts(x0, y0, store.x, store.y, store.count, 1.0, 1.0, cost);
+ */
+void pointChebyshevCosts(double px, double py, const double *x, const double *y, int n, double scale_x, double scale_y, double *out)
+{
+    if (kernels == NULL) selectKernels(KERNELS_BEST);
+    kernels -> point_chebyshev_costs(px, py, x, y, n, scale_x, scale_y, out);
+}
+
+/*
+ Function: pathLength
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: calculates the length of the path through n points in order
+ Argument(s):
+ const double *x, const double *y - the n points
+ int n - the number of points
+ Return Value: the sum of the Euclidean distances between consecutive points
+ Usage: length += pathLength(waypoint_x, waypoint_y, number_of_waypoints);
+ */
+double pathLength(const double *x, const double *y, int n)
+{
+    if (kernels == NULL) selectKernels(KERNELS_BEST);
+    return kernels -> path_length(x, y, n);
+}
+
+/*
+ Function: nearestPoint
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: finds the nearest of n points to a point
+ Argument(s):
+ double px, double py - the point
+ const double *x, const double *y - the n points
+ int n - the number of points
+ double *distance_squared - if not NULL, set to the squared distance to the nearest point
+ Return Value: the index of the nearest point, the lowest index if several are equally near, or -1 if n is 0
+ Usage: int next = nearestPoint(x, y, remaining_x, remaining_y, number_remaining, NULL);
+ */
+int nearestPoint(double px, double py, const double *x, const double *y, int n, double *distance_squared)
+{
+    if (kernels == NULL) selectKernels(KERNELS_BEST);
+    return kernels -> nearest_point(px, py, x, y, n, distance_squared);
+}
@@ -0,0 +1,35 @@
+/*
+ *
+ * pnpKernels.h - declarations for the batched distance and cost kernels used by the placement planner
+ *
+ * Each kernel has a scalar version and, on x86, SSE2 and AVX2 versions. The fastest version supported
+ * by the processor is selected the first time a kernel is called, or explicitly with selectKernels().
+ * Points are passed as separate x and y arrays, as held in the placement store.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPKERNELS_H
+#define PNPKERNELS_H
+
+#define KERNELS_BEST -1     // the fastest level supported by the processor
+#define KERNELS_SCALAR 0
+#define KERNELS_SSE2 1
+#define KERNELS_AVX2 2
+#define NUMBER_OF_KERNEL_LEVELS 3
+
+int selectKernels(int);
+
+const char *kernelsName(int);
+
+void pointDistances(double, double, const double*, const double*, int, double*);
+
+void pointChebyshevCosts(double, double, const double*, const double*, int, double, double, double*);
+
+double pathLength(const double*, const double*, int);
+
+int nearestPoint(double, double, const double*, const double*, int, double*);
+
+#endif
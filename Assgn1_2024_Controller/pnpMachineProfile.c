@@ -0,0 +1,444 @@
+/*
+ *
+ * pnpMachineProfile.c - the machine profile, which describes the geometry of the pick and place machine
+ *
+ * A profile file holds one setting per line as key = values, and # starts a comment. Settings not in the
+ * file keep their default. The keys are:
+ *
+ *   name = text
+ *   feeder = x y                       adds one feeder, the first feeder or feeder_bank line replaces the default feeders
+ *   feeder_bank = x y pitch count      adds count feeders from x, y, pitch apart in x
+ *   home = x y
+ *   lookup_camera = x y
+ *   reject_bin = x y                   where parts picked at an angle beyond correction are dropped
+ *   board_min = x y
+ *   board_max = x y
+ *   nozzles = count
+ *   nozzle_x_separation = mm           nozzles are evenly spaced either side of the head position
+ *   nozzle_x = x ...                   or, the x of each nozzle relative to the head position, left nozzle first
+ *   gang_pick = 0 or 1                 1 if the machine can lower, vacuum and raise several nozzles at once
+ *   flyby_camera = 0 or 1              1 if the machine can photograph the nozzles as the head passes over the look-up camera
+ *   rotation_speed = degrees/s         how fast a nozzle turns, 0 if a rotation takes the instruction time whatever its angle
+ *   rotate_while_moving = 0 or 1       1 for a hypothetical machine whose nozzles keep turning while it executes the next
+ *                                      instructions and keep their angle through the look-up photo, so the controller
+ *                                      turns the nozzles towards their parts on the way to the feeders
+ *   max_pick_error = degrees           a part picked further out is on its side or corner and goes to the reject bin,
+ *                                      0 (the default) to correct every pick, as the simulator of the assignment needs
+ *   head_speed = mm/s                  head_speed and instruction_time are used to estimate cycle times
+ *   instruction_time = s
+ *
+ * e.g. a double feeder bank
+ *
+ *   name = double bank
+ *   feeder_bank = 50 -100 100 10
+ *   feeder_bank = 50 -150 100 10
+ *
+ * or a bank of lanes which the three nozzles can gang pick from, the lane pitch is the nozzle separation
+ *
+ *   feeder_bank = 50 -100 20 10
+ *   gang_pick = 1
+ *
+ * The simulator of the assignment does not accept the gang pick instructions or MOVE_HEAD_VIA_CAMERA,
+ * gang_pick and flyby_camera are only for machines which do, such as tools/pnpSimulator.c. It turns a nozzle by
+ * the angle it is given, in a time which grows with the angle, and resets the angle of every nozzle at the
+ * look-up photo, so a turn made before the photo is lost. rotate_while_moving only describes a machine which
+ * does neither, simulated by tools/pnpSimulator.c, and is not for the simulator of the assignment.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <ctype.h>
+#include "pnpMachineProfile.h"
+
+MachineProfile machine;
+
+/*
+ Function: calculateTables
+ -------------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: calculates the tables of a profile from its geometry
+ Argument(s):
+ MachineProfile *profile - the profile
+ Return Value: none
+ Usage: calculateTables(profile);
+ */
+void calculateTables(MachineProfile *profile)
+{
+    for (int f = 0; f < profile -> number_of_feeders; f++)
+    {
+        profile -> feeder_to_camera[f] = hypot(profile -> feeder_x[f] - profile -> camera_x, profile -> feeder_y[f] - profile -> camera_y);
+        for (int n = 0; n < profile -> number_of_nozzles; n++)
+        {
+            profile -> pick_x[n][f] = profile -> feeder_x[f] - profile -> nozzle_x[n];
+            profile -> pick_y[n][f] = profile -> feeder_y[f];
+            profile -> pick_to_camera[n][f] = hypot(profile -> pick_x[n][f] - profile -> camera_x, profile -> pick_y[n][f] - profile -> camera_y);
+        }
+    }
+
+    for (int n = 0; n < profile -> number_of_nozzles; n++)
+    {
+        for (int f = 0; f < profile -> number_of_feeders; f++)
+        {
+            profile -> gang_next[n][f] = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+            for (int g = 0; n + 1 < profile -> number_of_nozzles && g < profile -> number_of_feeders; g++)
+            {
+                if (g != f && fabs(profile -> feeder_y[g] - profile -> feeder_y[f]) < GANG_PICK_TOLERANCE &&
+                    fabs(profile -> feeder_x[g] - profile -> nozzle_x[n + 1] - profile -> pick_x[n][f]) < GANG_PICK_TOLERANCE)
+                {
+                    profile -> gang_next[n][f] = g;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*
+ Function: spaceNozzles
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: places the nozzles of a profile nozzle_x_separation apart, either side of the head position
+ Argument(s):
+ MachineProfile *profile - the profile
+ Return Value: none
+ Usage: spaceNozzles(profile);
+ */
+void spaceNozzles(MachineProfile *profile)
+{
+    for (int n = 0; n < profile -> number_of_nozzles; n++)
+        profile -> nozzle_x[n] = (n - (profile -> number_of_nozzles - 1) / 2.0) * profile -> nozzle_x_separation;
+}
+
+/*
+ Function: defaultMachineProfile
+ -------------------------------
+ Date: 18/10/2026
+ Version 1.3
+ Purpose: sets a profile to the geometry of the simulated machine, given by the #defines in pnpControl.h
+ Argument(s):
+ MachineProfile *profile - the profile
+ Return Value: none
+ Usage: defaultMachineProfile(&machine);
+ */
+void defaultMachineProfile(MachineProfile *profile)
+{
+    const double feeder_x[NUMBER_OF_FEEDERS] = {FDR_0_X, FDR_1_X, FDR_2_X, FDR_3_X, FDR_4_X, FDR_5_X, FDR_6_X, FDR_7_X, FDR_8_X, FDR_9_X};
+    const double feeder_y[NUMBER_OF_FEEDERS] = {FDR_0_Y, FDR_1_Y, FDR_2_Y, FDR_3_Y, FDR_4_Y, FDR_5_Y, FDR_6_Y, FDR_7_Y, FDR_8_Y, FDR_9_Y};
+
+    memset(profile, 0, sizeof(MachineProfile));
+    strcpy(profile -> name, "default");
+    profile -> number_of_feeders = NUMBER_OF_FEEDERS;
+    for (int f = 0; f < NUMBER_OF_FEEDERS; f++)
+    {
+        profile -> feeder_x[f] = feeder_x[f];
+        profile -> feeder_y[f] = feeder_y[f];
+    }
+    profile -> home_x = HOME_X;
+    profile -> home_y = HOME_Y;
+    profile -> camera_x = LOOKUP_CAMERA_X;
+    profile -> camera_y = LOOKUP_CAMERA_Y;
+    profile -> reject_x = REJECT_BIN_X;
+    profile -> reject_y = REJECT_BIN_Y;
+    profile -> min_x = MIN_X;
+    profile -> min_y = MIN_Y;
+    profile -> max_x = MAX_X;
+    profile -> max_y = MAX_Y;
+#ifdef FIXED_NUMBER_OF_NOZZLES
+    profile -> number_of_nozzles = FIXED_NUMBER_OF_NOZZLES;
+#else
+    profile -> number_of_nozzles = NUMBER_OF_NOZZLES;
+#endif
+    profile -> nozzle_x_separation = NOZZLE_X_SEPARATION;
+    profile -> gang_pick = FALSE;
+    profile -> flyby_camera = FALSE;
+    profile -> rotate_while_moving = FALSE;
+    profile -> rotation_speed = 0;
+    profile -> max_pick_error = 0;
+    profile -> head_speed = DEFAULT_HEAD_SPEED;
+    profile -> instruction_time = DEFAULT_INSTRUCTION_TIME;
+    spaceNozzles(profile);
+    calculateTables(profile);
+}
+
+/*
+ Function: readNumbers
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the whitespace separated numbers of a profile setting
+ Argument(s):
+ const char *text - the values of the setting
+ double number[] - set to the numbers read
+ int max - the size of number[]
+ Return Value: the number of numbers read, or -1 if there is anything else in text or more than max numbers
+ Usage: if (readNumbers(values, number, 2) != 2) ...
+ */
+int readNumbers(const char *text, double number[], int max)
+{
+    int count = 0;
+    char *end;
+
+    while (TRUE)
+    {
+        while (isspace((unsigned char) *text)) text++;
+        if (*text == '\0') return count;
+        if (count == max) return -1;
+        number[count] = strtod(text, &end);
+        if (end == text) return -1;
+        count++;
+        text = end;
+    }
+}
+
+/*
+ Function: loadMachineProfile
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.4
+ Purpose:
+ sets a profile to the defaults, then applies the settings in a profile file, see the top of this file.
+ Problems with the file are printed with their line number. A controller built with FIXED_NUMBER_OF_NOZZLES
+ rejects a profile with another number of nozzles.
+ Argument(s):
+ const char *file_name - the profile file to read
+ MachineProfile *profile - the profile
+ Return Value:
+ one of:
+ MACHINE_PROFILE_PRESENT_AND_READ (0)
+ MACHINE_PROFILE_NOT_PRESENT (-1), the profile is then the default profile
+ MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE (-2)
+ Usage: res = loadMachineProfile(MACHINE_PROFILE_FILE, &machine);
+ */
+int loadMachineProfile(const char *file_name, MachineProfile *profile)
+{
+    FILE *fp;
+    char line[MACHINE_PROFILE_LINE_LENGTH];
+    int line_number = 0, feeders_given = FALSE, nozzle_x_given = FALSE, res = MACHINE_PROFILE_PRESENT_AND_READ;
+
+    defaultMachineProfile(profile);
+    if ((fp = fopen(file_name, "r")) == NULL) return MACHINE_PROFILE_NOT_PRESENT;
+
+    while (res == MACHINE_PROFILE_PRESENT_AND_READ && fgets(line, sizeof(line), fp) != NULL)
+    {
+        char *key = line, *values, *p;
+        double number[MAX_NUMBER_OF_FEEDERS];
+        int count = -1;
+
+        line_number++;
+        if ((p = strchr(line, '#')) != NULL) *p = '\0';
+        while (isspace((unsigned char) *key)) key++;
+        if (*key == '\0') continue;
+        if ((values = strchr(key, '=')) == NULL)
+        {
+            printf("Machine profile %s line %d: expected key = values\n", file_name, line_number);
+            res = MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE;
+            break;
+        }
+        for (p = values; p > key && isspace((unsigned char) p[-1]); p--);
+        *p = '\0';
+        values++;
+
+        if (strcmp(key, "name") == 0)
+        {
+            while (isspace((unsigned char) *values)) values++;
+            for (p = values + strlen(values); p > values && isspace((unsigned char) p[-1]); p--);
+            *p = '\0';
+            snprintf(profile -> name, sizeof(profile -> name), "%s", values);
+            count = 0;
+        }
+        else if (strcmp(key, "feeder") == 0 || strcmp(key, "feeder_bank") == 0)
+        {
+            int bank = strcmp(key, "feeder_bank") == 0;
+
+            if (!feeders_given) profile -> number_of_feeders = 0;
+            feeders_given = TRUE;
+            count = readNumbers(values, number, 4);
+            if (count == (bank ? 4 : 2))
+            {
+                int number_in_bank = bank ? (int) number[3] : 1;
+                if (number_in_bank < 1 || profile -> number_of_feeders + number_in_bank > MAX_NUMBER_OF_FEEDERS) count = -1;
+                for (int f = 0; count >= 0 && f < number_in_bank; f++)
+                {
+                    profile -> feeder_x[profile -> number_of_feeders] = number[0] + (bank ? f * number[2] : 0);
+                    profile -> feeder_y[profile -> number_of_feeders++] = number[1];
+                }
+            }
+            else count = -1;
+        }
+        else if (strcmp(key, "home") == 0 || strcmp(key, "lookup_camera") == 0 || strcmp(key, "reject_bin") == 0 ||
+                 strcmp(key, "board_min") == 0 || strcmp(key, "board_max") == 0)
+        {
+            double *x = key[0] == 'h' ? &profile -> home_x : key[0] == 'l' ? &profile -> camera_x : key[0] == 'r' ? &profile -> reject_x :
+                        key[7] == 'i' ? &profile -> min_x : &profile -> max_x;
+            double *y = key[0] == 'h' ? &profile -> home_y : key[0] == 'l' ? &profile -> camera_y : key[0] == 'r' ? &profile -> reject_y :
+                        key[7] == 'i' ? &profile -> min_y : &profile -> max_y;
+
+            if ((count = readNumbers(values, number, 2)) == 2)
+            {
+                *x = number[0];
+                *y = number[1];
+            }
+            else count = -1;
+        }
+        else if (strcmp(key, "nozzles") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && number[0] >= 1 && number[0] <= MAX_NUMBER_OF_NOZZLES && number[0] == (int) number[0])
+                profile -> number_of_nozzles = (int) number[0];
+            else count = -1;
+        }
+        else if (strcmp(key, "nozzle_x_separation") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && number[0] >= 0) profile -> nozzle_x_separation = number[0];
+            else count = -1;
+        }
+        else if (strcmp(key, "nozzle_x") == 0)
+        {
+            if ((count = readNumbers(values, number, MAX_NUMBER_OF_NOZZLES)) >= 1)
+            {
+                for (int n = 0; n < count; n++) profile -> nozzle_x[n] = number[n];
+                nozzle_x_given = count;
+            }
+            else count = -1;
+        }
+        else if (strcmp(key, "gang_pick") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && (number[0] == 0 || number[0] == 1)) profile -> gang_pick = (int) number[0];
+            else count = -1;
+        }
+        else if (strcmp(key, "flyby_camera") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && (number[0] == 0 || number[0] == 1)) profile -> flyby_camera = (int) number[0];
+            else count = -1;
+        }
+        else if (strcmp(key, "rotate_while_moving") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && (number[0] == 0 || number[0] == 1)) profile -> rotate_while_moving = (int) number[0];
+            else count = -1;
+        }
+        else if (strcmp(key, "rotation_speed") == 0 || strcmp(key, "max_pick_error") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && number[0] >= 0)
+                *(key[0] == 'r' ? &profile -> rotation_speed : &profile -> max_pick_error) = number[0];
+            else count = -1;
+        }
+        else if (strcmp(key, "head_speed") == 0 || strcmp(key, "instruction_time") == 0)
+        {
+            if ((count = readNumbers(values, number, 1)) == 1 && number[0] > 0)
+                *(key[0] == 'h' ? &profile -> head_speed : &profile -> instruction_time) = number[0];
+            else count = -1;
+        }
+        else
+        {
+            printf("Machine profile %s line %d: unknown key %s\n", file_name, line_number, key);
+            res = MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE;
+            break;
+        }
+
+        if (count < 0)
+        {
+            printf("Machine profile %s line %d: bad values for %s\n", file_name, line_number, key);
+            res = MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE;
+        }
+    }
+    fclose(fp);
+
+    if (res == MACHINE_PROFILE_PRESENT_AND_READ && nozzle_x_given && nozzle_x_given != profile -> number_of_nozzles)
+    {
+        printf("Machine profile %s: nozzle_x gives %d nozzles, but there are %d\n", file_name, nozzle_x_given, profile -> number_of_nozzles);
+        res = MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE;
+    }
+#ifdef FIXED_NUMBER_OF_NOZZLES
+    if (res == MACHINE_PROFILE_PRESENT_AND_READ && profile -> number_of_nozzles != FIXED_NUMBER_OF_NOZZLES)
+    {
+        printf("Machine profile %s: the controller was built for %d nozzles, but there are %d\n", file_name, FIXED_NUMBER_OF_NOZZLES, profile -> number_of_nozzles);
+        res = MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE;
+    }
+#endif
+    if (res == MACHINE_PROFILE_PRESENT_AND_READ && (profile -> min_x >= profile -> max_x || profile -> min_y >= profile -> max_y))
+    {
+        printf("Machine profile %s: board_min must be below and left of board_max\n", file_name);
+        res = MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE;
+    }
+
+    if (!nozzle_x_given) spaceNozzles(profile);
+    calculateTables(profile);
+    return res;
+}
+
+/*
+ Function: printMachineProfile
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.3
+ Purpose: prints the geometry of a profile
+ Argument(s):
+ const MachineProfile *profile - the profile
+ Return Value: none
+ Usage: printMachineProfile(&machine);
+ */
+void printMachineProfile(const MachineProfile *profile)
+{
+    printf("Machine profile: %s, %d feeders, %d nozzles at x", profile -> name, profile -> number_of_feeders, profile -> number_of_nozzles);
+    for (int n = 0; n < profile -> number_of_nozzles; n++) printf(" %+.1f", profile -> nozzle_x[n]);
+    printf(", camera at %.1f %.1f, home at %.1f %.1f, reject bin at %.1f %.1f\n", profile -> camera_x, profile -> camera_y, profile -> home_x, profile -> home_y,
+           profile -> reject_x, profile -> reject_y);
+    printf("Head speed %.0f mm/s, %.3f s per instruction, gang pick %s, fly-by camera %s\n", profile -> head_speed, profile -> instruction_time,
+           profile -> gang_pick ? "on" : "off", profile -> flyby_camera ? "on" : "off");
+    if (profile -> rotation_speed > 0 || profile -> rotate_while_moving)
+        printf("Nozzles turn at %.0f degrees/s, %s\n", profile -> rotation_speed, profile -> rotate_while_moving ? "while the machine moves on" : "one instruction at a time");
+    if (profile -> max_pick_error > 0) printf("Parts picked more than %.1f degrees out go to the reject bin\n", profile -> max_pick_error);
+    for (int f = 0; f < profile -> number_of_feeders; f++)
+    {
+        printf("  Feeder %d at %.1f %.1f", f, profile -> feeder_x[f], profile -> feeder_y[f]);
+        if (profile -> gang_pick && profile -> gang_next[0][f] != NO_TAPE_FEEDER_AT_THIS_LOCATION)
+            printf(", gang picks feeder %d with the next nozzle", profile -> gang_next[0][f]);
+        printf("\n");
+    }
+    printf("\n");
+}
+
+/*
+ Function: shortestTurn
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ the turn which takes a nozzle from one angle to another the shortest way round. The machine turns a nozzle by
+ the angle it is given, a nozzle at 350 degrees told to turn by -340 degrees goes the long way round to 10, so
+ the controller sends the turn rather than the difference of the angles
+ Argument(s):
+ double from - the angle of the nozzle in degrees
+ double to - the angle wanted, in degrees
+ Return Value: the turn in degrees, more than -180 and at most 180
+ Usage: nozzle_theta[n] += shortestTurn(nozzle_theta[n], requested_theta[n]);
+ */
+double shortestTurn(double from, double to)
+{
+    double turn = fmod(to - from, 360.0);
+
+    if (turn > 180.0) turn -= 360.0;
+    else if (turn <= -180.0) turn += 360.0;
+    return turn;
+}
+
+/*
+ Function: resetNozzleAngles
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ the look-up photo resets the angle of every nozzle, so the pick error it reads is the whole angle of the part
+ and the correction is turned from zero. A machine with rotate_while_moving keeps the angles of its nozzles.
+ Argument(s): double nozzle_theta[] - the angle of each nozzle as the controller keeps it
+ Return Value: none
+ Usage: resetNozzleAngles(nozzle_theta);
+ */
+void resetNozzleAngles(double nozzle_theta[])
+{
+    if (machine.rotate_while_moving) return;
+    for (int n = 0; n < MAX_NUMBER_OF_NOZZLES; n++) nozzle_theta[n] = 0;
+}
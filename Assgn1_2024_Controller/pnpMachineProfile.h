@@ -0,0 +1,89 @@
+/*
+ *
+ * pnpMachineProfile.h - declarations for the machine profile, which describes the geometry of the pick and
+ * place machine and is loaded at startup
+ *
+ * The defaults are the geometry of the simulated machine given by the #defines in pnpControl.h. The
+ * profile only describes the machine to the controller, it must match the machine being controlled.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPMACHINEPROFILE_H
+#define PNPMACHINEPROFILE_H
+
+#include "pnpControl.h"
+
+#define MACHINE_PROFILE_FILE "pnp_machine_profile.txt"
+
+#define MAX_NUMBER_OF_FEEDERS 64
+#define MACHINE_PROFILE_LINE_LENGTH 1024
+
+#define DEFAULT_HEAD_SPEED 500.0           // mm/s, only used to estimate cycle times
+#define DEFAULT_INSTRUCTION_TIME 0.2       // s, the time taken by an instruction other than the travel of a move
+#define GANG_PICK_TOLERANCE 0.01           // mm, how close a feeder must be to a nozzle to be picked by a gang pick
+
+/* building with -DFIXED_NUMBER_OF_NOZZLES=n makes the nozzle count of the head a compile-time constant, so the
+   loops over the nozzles in the planner and the state machine have a constant bound the compiler can unroll.
+   Profiles must then give that many nozzles. Otherwise the count is read from the profile. */
+#ifdef FIXED_NUMBER_OF_NOZZLES
+#if FIXED_NUMBER_OF_NOZZLES < 1 || FIXED_NUMBER_OF_NOZZLES > MAX_NUMBER_OF_NOZZLES
+#error FIXED_NUMBER_OF_NOZZLES must be from 1 to MAX_NUMBER_OF_NOZZLES
+#endif
+#define HEAD_NOZZLES FIXED_NUMBER_OF_NOZZLES
+#else
+#define HEAD_NOZZLES (machine.number_of_nozzles)
+#endif
+
+#define MACHINE_PROFILE_PRESENT_AND_READ 0
+#define MACHINE_PROFILE_NOT_PRESENT -1
+#define MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE -2
+
+typedef struct
+{
+    char name[64];
+    int number_of_feeders;
+    double feeder_x[MAX_NUMBER_OF_FEEDERS], feeder_y[MAX_NUMBER_OF_FEEDERS];
+    double home_x, home_y;
+    double camera_x, camera_y;                      // the look-up camera
+    double reject_x, reject_y;                      // the reject bin
+    double min_x, min_y, max_x, max_y;              // the board envelope
+    int number_of_nozzles;                          // at most MAX_NUMBER_OF_NOZZLES, the simulated head has NUMBER_OF_NOZZLES,
+                                                    // HEAD_NOZZLES for the profile in use
+    double nozzle_x_separation;
+    double nozzle_x[MAX_NUMBER_OF_NOZZLES];         // x of each nozzle relative to the head position, left nozzle first
+    int gang_pick;                                  // TRUE if the machine accepts LOWER_NOZZLES, APPLY_VACUUMS and RAISE_NOZZLES
+    int flyby_camera;                               // TRUE if the machine accepts MOVE_HEAD_VIA_CAMERA
+    int rotate_while_moving;                        // TRUE if a nozzle keeps turning while the machine executes the next instructions,
+                                                    // and keeps its angle through the look-up photo, a hypothetical machine
+    double rotation_speed;                          // degrees/s, or 0 if a rotation takes no longer than any other instruction
+    double max_pick_error;                          // degrees, a larger pick error is a part picked on its side or corner, which
+                                                    // goes to the reject bin, or 0 if every pick error is corrected
+    double head_speed;                              // mm/s
+    double instruction_time;                        // s
+
+    /* tables calculated once when the profile is loaded */
+    double pick_x[MAX_NUMBER_OF_NOZZLES][MAX_NUMBER_OF_FEEDERS];            // head position which puts a nozzle over a feeder
+    double pick_y[MAX_NUMBER_OF_NOZZLES][MAX_NUMBER_OF_FEEDERS];
+    double pick_to_camera[MAX_NUMBER_OF_NOZZLES][MAX_NUMBER_OF_FEEDERS];    // move from that position to the look-up camera
+    double feeder_to_camera[MAX_NUMBER_OF_FEEDERS];
+    int gang_next[MAX_NUMBER_OF_NOZZLES][MAX_NUMBER_OF_FEEDERS];            // feeder under nozzle n + 1 when nozzle n is over a feeder,
+                                                                            // or NO_TAPE_FEEDER_AT_THIS_LOCATION
+
+} MachineProfile;
+
+extern MachineProfile machine;     // the profile used by the planner and the state machine
+
+void defaultMachineProfile(MachineProfile*);
+
+int loadMachineProfile(const char*, MachineProfile*);
+
+void printMachineProfile(const MachineProfile*);
+
+double shortestTurn(double, double);
+
+void resetNozzleAngles(double[]);
+
+#endif
@@ -0,0 +1,219 @@
+/*
+ *
+ * pnpPeephole.c - the peephole optimiser, which rewrites the instructions the controller has generated but
+ * not yet passed to the simulator
+ *
+ * Every pass over the pending instructions applies these rules until none of them changes anything:
+ *   - a turn of a nozzle is moved ahead of the moves of the head and the instructions of other nozzles before
+ *     it, so it is made sooner, and a later turn of the same nozzle with nothing in between that uses the
+ *     nozzle is added to it, as the machine turns a nozzle by the angle it is given
+ *   - a move or amendment of the head followed by an amendment is merged into one corrected move or
+ *     amendment, and one followed by a move is dropped, as the head goes on from where the move ends
+ *   - a move to where the head already is, an amendment by nothing and a turn by nothing are dropped
+ * A photo, including a move over the look-up camera, is never passed by a turn. The controller decides what
+ * to do after a photo from its results, so the instructions generated at once never depend on each other
+ * through the simulator, only through the head and nozzles the rules above take into account.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpPeephole.h"
+
+/*
+ * usesNozzle - TRUE if an instruction turns, lowers or raises a nozzle, or applies or releases its vacuum
+ */
+int usesNozzle(const PnPInstruction *instruction, int nozzle)
+{
+    switch (instruction -> instruction)
+    {
+        case ROTATE_NOZZLE:
+        case LOWER_NOZZLE:
+        case RAISE_NOZZLE:
+        case APPLY_VACUUM:
+        case RELEASE_VACUUM:
+            return instruction -> argument_3 == nozzle;
+
+        case LOWER_NOZZLES:
+        case RAISE_NOZZLES:
+        case APPLY_VACUUMS:
+            return (instruction -> argument_3 & NOZZLE_MASK(nozzle)) != 0;
+    }
+    return FALSE;
+}
+
+/*
+ * turnCanPass - TRUE if a turn of a nozzle may be made before an instruction, which neither uses the nozzle nor takes a photo
+ */
+int turnCanPass(const PnPInstruction *instruction, int nozzle)
+{
+    return instruction -> instruction != TAKE_PHOTO && instruction -> instruction != MOVE_HEAD_VIA_CAMERA && !usesNozzle(instruction, nozzle);
+}
+
+/*
+ * isHeadMotion - TRUE for a move or amendment of the head, which does nothing else
+ */
+int isHeadMotion(const PnPInstruction *instruction)
+{
+    return instruction -> instruction == MOVE_HEAD || instruction -> instruction == AMEND_HEAD_POSITION;
+}
+
+/*
+ * removeInstruction - removes an instruction from a list, and returns the number left
+ */
+int removeInstruction(PnPInstruction instruction[], int count, int i)
+{
+    memmove(&instruction[i], &instruction[i + 1], (count - i - 1) * sizeof(PnPInstruction));
+    return count - 1;
+}
+
+/*
+ Function: modelInstruction
+ --------------------------
+ Date: 18/10/2026
+ Version 1.2
+ Purpose:
+ updates the model of the head with an instruction passed to the simulator. An amendment of a head whose
+ position is not known leaves it unknown.
+ Argument(s):
+ HeadModel *model - the model
+ const PnPInstruction *instruction - the instruction
+ Return Value: none
+ Usage: modelInstruction(&head_model, &next);
+ */
+void modelInstruction(HeadModel *model, const PnPInstruction *instruction)
+{
+    switch (instruction -> instruction)
+    {
+        case MOVE_HEAD:
+        case MOVE_HEAD_VIA_CAMERA:
+            model -> x = instruction -> argument_1;
+            model -> y = instruction -> argument_2;
+            model -> position_known = TRUE;
+            break;
+
+        case AMEND_HEAD_POSITION:
+            model -> x += instruction -> argument_1;
+            model -> y += instruction -> argument_2;
+            break;
+    }
+}
+
+/*
+ Function: optimiseInstructions
+ ------------------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ applies the rules of the peephole optimiser to the pending instructions, in place, and counts what each
+ rule did. The instructions are left in the order the simulator is to execute them.
+ Argument(s):
+ PnPInstruction instruction[] - the pending instructions, the first is the next to pass to the simulator
+ int count - the number of pending instructions
+ const HeadModel *model - the head as the instructions already passed leave it
+ PeepholeStatistics *statistics - the counters of the rules
+ Return Value: the number of instructions left
+ Usage: pending_count = optimiseInstructions(pending_instruction, pending_count, &head_model, &peephole_statistics);
+ */
+int optimiseInstructions(PnPInstruction instruction[], int count, const HeadModel *model, PeepholeStatistics *statistics)
+{
+    int changed = TRUE, i, j, nozzle;
+    HeadModel after;
+
+    while (changed)
+    {
+        changed = FALSE;
+
+        /* turns go as early as the instructions before them allow, and a later turn of the same nozzle is added to an earlier one */
+        for (i = 1; i < count; i++)
+        {
+            if (instruction[i].instruction != ROTATE_NOZZLE) continue;
+            nozzle = instruction[i].argument_3;
+            for (j = i - 1; j >= 0 && turnCanPass(&instruction[j], nozzle); j--);
+            if (j >= 0 && instruction[j].instruction == ROTATE_NOZZLE && instruction[j].argument_3 == nozzle)
+            {
+                instruction[j].argument_1 += instruction[i].argument_1;
+                count = removeInstruction(instruction, count, i--);
+                statistics -> folded_rotations++;
+                changed = TRUE;
+                continue;
+            }
+            //the other turns keep their order, so turns never pass each other
+            for (j = i; j > 0 && instruction[j - 1].instruction != ROTATE_NOZZLE && turnCanPass(&instruction[j - 1], nozzle); j--)
+            {
+                PnPInstruction passed = instruction[j - 1];
+                instruction[j - 1] = instruction[j];
+                instruction[j] = passed;
+            }
+            if (j < i)
+            {
+                statistics -> reordered++;
+                changed = TRUE;
+            }
+        }
+
+        /* a move or amendment followed by an amendment is corrected by it, one followed by a move is made by the move */
+        for (i = 1; i < count; i++)
+        {
+            if (!isHeadMotion(&instruction[i - 1]) || !isHeadMotion(&instruction[i])) continue;
+            if (instruction[i].instruction == AMEND_HEAD_POSITION)
+            {
+                instruction[i - 1].argument_1 += instruction[i].argument_1;
+                instruction[i - 1].argument_2 += instruction[i].argument_2;
+                count = removeInstruction(instruction, count, i);
+            }
+            else count = removeInstruction(instruction, count, i - 1);
+            statistics -> merged_motions++;
+            changed = TRUE;
+            i--;
+        }
+
+        /* moves, amendments and turns which leave the head and nozzles where they are */
+        after = *model;
+        for (i = 0; i < count; i++)
+        {
+            PnPInstruction *next = &instruction[i];
+
+            if ((next -> instruction == MOVE_HEAD && after.position_known && fabs(next -> argument_1 - after.x) < PEEPHOLE_POSITION_TOLERANCE &&
+                 fabs(next -> argument_2 - after.y) < PEEPHOLE_POSITION_TOLERANCE) ||
+                (next -> instruction == AMEND_HEAD_POSITION && fabs(next -> argument_1) < PEEPHOLE_POSITION_TOLERANCE &&
+                 fabs(next -> argument_2) < PEEPHOLE_POSITION_TOLERANCE))
+            {
+                count = removeInstruction(instruction, count, i--);
+                statistics -> zero_motions++;
+                changed = TRUE;
+            }
+            else if (next -> instruction == ROTATE_NOZZLE && fabs(next -> argument_1) < PEEPHOLE_ANGLE_TOLERANCE)
+            {
+                count = removeInstruction(instruction, count, i--);
+                statistics -> zero_rotations++;
+                changed = TRUE;
+            }
+            else modelInstruction(&after, next);
+        }
+    }
+    return count;
+}
+
+/*
+ Function: printPeepholeStatistics
+ ---------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: prints the instructions the controller generated, those passed to the simulator, and what the peephole optimiser did to the rest
+ Argument(s):
+ const PeepholeStatistics *peephole - the counters of the optimiser
+ const InstructionStatistics *passed - the counters of the instructions passed to the simulator
+ Return Value: none
+ Usage: printPeepholeStatistics(getPeepholeStatistics(), getInstructionStatistics());
+ */
+void printPeepholeStatistics(const PeepholeStatistics *peephole, const InstructionStatistics *passed)
+{
+    unsigned long long issued = 0;
+
+    for (int i = 0; i < NUMBER_OF_INSTRUCTION_TYPES; i++) issued += passed -> issued[i];
+    printf("Instructions generated %llu, passed to the simulator %llu\n", peephole -> generated, issued);
+    printf("Peephole optimiser: %llu head motions merged, %llu zero length motions and %llu zero degree turns dropped, %llu turns folded, %llu turns made earlier\n\n",
+           peephole -> merged_motions, peephole -> zero_motions, peephole -> zero_rotations, peephole -> folded_rotations, peephole -> reordered);
+}
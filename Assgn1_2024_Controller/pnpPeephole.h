@@ -0,0 +1,42 @@
+/*
+ *
+ * pnpPeephole.h - declarations for the peephole optimiser, which rewrites the instructions the controller has
+ * generated but not yet passed to the simulator
+ *
+ * The instruction routines of pnpControlInterface.c do not pass an instruction to the simulator themselves,
+ * they append it to the pending instructions, which are the intermediate representation of the instruction
+ * stream. Whenever the simulator is ready the pending instructions are optimised and the first of them is
+ * passed. A state or coroutine which generates several instructions at once, such as the corrections of every
+ * nozzle, gives the optimiser a window of several instructions, and the model of the head carries where the
+ * instructions already passed left it, so a single move is optimised too. A turn is by an angle, so the
+ * angles the nozzles are at need no model.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPPEEPHOLE_H
+#define PNPPEEPHOLE_H
+
+#include "pnpShared.h"
+
+#define MAX_PENDING_INSTRUCTIONS 32             // instructions generated ahead of the simulator
+#define PEEPHOLE_POSITION_TOLERANCE 1e-6        // mm, a move or amendment of the head this short is not made
+#define PEEPHOLE_ANGLE_TOLERANCE 1e-6           // degrees, a turn of a nozzle by this little is not made
+
+/* the head as the instructions passed so far leave it, as far as the controller knows */
+typedef struct
+{
+    int position_known;                         // FALSE until the first move, the head may not start at home
+    double x, y;
+
+} HeadModel;
+
+void modelInstruction(HeadModel*, const PnPInstruction*);
+
+int optimiseInstructions(PnPInstruction[], int, const HeadModel*, PeepholeStatistics*);
+
+void printPeepholeStatistics(const PeepholeStatistics*, const InstructionStatistics*);
+
+#endif
@@ -0,0 +1,388 @@
+/*
+ *
+ * pnpPlacementStore.c - the structure of arrays placement store and the centroid file loader that fills it
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <ctype.h>
+#include "pnpPlacementStore.h"
+#include "pnpMachineProfile.h"
+
+/*
+ Function: hashString
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: FNV-1a hash of a null terminated string, used by the string table
+ Argument(s):
+ const char *s - the string to hash
+ Return Value: the hash
+ Usage: unsigned int h = hashString(name);
+ */
+unsigned int hashString(const char *s)
+{
+    unsigned int h = 2166136261u;
+
+    while (*s) h = (h ^ (unsigned char) *s++) * 16777619u;
+    return h;
+}
+
+/*
+ Function: internString
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ finds the id of a string in a string table, adding the string if it is not there yet. Equal
+ strings always get the same id, so ids can be compared instead of strings.
+ Argument(s):
+ StringTable *table - the string table
+ const char *s - the string
+ Return Value: the id of the string, or -1 if memory could not be allocated
+ Usage: int id = internString(&store -> names, "0603");
+ */
+int internString(StringTable *table, const char *s)
+{
+    int length = strlen(s) + 1;
+
+    /* keep the hash table at most half full */
+    if (2 * (table -> count + 1) > table -> bucket_count)
+    {
+        int bucket_count = table -> bucket_count ? 2 * table -> bucket_count : 64;
+        int *bucket = malloc(bucket_count * sizeof(int));
+        if (bucket == NULL) return -1;
+        for (int b = 0; b < bucket_count; b++) bucket[b] = -1;
+        for (int id = 0; id < table -> count; id++)
+        {
+            unsigned int b = hashString(table -> pool + table -> offset[id]) & (bucket_count - 1);
+            while (bucket[b] >= 0) b = (b + 1) & (bucket_count - 1);
+            bucket[b] = id;
+        }
+        free(table -> bucket);
+        table -> bucket = bucket;
+        table -> bucket_count = bucket_count;
+    }
+
+    unsigned int b = hashString(s) & (table -> bucket_count - 1);
+    while (table -> bucket[b] >= 0)
+    {
+        if (strcmp(table -> pool + table -> offset[table -> bucket[b]], s) == 0) return table -> bucket[b];
+        b = (b + 1) & (table -> bucket_count - 1);
+    }
+
+    if (table -> count == table -> capacity)
+    {
+        int capacity = table -> capacity ? 2 * table -> capacity : 64;
+        int *offset = realloc(table -> offset, capacity * sizeof(int));
+        if (offset == NULL) return -1;
+        table -> offset = offset;
+        table -> capacity = capacity;
+    }
+    if (table -> pool_length + length > table -> pool_capacity)
+    {
+        int pool_capacity = table -> pool_capacity ? 2 * table -> pool_capacity : 1024;
+        while (pool_capacity < table -> pool_length + length) pool_capacity *= 2;
+        char *pool = realloc(table -> pool, pool_capacity);
+        if (pool == NULL) return -1;
+        table -> pool = pool;
+        table -> pool_capacity = pool_capacity;
+    }
+
+    memcpy(table -> pool + table -> pool_length, s, length);
+    table -> offset[table -> count] = table -> pool_length;
+    table -> pool_length += length;
+    table -> bucket[b] = table -> count;
+    return table -> count++;
+}
+
+/*
+ Function: placementStoreInit
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: initializes an empty placement store, which must later be freed with placementStoreFree()
+ Argument(s):
+ PlacementStore *store - the store to initialize
+ Return Value: none
+ Usage: PlacementStore store; placementStoreInit(&store);
+ */
+void placementStoreInit(PlacementStore *store)
+{
+    memset(store, 0, sizeof(PlacementStore));
+}
+
+/*
+ Function: placementStoreFree
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: frees the memory of a placement store and leaves it empty
+ Argument(s):
+ PlacementStore *store - the store to free
+ Return Value: none
+ Usage: placementStoreFree(&store);
+ */
+void placementStoreFree(PlacementStore *store)
+{
+    free(store -> x);
+    free(store -> y);
+    free(store -> theta);
+    free(store -> feeder);
+    free(store -> value);
+    free(store -> designation);
+    free(store -> footprint);
+    free(store -> names.pool);
+    free(store -> names.offset);
+    free(store -> names.bucket);
+    placementStoreInit(store);
+}
+
+/*
+ Function: placementStoreClear
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: removes all parts from a placement store, keeping its memory for the next job
+ Argument(s):
+ PlacementStore *store - the store to clear
+ Return Value: none
+ Usage: placementStoreClear(&store);
+ */
+void placementStoreClear(PlacementStore *store)
+{
+    store -> count = 0;
+    store -> names.count = 0;
+    store -> names.pool_length = 0;
+    for (int b = 0; b < store -> names.bucket_count; b++) store -> names.bucket[b] = -1;
+}
+
+/*
+ Function: reserve
+ -----------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: grows the arrays of a placement store so that it can hold at least capacity parts
+ Argument(s):
+ PlacementStore *store - the store
+ int capacity - the number of parts required
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: if (reserve(store, n) != 0) ...
+ */
+int reserve(PlacementStore *store, int capacity)
+{
+    if (capacity <= store -> capacity) return 0;
+
+    #define GROW(array) \
+        do { void *p = realloc(store -> array, capacity * sizeof(*store -> array)); if (p == NULL) return -1; store -> array = p; } while (0)
+    GROW(x);
+    GROW(y);
+    GROW(theta);
+    GROW(feeder);
+    GROW(value);
+    GROW(designation);
+    GROW(footprint);
+    #undef GROW
+
+    store -> capacity = capacity;
+    return 0;
+}
+
+/*
+ Function: placementStoreAdd
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: appends the placement info of one part to a placement store
+ Argument(s):
+ PlacementStore *store - the store
+ const char *designation, const char *footprint, double value, double x, double y, double theta, int feeder -
+ the fields of one centroid file line
+ Return Value: the index of the part, or -1 if memory could not be allocated
+ Usage: placementStoreAdd(&store, "R1", "0603", 100, 150.0, 200.0, 90.0, 3);
+ */
+int placementStoreAdd(PlacementStore *store, const char *designation, const char *footprint, double value, double x, double y, double theta, int feeder)
+{
+    int i = store -> count;
+
+    if (i == store -> capacity && reserve(store, store -> capacity ? 2 * store -> capacity : 128) != 0) return -1;
+
+    store -> designation[i] = internString(&store -> names, designation);
+    store -> footprint[i] = internString(&store -> names, footprint);
+    if (store -> designation[i] < 0 || store -> footprint[i] < 0) return -1;
+    store -> x[i] = x;
+    store -> y[i] = y;
+    store -> theta[i] = theta;
+    store -> feeder[i] = feeder;
+    store -> value[i] = value;
+    return store -> count++;
+}
+
+/*
+ Function: placementDesignation
+ ------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gets the component designation of a part
+ Argument(s):
+ const PlacementStore *store - the store
+ int i - the index of the part
+ Return Value: the designation, owned by the store
+ Usage: printf("%s", placementDesignation(&store, i));
+ */
+const char *placementDesignation(const PlacementStore *store, int i)
+{
+    return store -> names.pool + store -> names.offset[store -> designation[i]];
+}
+
+/*
+ Function: placementFootprint
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gets the component footprint of a part
+ Argument(s):
+ const PlacementStore *store - the store
+ int i - the index of the part
+ Return Value: the footprint, owned by the store
+ Usage: printf("%s", placementFootprint(&store, i));
+ */
+const char *placementFootprint(const PlacementStore *store, int i)
+{
+    return store -> names.pool + store -> names.offset[store -> footprint[i]];
+}
+
+/*
+ Function: nextToken
+ -------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: finds the next whitespace separated token of a centroid file held in memory
+ Argument(s):
+ char **p - the read position, advanced past the token, which is null terminated in place
+ Return Value: the token, or NULL at the end of the file
+ Usage: char *token = nextToken(&p);
+ */
+char *nextToken(char **p)
+{
+    char *s = *p, *token;
+
+    while (*s && isspace((unsigned char) *s)) s++;
+    if (*s == '\0') return NULL;
+    token = s;
+    while (*s && !isspace((unsigned char) *s)) s++;
+    if (*s) *s++ = '\0';
+    *p = s;
+    return token;
+}
+
+/*
+ Function: loadPlacementStore
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ reads a centroid file into a placement store. The file format and return values are those of
+ getCentroidFileContents(), but there is no MAX_NUMBER_OF_COMPONENTS_TO_PLACE limit. The whole
+ file is read at once and parsed in memory, which is much faster than fscanf() for large boards.
+ A part from a feeder which is not in the machine profile is a content issue.
+ Argument(s):
+ const char *file_name - the centroid file to read
+ int *operation_mode - set to MANUAL_CONTROL or AUTONOMOUS_CONTROL
+ PlacementStore *store - cleared, then filled with the parts in file order
+ Return Value:
+ one of:
+ CENTROID_FILE_PRESENT_AND_READ (0)
+ CENTROID_FILE_NOT_PRESENT (-1)
+ CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE (-2)
+ CENTROID_FILE_HAS_TOO_MANY_COMPONENTS (-3)
+ Usage:
+ int res = loadPlacementStore(CENTROID_FILE, &operation_mode, &store);
+ */
+int loadPlacementStore(const char *file_name, int *operation_mode, PlacementStore *store)
+{
+    FILE *fp = fopen(file_name, "rb");
+    long size;
+    char *text, *p, *token, *end;
+    int res = CENTROID_FILE_PRESENT_AND_READ;
+
+    placementStoreClear(store);
+    if (fp == NULL) return CENTROID_FILE_NOT_PRESENT;
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0 || (text = malloc(size + 1)) == NULL)
+    {
+        fclose(fp);
+        return CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;
+    }
+    size = fread(text, 1, size, fp);
+    text[size] = '\0';
+    fclose(fp);
+
+    /* the operation mode is the first character of the file */
+    if (text[0] == 'm' || text[0] == 'M') *operation_mode = MANUAL_CONTROL;
+    else if (text[0] == 'a' || text[0] == 'A') *operation_mode = AUTONOMOUS_CONTROL;
+    else {free(text); return CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;}
+    p = text + 1;
+
+    long number_of_components_to_place = -1;
+    if ((token = nextToken(&p)) != NULL) number_of_components_to_place = strtol(token, &end, 0);
+    if (token == NULL || *end != '\0' || number_of_components_to_place < 0) res = CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;
+    else if (number_of_components_to_place > PLACEMENT_STORE_MAX_COMPONENTS) res = CENTROID_FILE_HAS_TOO_MANY_COMPONENTS;
+    else if (reserve(store, number_of_components_to_place) != 0) res = CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;
+
+    for (long i = 0; res == CENTROID_FILE_PRESENT_AND_READ && i < number_of_components_to_place; i++)
+    {
+        char *field[NUMBER_OF_FIELDS_IN_PLACEMENT_INFO];
+        double number[4];
+        long feeder;
+        int f;
+
+        for (f = 0; f < NUMBER_OF_FIELDS_IN_PLACEMENT_INFO && (field[f] = nextToken(&p)) != NULL; f++);
+        if (f != NUMBER_OF_FIELDS_IN_PLACEMENT_INFO) {res = CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE; break;}
+        if (strlen(field[0]) > PLACEMENT_STORE_MAX_NAME_LENGTH || strlen(field[1]) > PLACEMENT_STORE_MAX_NAME_LENGTH) {res = CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE; break;}
+
+        /* value, x, y and theta */
+        for (f = 0; f < 4; f++)
+        {
+            number[f] = strtod(field[2 + f], &end);
+            if (*end != '\0') break;
+        }
+        feeder = strtol(field[6], &end, 0);
+        if (f != 4 || *end != '\0' || feeder < 0 || feeder >= machine.number_of_feeders) {res = CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE; break;}
+
+        if (placementStoreAdd(store, field[0], field[1], number[0], number[1], number[2], number[3], (int) feeder) < 0) res = CENTROID_FILE_PRESENT_BUT_CONTENT_ISSUE;
+    }
+
+    free(text);
+    if (res != CENTROID_FILE_PRESENT_AND_READ) placementStoreClear(store);
+    return res;
+}
+
+/*
+ Function: savePlacementStore
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes the parts of a placement store to a centroid file which loadPlacementStore() reads back
+ Argument(s):
+ const char *file_name - the centroid file to write
+ int operation_mode - MANUAL_CONTROL or AUTONOMOUS_CONTROL
+ const PlacementStore *store - the parts, in the order they are written
+ Return Value: 0 if the file was written, -1 if not
+ Usage: if (savePlacementStore("centroid_taught.txt", AUTONOMOUS_CONTROL, &store) != 0) ...
+ */
+int savePlacementStore(const char *file_name, int operation_mode, const PlacementStore *store)
+{
+    FILE *fp = fopen(file_name, "w");
+
+    if (fp == NULL) return -1;
+    fprintf(fp, "%c\n%d\n", operation_mode == MANUAL_CONTROL ? 'M' : 'A', store -> count);
+    for (int i = 0; i < store -> count; i++)
+    {
+        fprintf(fp, "%s\t%s\t%.10g\t%.10g\t%.10g\t%.10g\t%d\n", placementDesignation(store, i), placementFootprint(store, i),
+                store -> value[i], store -> x[i], store -> y[i], store -> theta[i], store -> feeder[i]);
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
@@ -0,0 +1,69 @@
+/*
+ *
+ * pnpPlacementStore.h - declarations for the structure of arrays placement store, which holds the
+ * placement info of every component of a job
+ *
+ * The planner and the state machine only need the target position, rotation and feeder of each part,
+ * so these are kept in separate contiguous arrays. Designations and footprints are interned, each
+ * part only stores the id of its strings.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPPLACEMENTSTORE_H
+#define PNPPLACEMENTSTORE_H
+
+#include "pnpControl.h"
+
+#define PLACEMENT_STORE_MAX_COMPONENTS 10000000    // larger centroid files return CENTROID_FILE_HAS_TOO_MANY_COMPONENTS
+#define PLACEMENT_STORE_MAX_NAME_LENGTH 63         // longest designation or footprint, longer names are a content issue
+
+typedef struct
+{
+    char *pool;             // the interned strings, each null terminated
+    int pool_length;
+    int pool_capacity;
+    int *offset;            // offset[id] is the start of string id in pool
+    int count;
+    int capacity;
+    int *bucket;            // open addressing hash table of string ids, -1 marks an empty bucket
+    int bucket_count;       // always a power of 2
+
+} StringTable;
+
+typedef struct
+{
+    int count;
+    int capacity;
+    double *x;              // x_target of each part
+    double *y;              // y_target of each part
+    double *theta;          // theta_target of each part
+    int *feeder;
+    double *value;
+    int *designation;       // string id of the component designation
+    int *footprint;         // string id of the component footprint
+    StringTable names;
+
+} PlacementStore;
+
+void placementStoreInit(PlacementStore*);
+
+void placementStoreFree(PlacementStore*);
+
+void placementStoreClear(PlacementStore*);
+
+int placementStoreAdd(PlacementStore*, const char*, const char*, double, double, double, double, int);
+
+int loadPlacementStore(const char*, int*, PlacementStore*);
+
+int savePlacementStore(const char*, int, const PlacementStore*);
+
+int internString(StringTable*, const char*);
+
+const char *placementDesignation(const PlacementStore*, int);
+
+const char *placementFootprint(const PlacementStore*, int);
+
+#endif
@@ -0,0 +1,684 @@
+/*
+ *
+ * pnpPlanner.c - the placement planner, which decides the order in which the parts of a job are picked
+ * and estimates the gantry travel of the resulting route
+ *
+ * The planner only reads the x, y and feeder arrays of the placement store, so a board with
+ * hundreds of thousands of parts is planned from a few contiguous arrays. The geometry of the machine
+ * comes from the machine profile, whose pick position tables are calculated when it is loaded.
+ *
+ * On a machine with gang pick, consecutive parts whose feeders are under consecutive nozzles at one head
+ * position are picked together, see gangPickSize(). Their pick waypoints are then the same position, so
+ * routeLength() needs no change, but the trip takes fewer instructions, which planCycleTime() counts.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpPlanner.h"
+#include "pnpKernels.h"
+#include "pnpSpatialIndex.h"
+
+int nearest_scan_limit = NEAREST_SCAN_LIMIT;
+
+typedef struct
+{
+    int feeder;
+    int index;
+    double y;
+
+} OrderKey;
+
+/*
+ Function: compareOrderKeys
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: qsort() comparison of two parts, by feeder, then y, then position in the centroid file
+ Argument(s):
+ const void *a, const void *b - the OrderKeys to compare
+ Return Value: negative, zero or positive as a sorts before, with or after b
+ Usage: qsort(keys, n, sizeof(OrderKey), compareOrderKeys);
+ */
+int compareOrderKeys(const void *a, const void *b)
+{
+    const OrderKey *ka = a, *kb = b;
+
+    if (ka -> feeder != kb -> feeder) return ka -> feeder < kb -> feeder ? -1 : 1;
+    if (ka -> y != kb -> y) return ka -> y < kb -> y ? -1 : 1;
+    return ka -> index - kb -> index;
+}
+
+/*
+ Function: orderPlacements
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ orders the parts of a job by feeder in ascending order, and by ascending y-coordinate for parts in the
+ same feeder, so that consecutive picks are from the same or the next feeder. Parts with the same feeder
+ and y-coordinate keep their centroid file order.
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ int order[] - set to the store index of each part in pick order, store -> count entries
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: orderPlacements(&store, component_list);
+ */
+int orderPlacements(const PlacementStore *store, int order[])
+{
+    int n = store -> count;
+    OrderKey *keys = malloc((n ? n : 1) * sizeof(OrderKey));
+
+    if (keys == NULL) return -1;
+    for (int i = 0; i < n; i++)
+    {
+        keys[i].feeder = store -> feeder[i];
+        keys[i].index = i;
+        keys[i].y = store -> y[i];
+    }
+    qsort(keys, n, sizeof(OrderKey), compareOrderKeys);
+    for (int i = 0; i < n; i++) order[i] = keys[i].index;
+
+    free(keys);
+    return 0;
+}
+
+/*
+ Function: routeLength
+ ---------------------
+ Date: 18/10/2026
+ Version 4.0
+ Purpose:
+ estimates the gantry travel in mm of a job picked in the given order. Each trip picks up to
+ machine.number_of_nozzles parts with the nozzles in turn from the left, visits the look-up camera,
+ then places the parts in the order chosen by sequenceTrip(), as the autonomous state machine does.
+ The route starts and ends at the home position. The waypoints are collected in blocks and measured
+ with the pathLength() kernel.
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ const int order[] - the store index of each part in pick order
+ int n - the number of parts in order[]
+ Return Value: the travel in mm
+ Usage: printf("%.0f mm", routeLength(&store, component_list, store.count));
+ */
+double routeLength(const PlacementStore *store, const int order[], int n)
+{
+    int nozzles = HEAD_NOZZLES, sequence[MAX_NUMBER_OF_NOZZLES];
+    double x[ROUTE_BLOCK_SIZE], y[ROUTE_BLOCK_SIZE], place_x[MAX_NUMBER_OF_NOZZLES], place_y[MAX_NUMBER_OF_NOZZLES], length = 0;
+    int waypoints = 1;
+
+    x[0] = machine.home_x;
+    y[0] = machine.home_y;
+    for (int first = 0; first < n; first += nozzles)
+    {
+        int last = first + nozzles < n ? first + nozzles : n;
+
+        /* a trip adds at most 2 * nozzles + 1 waypoints, measure the block before it can overflow */
+        if (waypoints + 2 * nozzles + 2 > ROUTE_BLOCK_SIZE)
+        {
+            length += pathLength(x, y, waypoints);
+            x[0] = x[waypoints - 1];
+            y[0] = y[waypoints - 1];
+            waypoints = 1;
+        }
+        for (int i = first; i < last; i++)
+        {
+            int f = store -> feeder[order[i]];
+            x[waypoints] = machine.pick_x[i - first][f];
+            y[waypoints++] = machine.pick_y[i - first][f];
+        }
+        x[waypoints] = machine.camera_x;
+        y[waypoints++] = machine.camera_y;
+        for (int i = first; i < last; i++)
+        {
+            place_x[i - first] = store -> x[order[i]] - machine.nozzle_x[i - first];
+            place_y[i - first] = store -> y[order[i]];
+        }
+        /* the trip ends at the first pick of the next trip */
+        double next_x = last < n ? machine.pick_x[0][store -> feeder[order[last]]] : machine.home_x;
+        double next_y = last < n ? machine.pick_y[0][store -> feeder[order[last]]] : machine.home_y;
+        sequenceTrip(place_x, place_y, last - first, machine.camera_x, machine.camera_y, next_x, next_y, sequence);
+        for (int s = 0; s < last - first; s++)
+        {
+            x[waypoints] = place_x[sequence[s]];
+            y[waypoints++] = place_y[sequence[s]];
+        }
+    }
+    x[waypoints] = machine.home_x;
+    y[waypoints++] = machine.home_y;
+    return length + pathLength(x, y, waypoints);
+}
+
+/*
+ Function: orderPlacementsNearest
+ --------------------------------
+ Date: 18/10/2026
+ Version 2.0
+ Purpose:
+ orders the parts of a job by feeder in ascending order, and for parts in the same feeder by a greedy
+ nearest neighbour route over the PCB. The first part of each trip is the one nearest to the look-up
+ camera, each following part of the trip is the one nearest to the part placed before it. Feeders with
+ more than nearest_scan_limit parts are searched with a spatial index, and their parts are ranked by
+ distance from the camera once, smaller ones are searched with the nearestPoint() kernel.
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ int order[] - set to the store index of each part in pick order, store -> count entries
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: orderPlacementsNearest(&store, component_list);
+ */
+int orderPlacementsNearest(const PlacementStore *store, int order[])
+{
+    int n = store -> count, res = 0;
+    SpatialIndex grid;
+
+    if (orderPlacements(store, order) != 0) return -1;
+
+    /* the parts of a feeder, compacted by moving the last part into the gap of each placed one when scanning */
+    double *x = malloc((n ? n : 1) * sizeof(double)), *y = malloc((n ? n : 1) * sizeof(double));
+    int *index = malloc((n ? n : 1) * sizeof(int));
+    OrderKey *by_camera = malloc((n ? n : 1) * sizeof(OrderKey));
+    double *camera_distance = malloc((n ? n : 1) * sizeof(double));
+    char *placed = malloc(n ? n : 1);
+    if (x == NULL || y == NULL || index == NULL || by_camera == NULL || camera_distance == NULL || placed == NULL)
+    {
+        free(camera_distance);
+        free(x);
+        free(y);
+        free(index);
+        free(by_camera);
+        free(placed);
+        return -1;
+    }
+    spatialIndexInit(&grid);
+
+    double px = machine.camera_x, py = machine.camera_y;
+    for (int first = 0, last; first < n && res == 0; first = last)
+    {
+        int remaining = 0, use_grid, next_by_camera = 0;
+
+        for (last = first; last < n && store -> feeder[order[last]] == store -> feeder[order[first]]; last++)
+        {
+            index[remaining] = order[last];
+            x[remaining] = store -> x[order[last]];
+            y[remaining++] = store -> y[order[last]];
+        }
+
+        use_grid = remaining > nearest_scan_limit;
+        if (use_grid)
+        {   //ids in the grid are positions in x[], y[] and index[], which are not compacted
+            if (spatialIndexBuild(&grid, x, y, NULL, remaining) != 0) {res = -1; break;}
+            memset(placed, FALSE, remaining);
+
+            /* the first part of a trip is the first unplaced part in order of distance from the camera, the ranking keys hold the distance in y */
+            pointDistances(machine.camera_x, machine.camera_y, x, y, remaining, camera_distance);
+            for (int j = 0; j < remaining; j++)
+            {
+                by_camera[j].feeder = 0;
+                by_camera[j].index = j;
+                by_camera[j].y = camera_distance[j];
+            }
+            qsort(by_camera, remaining, sizeof(OrderKey), compareOrderKeys);
+        }
+
+        for (int i = first; i < last; i++)
+        {
+            int next;
+
+            if (i % HEAD_NOZZLES == 0)
+            {
+                px = machine.camera_x;
+                py = machine.camera_y;
+            }
+            if (use_grid)
+            {
+                if (i % HEAD_NOZZLES == 0)
+                {
+                    while (placed[by_camera[next_by_camera].index]) next_by_camera++;
+                    next = by_camera[next_by_camera].index;
+                }
+                else spatialIndexNearest(&grid, px, py, 1, &next, NULL);
+                spatialIndexRemove(&grid, next);
+                placed[next] = TRUE;
+                order[i] = index[next];
+                px = x[next];
+                py = y[next];
+            }
+            else
+            {
+                next = nearestPoint(px, py, x, y, remaining, NULL);
+                order[i] = index[next];
+                px = x[next];
+                py = y[next];
+                remaining--;
+                index[next] = index[remaining];
+                x[next] = x[remaining];
+                y[next] = y[remaining];
+            }
+        }
+    }
+
+    spatialIndexFree(&grid);
+    free(x);
+    free(y);
+    free(index);
+    free(by_camera);
+    free(camera_distance);
+    free(placed);
+    return res;
+}
+
+/*
+ Function: planPlacements
+ ------------------------
+ Date: 18/10/2026
+ Version 2.0
+ Purpose:
+ chooses the pick order of a job, the quicker by planCycleTime() of the orderPlacements() and the
+ orderPlacementsNearest() orders, and of the orderPlacementsGang() order on a machine with gang pick.
+ Without gang pick every order takes the same instructions, so this is the order with the shorter routeLength().
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ int order[] - set to the store index of each part in pick order, store -> count entries
+ Return Value: PLAN_BY_FEEDER_AND_Y, PLAN_BY_NEAREST_NEIGHBOUR or PLAN_FOR_GANG_PICK, or -1 if memory could not be allocated,
+ order[] is then unchanged
+ Usage: int plan = planPlacements(&store, component_list);
+ */
+int planPlacements(const PlacementStore *store, int order[])
+{
+    int n = store -> count;
+    int *nearest = malloc((n ? n : 1) * sizeof(int)), *gang = NULL;
+
+    /* order[] is only written once all orders are known, so it is unchanged on failure */
+    if (nearest == NULL || orderPlacementsNearest(store, nearest) != 0 ||
+        (machine.gang_pick && ((gang = malloc((n ? n : 1) * sizeof(int))) == NULL || orderPlacementsGang(store, gang) != 0)) ||
+        orderPlacements(store, order) != 0)
+    {
+        free(nearest);
+        free(gang);
+        return -1;
+    }
+
+    int plan = PLAN_BY_FEEDER_AND_Y;
+    double cycle_time = planCycleTime(store, order, n), nearest_time = planCycleTime(store, nearest, n);
+    if (nearest_time < cycle_time)
+    {
+        memcpy(order, nearest, n * sizeof(int));
+        plan = PLAN_BY_NEAREST_NEIGHBOUR;
+        cycle_time = nearest_time;
+    }
+    if (gang != NULL && planCycleTime(store, gang, n) < cycle_time)
+    {
+        memcpy(order, gang, n * sizeof(int));
+        plan = PLAN_FOR_GANG_PICK;
+    }
+    free(nearest);
+    free(gang);
+    return plan;
+}
+
+/*
+ Function: gangPickSize
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ finds how many parts are picked together by a gang pick, from part i of the pick order on the given nozzle.
+ Part i + 1 joins the gang if its feeder is under the next nozzle with the head at the pick position of part i,
+ and so on while there are nozzles left. Always 1 on a machine without gang pick.
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ const int order[] - the store index of each part in pick order
+ int i - the first part of the gang in order[]
+ int n - the number of parts in order[]
+ int nozzle - the nozzle which picks part i
+ Return Value: the number of parts in the gang, at least 1
+ Usage: gang = gangPickSize(&placements, component_list, part_counter, number_of_components_to_place, nozzle);
+ */
+int gangPickSize(const PlacementStore *store, const int order[], int i, int n, int nozzle)
+{
+    int size = 1;
+
+    if (!machine.gang_pick) return 1;
+    while (nozzle + size < HEAD_NOZZLES && i + size < n &&
+           store -> feeder[order[i + size]] == machine.gang_next[nozzle + size - 1][store -> feeder[order[i + size - 1]]])
+        size++;
+    return size;
+}
+
+/*
+ Function: orderPlacementsGang
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ orders the parts of a job for gang pick. Each trip starts at the feeder with parts left which gives the
+ largest gang, lowest feeder first, then each further nozzle takes a part from the feeder under it if that
+ feeder has parts left, otherwise from the lowest feeder with parts left. The parts of a feeder are taken
+ in the orderPlacements() order.
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ int order[] - set to the store index of each part in pick order, store -> count entries
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: orderPlacementsGang(&store, gang);
+ */
+int orderPlacementsGang(const PlacementStore *store, int order[])
+{
+    int n = store -> count, nozzles = HEAD_NOZZLES, feeders = machine.number_of_feeders;
+    int start[MAX_NUMBER_OF_FEEDERS + 1] = {0}, next[MAX_NUMBER_OF_FEEDERS];
+    int *sorted = malloc((n ? n : 1) * sizeof(int));
+
+    if (sorted == NULL || orderPlacements(store, sorted) != 0)
+    {
+        free(sorted);
+        return -1;
+    }
+    /* the parts of feeder f are sorted[start[f]] up to sorted[start[f + 1] - 1], next[f] is the next one to take */
+    for (int i = 0; i < n; i++) start[store -> feeder[i] + 1]++;
+    for (int f = 0; f < feeders; f++)
+    {
+        start[f + 1] += start[f];
+        next[f] = start[f];
+    }
+
+    int lowest = 0, previous = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+    for (int i = 0; i < n; i++)
+    {
+        int nozzle = i % nozzles, f = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+
+        while (next[lowest] == start[lowest + 1]) lowest++;
+        if (nozzle == 0)
+        {   //the feeder which starts the longest chain of feeders with parts left under the following nozzles
+            int best = 0;
+            for (int g = lowest; g < feeders && best < nozzles; g++)
+            {
+                int size = 0;
+                for (int h = g; h != NO_TAPE_FEEDER_AT_THIS_LOCATION && next[h] < start[h + 1]; h = machine.gang_next[size - 1][h]) size++;
+                if (size > best)
+                {
+                    best = size;
+                    f = g;
+                }
+            }
+        }
+        else
+        {
+            int g = machine.gang_next[nozzle - 1][previous];
+            if (g != NO_TAPE_FEEDER_AT_THIS_LOCATION && next[g] < start[g + 1]) f = g;
+        }
+        if (f == NO_TAPE_FEEDER_AT_THIS_LOCATION) f = lowest;
+        order[i] = sorted[next[f]++];
+        previous = f;
+    }
+
+    free(sorted);
+    return 0;
+}
+
+/*
+ Function: planInstructions
+ --------------------------
+ Date: 18/10/2026
+ Version 1.2
+ Purpose:
+ counts the instructions the autonomous state machine issues for a job picked in the given order. Each pick,
+ or gang pick, is a move, lower, vacuum and raise, each trip has a move to the look-up camera and a photo,
+ each part a rotation and a move, photo, amend, lower, release and raise to place it, and the job ends with
+ a move home. On a machine with a fly-by camera the move to the first placement of a trip passes over the
+ camera and takes the photo, so a trip has no instructions of its own. On a machine which turns its nozzles
+ while it moves on, each part also has a rotation towards its angle before the trip, which is counted though
+ it is left out when the nozzle is already at that angle
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ const int order[] - the store index of each part in pick order
+ int n - the number of parts in order[]
+ Return Value: the number of instructions
+ Usage: printf("%ld instructions", planInstructions(&store, component_list, store.count));
+ */
+long planInstructions(const PlacementStore *store, const int order[], int n)
+{
+    int nozzles = HEAD_NOZZLES;
+    long instructions = 1;
+
+    for (int first = 0; first < n; first += nozzles)
+    {
+        int last = first + nozzles < n ? first + nozzles : n;
+
+        instructions += (machine.flyby_camera ? 0 : 2) + (machine.rotate_while_moving ? 8 : 7) * (last - first);
+        for (int i = first; i < last; i += gangPickSize(store, order, i, n, i - first)) instructions += 4;
+    }
+    return instructions;
+}
+
+/*
+ Function: planCycleTime
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ estimates the time in seconds taken by a job picked in the given order, the routeLength() travel at the
+ head speed of the machine plus the instruction time of each of the planInstructions()
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ const int order[] - the store index of each part in pick order
+ int n - the number of parts in order[]
+ Return Value: the time in seconds
+ Usage: printf("%.1f s", planCycleTime(&store, component_list, store.count));
+ */
+double planCycleTime(const PlacementStore *store, const int order[], int n)
+{
+    return routeLength(store, order, n) / machine.head_speed + planInstructions(store, order, n) * machine.instruction_time;
+}
+
+/*
+ Function: tripTravel
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: measures the travel of the placements of a trip, from the look-up camera to the position after the trip
+ Argument(s):
+ const double x[], const double y[] - the head position of each placement
+ const int sequence[] - the placement order as indexes into x[] and y[], or NULL for the order of x[] and y[]
+ int count - the number of placements
+ double from_x, double from_y - the head position before the first placement
+ double to_x, double to_y - the head position after the trip
+ Return Value: the travel in mm
+ Usage: double travel = tripTravel(x, y, NULL, count, machine.camera_x, machine.camera_y, next_x, next_y);
+ */
+double tripTravel(const double x[], const double y[], const int sequence[], int count, double from_x, double from_y, double to_x, double to_y)
+{
+    double travel = 0;
+
+    for (int s = 0; s < count; s++)
+    {
+        int k = sequence ? sequence[s] : s;
+        travel += hypot(x[k] - from_x, y[k] - from_y);
+        from_x = x[k];
+        from_y = y[k];
+    }
+    return travel + hypot(to_x - from_x, to_y - from_y);
+}
+
+/*
+ Function: searchSequences
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ the exhaustive search of sequenceTrip(), tries every placement order that starts with sequence[0 .. depth - 1]
+ and abandons an order as soon as its travel reaches that of the best order found so far
+ Argument(s):
+ const double x[], const double y[], int count, double to_x, double to_y - as sequenceTrip()
+ int sequence[] - the order being built, the placements from depth on are those not yet visited
+ int depth - the number of placements already in the order
+ double travel - the travel to the last placement in the order
+ int best[] - set to the best complete order
+ double *best_travel - the travel of best[], including the move to to_x, to_y
+ Return Value: none
+ Usage: searchSequences(x, y, count, to_x, to_y, sequence, 1, travel, best, &best_travel);
+ */
+void searchSequences(const double x[], const double y[], int count, double to_x, double to_y, int sequence[], int depth,
+                     double travel, int best[], double *best_travel)
+{
+    int last = sequence[depth - 1];
+
+    if (depth == count)
+    {
+        travel += hypot(to_x - x[last], to_y - y[last]);
+        if (travel < *best_travel)
+        {
+            *best_travel = travel;
+            memcpy(best, sequence, count * sizeof(int));
+        }
+        return;
+    }
+    for (int t = depth; t < count; t++)
+    {
+        int k = sequence[t];
+        double step = hypot(x[k] - x[last], y[k] - y[last]);
+
+        if (travel + step >= *best_travel) continue;
+        sequence[t] = sequence[depth];
+        sequence[depth] = k;
+        searchSequences(x, y, count, to_x, to_y, sequence, depth + 1, travel + step, best, best_travel);
+        sequence[depth] = sequence[t];
+        sequence[t] = k;
+    }
+}
+
+/*
+ Function: sequenceTrip
+ ----------------------
+ Date: 18/10/2026
+ Version 2.0
+ Purpose:
+ chooses the order in which the loaded nozzles of a trip place their parts, minimising the travel from the
+ look-up camera through every placement to the position after the trip, which is the first pick of the next
+ trip, or home after the last trip. Ending near the next pick is what favours it. Each placement is given as
+ the head position which puts its nozzle over the part, so the x offsets of the nozzles are accounted for.
+ Trips of up to SEQUENCE_EXACT_LIMIT placements try every order, pruned by the best found so far, larger ones
+ improve the nearest neighbour order with 2-opt.
+ Argument(s):
+ const double x[], const double y[] - the head position of each placement
+ int count - the number of placements, at most MAX_NUMBER_OF_NOZZLES
+ double from_x, double from_y - the head position before the first placement, the look-up camera
+ double to_x, double to_y - the head position after the trip
+ int sequence[] - set to the placement order as indexes into x[] and y[]
+ Return Value: the travel of the chosen order in mm
+ Usage: double travel = sequenceTrip(x, y, count, machine.camera_x, machine.camera_y, next_x, next_y, sequence);
+ */
+double sequenceTrip(const double x[], const double y[], int count, double from_x, double from_y, double to_x, double to_y, int sequence[])
+{
+    double px = from_x, py = from_y, best_travel;
+
+    /* the nearest neighbour order is the starting point of both searches */
+    for (int s = 0; s < count; s++) sequence[s] = s;
+    for (int s = 0; s < count; s++)
+    {
+        int best = s;
+        double best_d2 = INFINITY;
+
+        for (int t = s; t < count; t++)
+        {
+            double dx = x[sequence[t]] - px, dy = y[sequence[t]] - py;
+            if (dx * dx + dy * dy < best_d2)
+            {
+                best_d2 = dx * dx + dy * dy;
+                best = t;
+            }
+        }
+        int k = sequence[best];
+        sequence[best] = sequence[s];
+        sequence[s] = k;
+        px = x[k];
+        py = y[k];
+    }
+    best_travel = tripTravel(x, y, sequence, count, from_x, from_y, to_x, to_y);
+    if (count < 2) return best_travel;
+
+    if (count <= SEQUENCE_EXACT_LIMIT)
+    {   //the search starts from element 0, the camera, so the placements are elements 1 to count
+        double hx[SEQUENCE_EXACT_LIMIT + 1], hy[SEQUENCE_EXACT_LIMIT + 1];
+        int order[SEQUENCE_EXACT_LIMIT + 1], best[SEQUENCE_EXACT_LIMIT + 1];
+
+        hx[0] = from_x;
+        hy[0] = from_y;
+        order[0] = best[0] = 0;
+        for (int s = 0; s < count; s++)
+        {
+            hx[s + 1] = x[s];
+            hy[s + 1] = y[s];
+            order[s + 1] = s + 1;
+            best[s + 1] = sequence[s] + 1;
+        }
+        searchSequences(hx, hy, count + 1, to_x, to_y, order, 1, 0, best, &best_travel);
+        for (int s = 0; s < count; s++) sequence[s] = best[s + 1] - 1;
+        return best_travel;
+    }
+
+    /* 2-opt, reversing sequence[i .. j] while that shortens the trip */
+    for (int improved = TRUE; improved; )
+    {
+        improved = FALSE;
+        for (int i = 0; i < count - 1; i++)
+        {
+            for (int j = i + 1; j < count; j++)
+            {
+                double ax = i ? x[sequence[i - 1]] : from_x, ay = i ? y[sequence[i - 1]] : from_y;
+                double bx = j < count - 1 ? x[sequence[j + 1]] : to_x, by = j < count - 1 ? y[sequence[j + 1]] : to_y;
+                double before = hypot(x[sequence[i]] - ax, y[sequence[i]] - ay) + hypot(bx - x[sequence[j]], by - y[sequence[j]]);
+                double after = hypot(x[sequence[j]] - ax, y[sequence[j]] - ay) + hypot(bx - x[sequence[i]], by - y[sequence[i]]);
+
+                if (after < before - 1e-9)
+                {
+                    for (int a = i, b = j; a < b; a++, b--)
+                    {
+                        int k = sequence[a];
+                        sequence[a] = sequence[b];
+                        sequence[b] = k;
+                    }
+                    improved = TRUE;
+                }
+            }
+        }
+    }
+    return tripTravel(x, y, sequence, count, from_x, from_y, to_x, to_y);
+}
+
+/*
+ Function: sequencePlacements
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ chooses the order in which the loaded nozzles of the head place their parts, on a trip from the look-up
+ camera to the position after the trip, see sequenceTrip()
+ Argument(s):
+ const PlacementStore *store - the parts of the job
+ const char nozzle_loaded[] - TRUE for each nozzle holding a part to place
+ const int nozzle_part[] - the part on each loaded nozzle
+ double next_x, double next_y - the head position after the trip, the first pick of the next trip or home
+ int place_sequence[] - set to the loaded nozzles in placement order
+ double *trip_travel - set to the travel of the trip in that order, in mm
+ double *pick_order_travel - set to the travel of the trip placing in pick order
+ Return Value: the number of nozzles in place_sequence[]
+ Usage: count = sequencePlacements(&placements, nozzle_status, nozzle_part, next_x, next_y, place_sequence, &travel, &pick_order_travel);
+ */
+int sequencePlacements(const PlacementStore *store, const char nozzle_loaded[], const int nozzle_part[], double next_x, double next_y,
+                       int place_sequence[], double *trip_travel, double *pick_order_travel)
+{
+    double place_x[MAX_NUMBER_OF_NOZZLES] = {0}, place_y[MAX_NUMBER_OF_NOZZLES] = {0};
+    int loaded[MAX_NUMBER_OF_NOZZLES], sequence[MAX_NUMBER_OF_NOZZLES], place_count = 0;
+
+    for (int n = 0; n < HEAD_NOZZLES; n++)
+    {  //the head position which puts each loaded nozzle over its part
+        if (!nozzle_loaded[n]) continue;
+        loaded[place_count] = n;
+        place_x[place_count] = store -> x[nozzle_part[n]] - machine.nozzle_x[n];
+        place_y[place_count++] = store -> y[nozzle_part[n]];
+    }
+    *pick_order_travel = tripTravel(place_x, place_y, NULL, place_count, machine.camera_x, machine.camera_y, next_x, next_y);
+    *trip_travel = sequenceTrip(place_x, place_y, place_count, machine.camera_x, machine.camera_y, next_x, next_y, sequence);
+    for (int s = 0; s < place_count; s++) place_sequence[s] = loaded[sequence[s]];
+    return place_count;
+}
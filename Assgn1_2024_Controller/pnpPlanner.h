@@ -0,0 +1,52 @@
+/*
+ *
+ * pnpPlanner.h - declarations for the placement planner, which decides the order in which the parts
+ * of a job are picked and estimates the gantry travel of the resulting route
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPPLANNER_H
+#define PNPPLANNER_H
+
+#include "pnpPlacementStore.h"
+#include "pnpMachineProfile.h"
+
+#define ROUTE_BLOCK_SIZE 1024    // waypoints measured by each pathLength() call of routeLength()
+
+#define NEAREST_SCAN_LIMIT 256  // feeders with more parts use the spatial index in orderPlacementsNearest()
+
+#define SEQUENCE_EXACT_LIMIT 8  // trips with more placements are sequenced by 2-opt instead of trying every order
+
+/* the pick orders chosen by planPlacements() */
+#define PLAN_BY_FEEDER_AND_Y 0
+#define PLAN_BY_NEAREST_NEIGHBOUR 1
+#define PLAN_FOR_GANG_PICK 2
+
+extern int nearest_scan_limit;
+
+int orderPlacements(const PlacementStore*, int[]);
+
+double routeLength(const PlacementStore*, const int[], int);
+
+int orderPlacementsNearest(const PlacementStore*, int[]);
+
+int planPlacements(const PlacementStore*, int[]);
+
+int gangPickSize(const PlacementStore*, const int[], int, int, int);
+
+int orderPlacementsGang(const PlacementStore*, int[]);
+
+long planInstructions(const PlacementStore*, const int[], int);
+
+double planCycleTime(const PlacementStore*, const int[], int);
+
+double tripTravel(const double[], const double[], const int[], int, double, double, double, double);
+
+double sequenceTrip(const double[], const double[], int, double, double, double, double, int[]);
+
+int sequencePlacements(const PlacementStore*, const char[], const int[], double, double, int[], double*, double*);
+
+#endif
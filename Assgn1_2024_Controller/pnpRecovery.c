@@ -0,0 +1,197 @@
+/*
+ *
+ * pnpRecovery.c - pick recovery, which checks every pick at the look-up camera and decides what happens
+ * to a part that was not picked properly
+ *
+ * A pick fails if the simulator reports the nozzle empty at the look-up camera, see getPickStatus(), or if
+ * the pick error is more than the max_pick_error of the machine profile, if it sets one. The part is then
+ * picked again in a later trip, RECOVERY_RETRIES_PER_FEEDER times from its feeder, then from an alternate
+ * feeder holding the same footprint and value, if there is one. After RECOVERY_MAX_ATTEMPTS failed picks the
+ * part is skipped, so a bad part or feeder never stops the job. The picks and failures of every feeder are
+ * counted for the mis-pick report at the end of the job.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpRecovery.h"
+
+/*
+ Function: recoveryInit
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: sets up the recovery state for a job, with no failed picks and zeroed feeder counters
+ Argument(s):
+ RecoveryState *recovery - the recovery state, freed first if it was set up before
+ int count - the number of parts of the job
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: recoveryInit(&recovery, placements.count);
+ */
+int recoveryInit(RecoveryState *recovery, int count)
+{
+    recoveryFree(recovery);
+    recovery -> attempts = calloc(count ? count : 1, 1);
+    recovery -> feeder_attempts = calloc(count ? count : 1, 1);
+    if (recovery -> attempts == NULL || recovery -> feeder_attempts == NULL)
+    {
+        recoveryFree(recovery);
+        return -1;
+    }
+    recovery -> count = count;
+    return 0;
+}
+
+/*
+ Function: recoveryFree
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: frees the memory of a recovery state and zeroes it, a zeroed state can be freed again
+ Argument(s): RecoveryState *recovery - the recovery state
+ Return Value: none
+ Usage: recoveryFree(&recovery);
+ */
+void recoveryFree(RecoveryState *recovery)
+{
+    free(recovery -> attempts);
+    free(recovery -> feeder_attempts);
+    memset(recovery, 0, sizeof(RecoveryState));
+}
+
+/*
+ Function: checkPick
+ -------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: classifies a pick from the results of the look-up photo
+ Argument(s):
+ int pick_status - the status of the nozzle, PICK_STATUS_UNKNOWN if the simulator does not report it
+ double theta_error - the pick error of the nozzle in degrees
+ Return Value: PICK_OK, PICK_MISSED or PICK_OUT_OF_RANGE
+ Usage: int pick = checkPick(getPickStatus(nozzle), getPickErrorTheta(nozzle));
+ */
+int checkPick(int pick_status, double theta_error)
+{
+    if (pick_status == PICK_STATUS_NOZZLE_EMPTY) return PICK_MISSED;
+    if (machine.max_pick_error > 0 && fabs(theta_error) > machine.max_pick_error) return PICK_OUT_OF_RANGE;
+    return PICK_OK;
+}
+
+/*
+ Function: recordPick
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: counts a pick from a feeder for the mis-pick report
+ Argument(s):
+ RecoveryState *recovery - the recovery state
+ int feeder - the feeder picked from
+ int pick - the result of the pick, from checkPick()
+ Return Value: none
+ Usage: recordPick(&recovery, placements.feeder[part], pick);
+ */
+void recordPick(RecoveryState *recovery, int feeder, int pick)
+{
+    recovery -> picks[feeder]++;
+    if (pick == PICK_MISSED) recovery -> missed[feeder]++;
+    else if (pick == PICK_OUT_OF_RANGE) recovery -> rejected[feeder]++;
+}
+
+/*
+ Function: alternateFeeder
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ finds another feeder holding parts with the same footprint and value as a part, the one with the fewest
+ failed picks so far in proportion to its picks
+ Argument(s):
+ const RecoveryState *recovery - the recovery state
+ const PlacementStore *store - the parts of the job
+ int part - the part
+ Return Value: the feeder, or NO_TAPE_FEEDER_AT_THIS_LOCATION if no other feeder holds the part
+ Usage: int feeder = alternateFeeder(&recovery, &placements, part);
+ */
+int alternateFeeder(const RecoveryState *recovery, const PlacementStore *store, int part)
+{
+    char holds_part[MAX_NUMBER_OF_FEEDERS] = {0};
+    int best = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+    double best_rate = 0;
+
+    for (int i = 0; i < store -> count; i++)
+    {
+        if (store -> footprint[i] == store -> footprint[part] && store -> value[i] == store -> value[part])
+            holds_part[store -> feeder[i]] = TRUE;
+    }
+    for (int f = 0; f < machine.number_of_feeders; f++)
+    {
+        if (!holds_part[f] || f == store -> feeder[part]) continue;
+        double rate = recovery -> picks[f] ? (double) (recovery -> missed[f] + recovery -> rejected[f]) / recovery -> picks[f] : 0;
+        if (best == NO_TAPE_FEEDER_AT_THIS_LOCATION || rate < best_rate)
+        {
+            best = f;
+            best_rate = rate;
+        }
+    }
+    return best;
+}
+
+/*
+ Function: recoverPart
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ decides what happens to a part after a failed pick. The part is picked again, from an alternate feeder
+ once it has failed RECOVERY_RETRIES_PER_FEEDER times from its feeder, in which case the feeder of the
+ part is changed in the store, or is skipped after RECOVERY_MAX_ATTEMPTS failed picks.
+ Argument(s):
+ RecoveryState *recovery - the recovery state
+ PlacementStore *store - the parts of the job
+ int part - the part
+ Return Value: RECOVERY_REQUEUE or RECOVERY_SKIP
+ Usage: if (recoverPart(&recovery, &placements, part) == RECOVERY_REQUEUE) ...
+ */
+int recoverPart(RecoveryState *recovery, PlacementStore *store, int part)
+{
+    if (++recovery -> attempts[part] >= RECOVERY_MAX_ATTEMPTS)
+    {
+        recovery -> skipped++;
+        return RECOVERY_SKIP;
+    }
+    if (++recovery -> feeder_attempts[part] >= RECOVERY_RETRIES_PER_FEEDER)
+    {
+        int feeder = alternateFeeder(recovery, store, part);
+        if (feeder != NO_TAPE_FEEDER_AT_THIS_LOCATION)
+        {
+            store -> feeder[part] = feeder;
+            recovery -> feeder_attempts[part] = 0;
+        }
+    }
+    recovery -> requeued++;
+    return RECOVERY_REQUEUE;
+}
+
+/*
+ Function: printFeederStatistics
+ -------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: prints the picks and the mis-pick rate of every feeder picked from, and the parts picked again or skipped
+ Argument(s): const RecoveryState *recovery - the recovery state
+ Return Value: none
+ Usage: printFeederStatistics(&recovery);
+ */
+void printFeederStatistics(const RecoveryState *recovery)
+{
+    printf("Feeder  picks  missed  rejected  mis-pick rate\n");
+    for (int f = 0; f < machine.number_of_feeders; f++)
+    {
+        if (recovery -> picks[f] == 0) continue;
+        printf("%6d %6d %7d %9d %13.1f%%\n", f, recovery -> picks[f], recovery -> missed[f], recovery -> rejected[f],
+               100.0 * (recovery -> missed[f] + recovery -> rejected[f]) / recovery -> picks[f]);
+    }
+    printf("%d parts picked again, %d parts skipped\n\n", recovery -> requeued, recovery -> skipped);
+}
@@ -0,0 +1,56 @@
+/*
+ *
+ * pnpRecovery.h - declarations for pick recovery, which checks every pick at the look-up camera and
+ * decides what happens to a part that was not picked properly
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPRECOVERY_H
+#define PNPRECOVERY_H
+
+#include "pnpPlacementStore.h"
+#include "pnpMachineProfile.h"
+
+#define RECOVERY_RETRIES_PER_FEEDER 2     // failed picks of a part from one feeder before an alternate feeder is tried
+#define RECOVERY_MAX_ATTEMPTS 5           // failed picks of a part before it is skipped
+
+/* the result of a pick, from checkPick() */
+#define PICK_OK 0
+#define PICK_MISSED 1                     // the nozzle is empty at the look-up camera
+#define PICK_OUT_OF_RANGE 2               // the part is on the nozzle at an angle beyond correction, see max_pick_error in the
+                                          // machine profile, it goes to the reject bin
+
+/* what happens to a part after a failed pick, from recoverPart() */
+#define RECOVERY_REQUEUE 0
+#define RECOVERY_SKIP 1
+
+typedef struct
+{
+    int count;                                      // the parts of the job
+    unsigned char *attempts;                        // failed picks of each part
+    unsigned char *feeder_attempts;                 // failed picks of each part from its current feeder
+    int picks[MAX_NUMBER_OF_FEEDERS];
+    int missed[MAX_NUMBER_OF_FEEDERS];
+    int rejected[MAX_NUMBER_OF_FEEDERS];
+    int requeued, skipped;
+
+} RecoveryState;
+
+int recoveryInit(RecoveryState*, int);
+
+void recoveryFree(RecoveryState*);
+
+int checkPick(int, double);
+
+void recordPick(RecoveryState*, int, int);
+
+int alternateFeeder(const RecoveryState*, const PlacementStore*, int);
+
+int recoverPart(RecoveryState*, PlacementStore*, int);
+
+void printFeederStatistics(const RecoveryState*);
+
+#endif
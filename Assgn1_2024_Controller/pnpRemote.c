@@ -0,0 +1,589 @@
+/*
+ *
+ * pnpRemote.c - the remote command and telemetry endpoint of the pick and place machine controller
+ *
+ * A line supervisor connects to the Unix domain socket REMOTE_SOCKET and sends one command per line:
+ *
+ *   LOAD <centroid file>   load a new job, the job waits for START (automatic mode only)
+ *   START                  start or resume automatic placement
+ *   PAUSE                  finish the current instruction, then hold the machine
+ *   STATUS                 reply with one telemetry line
+ *   STREAM <rate>          send telemetry lines at rate per second, STREAM 0 stops the stream
+ *   PING                   reply with PONG
+ *
+ * Replies start with OK, ERR or PONG, telemetry lines start with T. All sockets are non-blocking and
+ * output is buffered per client, telemetry lines that do not fit in the buffer of a slow client are
+ * dropped, and a client that stops reading its replies is disconnected, so a client can never stall the
+ * control loop.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <strings.h>
+#include "pnpRemote.h"
+
+typedef struct
+{
+    int fd;
+    unsigned int generation;                // counts connections, so a slot reused by a new client is told apart
+    char input[REMOTE_LINE_LENGTH];
+    int input_length;
+    char output[REMOTE_OUTPUT_BUFFER_SIZE];
+    int output_length;
+    int line_started;                       // TRUE when part of the first line of output has already been sent
+    long telemetry_period_us;               // 0 when the client is not streaming
+    long long next_telemetry_us;
+    long dropped_lines;
+
+} RemoteClient;
+
+int listen_fd = -1;
+RemoteClient clients[REMOTE_MAX_CLIENTS];
+unsigned int connections = 0;
+
+RemoteCommand command_queue[REMOTE_COMMAND_QUEUE_SIZE];
+unsigned int command_queue_head = 0, command_queue_tail = 0;
+
+ControllerStatus last_status;
+int last_status_valid = FALSE;
+
+/*
+ Function: monotonicMicroseconds
+ -------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: gets a monotonic wall clock time, used to pace the telemetry streams
+ Argument(s): none
+ Return Value: the time in microseconds from an arbitrary starting point
+ Usage: long long now = monotonicMicroseconds();
+ */
+long long monotonicMicroseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ Function: flushClient
+ ---------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: sends as much of the output buffer of a client as the socket accepts without blocking
+ Argument(s):
+ RemoteClient *client - the client to flush
+ Return Value: none
+ Usage: flushClient(&clients[i]);
+ */
+void flushClient(RemoteClient *client)
+{
+    ssize_t sent = 0;
+
+    if (client -> output_length == 0) return;
+    sent = send(client -> fd, client -> output, client -> output_length, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent <= 0) return;
+
+    client -> line_started = (client -> output[sent - 1] != '\n');
+    client -> output_length -= sent;
+    memmove(client -> output, client -> output + sent, client -> output_length);
+}
+
+/*
+ Function: dropTelemetry
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ makes room for a reply by removing the telemetry lines waiting in the output buffer of a client. A line
+ of which some has already been sent is kept, so the client never gets part of a line
+ Argument(s):
+ RemoteClient *client - the client
+ Return Value: none
+ Usage: dropTelemetry(client);
+ */
+void dropTelemetry(RemoteClient *client)
+{
+    int from = 0, to = 0;
+
+    while (from < client -> output_length)
+    {
+        char *newline = memchr(client -> output + from, '\n', client -> output_length - from);
+        int length = (newline != NULL) ? newline + 1 - (client -> output + from) : client -> output_length - from;
+
+        if (client -> output[from] == 'T' && (from > 0 || !client -> line_started)) client -> dropped_lines++;
+        else
+        {
+            memmove(client -> output + to, client -> output + from, length);
+            to += length;
+        }
+        from += length;
+    }
+    client -> output_length = to;
+}
+
+/*
+ Function: disconnectClient
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: closes the connection to a client and frees its slot
+ Argument(s):
+ RemoteClient *client - the client to disconnect
+ Return Value: none
+ Usage: disconnectClient(&clients[i]);
+ */
+void disconnectClient(RemoteClient *client)
+{
+    removeInputSource(client -> fd);
+    close(client -> fd);
+    client -> fd = -1;
+}
+
+/*
+ Function: sendLine
+ ------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ appends one line to the output buffer of a client and tries to send it. Telemetry lines are dropped
+ if they do not fit. A reply that does not fit takes the place of the telemetry lines waiting to be sent,
+ and if it still does not fit, the client has stopped reading replies and is disconnected.
+ Argument(s):
+ RemoteClient *client - the client to send to
+ const char *line - the line, including its newline
+ int length - the length of the line
+ int droppable - TRUE for telemetry lines
+ Return Value: none
+ Usage: sendLine(client, line, length, TRUE);
+ */
+void sendLine(RemoteClient *client, const char *line, int length, int droppable)
+{
+    if (client -> output_length + length > REMOTE_OUTPUT_BUFFER_SIZE) flushClient(client);
+    if (client -> output_length + length > REMOTE_OUTPUT_BUFFER_SIZE)
+    {
+        if (droppable) {client -> dropped_lines++; return;}
+        dropTelemetry(client);
+        if (client -> output_length + length > REMOTE_OUTPUT_BUFFER_SIZE) {disconnectClient(client); return;}
+    }
+    memcpy(client -> output + client -> output_length, line, length);
+    client -> output_length += length;
+    flushClient(client);
+}
+
+/*
+ Function: formatTelemetry
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ formats a controller status snapshot as one telemetry line, for example
+ T t=12.50 mode=A state=8 name=MOVE_TO_PCB paused=0 part=5/40 placed=3 nozzles=H:12,H:13,E:- pick=-1.20,0.30,0.00 preplace=0.17,-0.05 cph=864.0
+ Argument(s):
+ char *line - the buffer to format into
+ int size - the size of the buffer
+ const ControllerStatus *status - the snapshot to format
+ Return Value: the length of the line, including the newline
+ Usage: int length = formatTelemetry(line, sizeof(line), &status);
+ */
+int formatTelemetry(char *line, int size, const ControllerStatus *status)
+{
+    char name[32];
+    int n = 0, i = 0;
+    double elapsed = status -> sim_time - status -> job_start_time;
+    double cph = (elapsed > 0.0) ? 3600.0 * status -> parts_placed / elapsed : 0.0;
+
+    /* state names are padded with spaces for display, trim them and join the words for parsing */
+    for (i = 0; status -> state_name != NULL && status -> state_name[i] != '\0' && i < (int) sizeof(name) - 1; i++)
+        name[i] = (status -> state_name[i] == ' ') ? '_' : status -> state_name[i];
+    while (i > 0 && name[i - 1] == '_') i--;
+    name[i] = '\0';
+
+    n += snprintf(line + n, size - n, "T t=%.2f mode=%c state=%d name=%s paused=%d part=%d/%d placed=%d nozzles=",
+                  status -> sim_time, (status -> operation_mode == MANUAL_CONTROL) ? 'M' : 'A', status -> state, name,
+                  status -> paused, status -> part_counter, status -> number_of_components_to_place, status -> parts_placed);
+    for (i = 0; i < status -> number_of_nozzles && n < size; i++)
+    {
+        if (status -> nozzle_status[i]) n += snprintf(line + n, size - n, "%sH:%d", i ? "," : "", status -> nozzle_part[i]);
+        else n += snprintf(line + n, size - n, "%sE:-", i ? "," : "");
+    }
+    for (i = 0; i < status -> number_of_nozzles && n < size; i++)
+        n += snprintf(line + n, size - n, "%s%.2f", i ? "," : " pick=", status -> theta_pick_error[i]);
+    if (n < size)
+        n += snprintf(line + n, size - n, " preplace=%.2f,%.2f cph=%.1f\n", status -> x_preplace_error, status -> y_preplace_error, cph);
+
+    return (n < size) ? n : size - 1;
+}
+
+/*
+ Function: replyClient
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: sends a printf style formatted reply line to a connected client, the newline is added
+ Argument(s):
+ int client - the index of the client
+ const char *format, va_list args - as vprintf()
+ Return Value: none
+ Usage: replyClient(client, format, args);
+ */
+void replyClient(int client, const char *format, va_list args)
+{
+    char line[REMOTE_LINE_LENGTH + 64];
+
+    if (client < 0 || client >= REMOTE_MAX_CLIENTS || clients[client].fd < 0) return;
+
+    int n = vsnprintf(line, sizeof(line) - 1, format, args);
+    if (n > (int) sizeof(line) - 2) n = sizeof(line) - 2;
+    line[n++] = '\n';
+    sendLine(&clients[client], line, n, FALSE);
+}
+
+/*
+ * sendReply - answers a line from a client at once, as it is handled
+ */
+void sendReply(int client, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    replyClient(client, format, args);
+    va_end(args);
+}
+
+/*
+ Function: queueCommand
+ ----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: passes a command from a client to the controller, see getRemoteCommand()
+ Argument(s):
+ int client - the index of the client that sent the command
+ int command - REMOTE_LOAD, REMOTE_START or REMOTE_PAUSE
+ const char *argument - the command argument, may be empty
+ Return Value: none
+ Usage: queueCommand(i, REMOTE_START, "");
+ */
+void queueCommand(int client, int command, const char *argument)
+{
+    if (command_queue_tail - command_queue_head == REMOTE_COMMAND_QUEUE_SIZE)
+    {
+        sendReply(client, "ERR busy, command queue full");
+        return;
+    }
+    RemoteCommand *c = &command_queue[command_queue_tail++ % REMOTE_COMMAND_QUEUE_SIZE];
+    c -> command = command;
+    c -> client = client;
+    c -> generation = clients[client].generation;
+    snprintf(c -> argument, sizeof(c -> argument), "%s", argument);
+}
+
+/*
+ Function: handleLine
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: parses one command line received from a client
+ Argument(s):
+ int client - the index of the client
+ char *line - the command line without its newline
+ Return Value: none
+ Usage: handleLine(i, line);
+ */
+void handleLine(int client, char *line)
+{
+    char verb[16] = "", argument[REMOTE_LINE_LENGTH] = "";
+    char telemetry[512];
+
+    if (sscanf(line, "%15s %255[^\r\n]", verb, argument) < 1) return;
+
+    if (strcasecmp(verb, "LOAD") == 0)
+    {
+        if (argument[0] == '\0') sendReply(client, "ERR LOAD needs a centroid file name");
+        else queueCommand(client, REMOTE_LOAD, argument);
+    }
+    else if (strcasecmp(verb, "START") == 0) queueCommand(client, REMOTE_START, "");
+    else if (strcasecmp(verb, "PAUSE") == 0) queueCommand(client, REMOTE_PAUSE, "");
+    else if (strcasecmp(verb, "STATUS") == 0)
+    {
+        if (!last_status_valid) sendReply(client, "ERR no status yet");
+        else sendLine(&clients[client], telemetry, formatTelemetry(telemetry, sizeof(telemetry), &last_status), FALSE);
+    }
+    else if (strcasecmp(verb, "STREAM") == 0)
+    {
+        long rate = atol(argument);
+
+        if (rate < 0 || rate > REMOTE_MAX_TELEMETRY_RATE)
+        {
+            sendReply(client, "ERR rate must be 0 to %d", REMOTE_MAX_TELEMETRY_RATE);
+            return;
+        }
+        clients[client].telemetry_period_us = rate ? 1000000 / rate : 0;
+        clients[client].next_telemetry_us = monotonicMicroseconds();
+        sendReply(client, "OK stream %ld", rate);
+    }
+    else if (strcasecmp(verb, "PING") == 0) sendReply(client, "PONG");
+    else sendReply(client, "ERR unknown command %s", verb);
+}
+
+/*
+ Function: readClient
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: input source handler for a connected client, reads and handles complete command lines
+ Argument(s):
+ int fd - the socket of the client
+ Return Value: none
+ Usage: not called directly but via waitForEvent()
+ */
+void readClient(int fd)
+{
+    int client = 0;
+
+    while (client < REMOTE_MAX_CLIENTS && clients[client].fd != fd) client++;
+    if (client == REMOTE_MAX_CLIENTS) {removeInputSource(fd); return;}
+
+    RemoteClient *c = &clients[client];
+    ssize_t n = recv(fd, c -> input + c -> input_length, REMOTE_LINE_LENGTH - 1 - c -> input_length, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {disconnectClient(c); return;}
+    if (n < 0) return;
+    c -> input_length += n;
+    c -> input[c -> input_length] = '\0';
+
+    char *newline;
+    while (c -> fd >= 0 && (newline = strchr(c -> input, '\n')) != NULL)
+    {
+        *newline = '\0';
+        handleLine(client, c -> input);
+        c -> input_length -= (newline + 1 - c -> input);
+        memmove(c -> input, newline + 1, c -> input_length + 1);
+    }
+    if (c -> input_length == REMOTE_LINE_LENGTH - 1)
+    {
+        sendReply(client, "ERR line too long");
+        c -> input_length = 0;
+    }
+}
+
+/*
+ Function: acceptClient
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: input source handler for the listening socket, accepts a new client if there is a free slot
+ Argument(s):
+ int fd - the listening socket
+ Return Value: none
+ Usage: not called directly but via waitForEvent()
+ */
+void acceptClient(int fd)
+{
+    int client_fd = accept(fd, NULL, NULL);
+    if (client_fd < 0) return;
+
+    for (int i = 0; i < REMOTE_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd < 0)
+        {
+            if (addInputSource(client_fd, readClient) != 0) break;
+            fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+            memset(&clients[i], 0, sizeof(clients[i]));
+            clients[i].fd = client_fd;
+            clients[i].generation = ++connections;
+            return;
+        }
+    }
+    send(client_fd, "ERR too many clients\n", 21, MSG_DONTWAIT | MSG_NOSIGNAL);
+    close(client_fd);
+}
+
+/*
+ Function: remoteOpen
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ creates the listening socket REMOTE_SOCKET in the current working directory and registers it with
+ the input subsystem, must be called after pnpOpen()
+ Argument(s): none
+ Return Value:
+ 0 on success, -1 if the socket could not be created, in which case the controller runs without it
+ Usage: remoteOpen();
+ */
+int remoteOpen()
+{
+    struct sockaddr_un address;
+
+    for (int i = 0; i < REMOTE_MAX_CLIENTS; i++) clients[i].fd = -1;
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {perror("WARNING  remote endpoint unavailable"); return -1;}
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", REMOTE_SOCKET);
+    unlink(REMOTE_SOCKET);  // remove the socket left behind by a previous run
+
+    if (bind(listen_fd, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listen_fd, REMOTE_MAX_CLIENTS) != 0)
+    {
+        perror("WARNING  remote endpoint unavailable");
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+    addInputSource(listen_fd, acceptClient);
+    return 0;
+}
+
+/*
+ Function: remoteClose
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: disconnects all clients and removes the listening socket
+ Argument(s): none
+ Return Value: none
+ Usage: remoteClose();
+ */
+void remoteClose()
+{
+    if (listen_fd < 0) return;
+
+    for (int i = 0; i < REMOTE_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd >= 0)
+        {
+            flushClient(&clients[i]);
+            disconnectClient(&clients[i]);
+        }
+    }
+    removeInputSource(listen_fd);
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(REMOTE_SOCKET);
+}
+
+/*
+ Function: getRemoteCommand
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ gets the oldest command received from a client which has not already been handled, the controller
+ must answer each command with remoteReply()
+ Argument(s):
+ RemoteCommand *command - filled in with the command, if there is one
+ Return Value:
+ the command, REMOTE_LOAD, REMOTE_START or REMOTE_PAUSE, otherwise REMOTE_NO_COMMAND (0)
+ Usage:
+ RemoteCommand command;
+ if (getRemoteCommand(&command) == REMOTE_START) ...
+ */
+int getRemoteCommand(RemoteCommand *command)
+{
+    if (command_queue_head == command_queue_tail) return REMOTE_NO_COMMAND;
+
+    *command = command_queue[command_queue_head++ % REMOTE_COMMAND_QUEUE_SIZE];
+    return command -> command;
+}
+
+/*
+ Function: remoteReply
+ ---------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ sends a printf style formatted reply line to the client that sent a command, the newline is added.
+ The reply is dropped if that client has disconnected, even if another client has taken its slot
+ Argument(s):
+ const RemoteCommand *command - the command being answered
+ const char *format, ... - as printf()
+ Return Value: none
+ Usage: remoteReply(&command, "OK loaded %d parts", number_of_components_to_place);
+ */
+void remoteReply(const RemoteCommand *command, const char *format, ...)
+{
+    va_list args;
+
+    if (command -> client < 0 || command -> client >= REMOTE_MAX_CLIENTS ||
+        clients[command -> client].generation != command -> generation) return;
+
+    va_start(args, format);
+    replyClient(command -> client, format, args);
+    va_end(args);
+}
+
+/*
+ Function: remotePublish
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ records the latest controller status for STATUS requests and sends it to every streaming client
+ whose next telemetry line is due. Called once per control loop iteration, it never blocks.
+ Argument(s):
+ const ControllerStatus *status - the latest controller status
+ Return Value: none
+ Usage: remotePublish(&status);
+ */
+void remotePublish(const ControllerStatus *status)
+{
+    char line[512];
+    int length = 0;
+    long long now = 0;
+
+    last_status = *status;
+    last_status_valid = TRUE;
+
+    for (int i = 0; i < REMOTE_MAX_CLIENTS; i++)
+    {
+        RemoteClient *c = &clients[i];
+
+        if (c -> fd < 0) continue;
+        flushClient(c);
+        if (c -> telemetry_period_us == 0) continue;
+
+        if (now == 0) now = monotonicMicroseconds();
+        if (now < c -> next_telemetry_us) continue;
+
+        if (length == 0) length = formatTelemetry(line, sizeof(line), status);
+        sendLine(c, line, length, TRUE);
+        c -> next_telemetry_us += c -> telemetry_period_us;
+        if (c -> next_telemetry_us < now) c -> next_telemetry_us = now + c -> telemetry_period_us;  // skip lines missed while busy
+    }
+}
+
+/*
+ Function: remoteWaitTimeout
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ shortens the timeout passed to waitForEvent() so that the control loop wakes in time to send the
+ next due telemetry line
+ Argument(s):
+ long timeout_ms - the timeout the control loop would otherwise use
+ Return Value: the timeout to pass to waitForEvent() in ms, at least 1
+ Usage: waitForEvent(remoteWaitTimeout(1000 / POLL_LOOP_RATE));
+ */
+long remoteWaitTimeout(long timeout_ms)
+{
+    long long now = 0;
+
+    for (int i = 0; i < REMOTE_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd < 0 || clients[i].telemetry_period_us == 0) continue;
+        if (now == 0) now = monotonicMicroseconds();
+
+        long due_ms = (long) ((clients[i].next_telemetry_us - now + 999) / 1000);
+        if (due_ms < timeout_ms) timeout_ms = due_ms;
+    }
+    return (timeout_ms < 1) ? 1 : timeout_ms;
+}
@@ -0,0 +1,55 @@
+/*
+ *
+ * pnpRemote.h - declarations for the remote command and telemetry endpoint of the pick and place
+ * machine controller
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPREMOTE_H
+#define PNPREMOTE_H
+
+#include "pnpControl.h"
+
+#define REMOTE_SOCKET "pnp_control_socket"
+
+#define REMOTE_MAX_CLIENTS 4                // each client uses one of the MAX_INPUT_SOURCES of the input subsystem
+#define REMOTE_LINE_LENGTH 256              // longest command line accepted from a client, including the newline
+#define REMOTE_OUTPUT_BUFFER_SIZE 16384     // replies and telemetry waiting to be sent to a slow client
+#define REMOTE_MAX_TELEMETRY_RATE 1000      // telemetry lines per second
+#define REMOTE_COMMAND_QUEUE_SIZE 16
+
+/* commands passed to the controller, STATUS, STREAM and PING are answered by the endpoint itself */
+#define REMOTE_NO_COMMAND 0
+#define REMOTE_LOAD 1
+#define REMOTE_START 2
+#define REMOTE_PAUSE 3
+
+typedef struct
+{
+    int command;
+    int client;                             // the client to send the reply to, see remoteReply()
+    unsigned int generation;                // the connection of that client, a reply is dropped once it has gone
+    char argument[REMOTE_LINE_LENGTH];
+
+} RemoteCommand;
+
+int remoteOpen();
+
+void remoteClose();
+
+int getRemoteCommand(RemoteCommand*);
+
+void remoteReply(const RemoteCommand*, const char*, ...);
+
+void remotePublish(const ControllerStatus*);
+
+long remoteWaitTimeout(long);
+
+int formatTelemetry(char*, int, const ControllerStatus*);
+
+long long monotonicMicroseconds();
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ *
+ * pnpShared.h - declarations for the version 2 layout of the shared memory between the controller and a
+ * simulator, and the routines both sides use to pass instructions and results through it
+ *
+ * In the PnP block the fields written by the controller share cache lines with the fields written by the
+ * simulator, so every write by one side moves the line away from the other, and the arguments of an
+ * instruction are plain stores which the simulator can read half written. The PnPSharedV2 block follows the
+ * PnP and PnPExtension blocks in the memory mapped file, at PNP_V2_OFFSET, and keeps what each side writes on
+ * cache lines of its own:
+ *   - the controller fills in the instruction and then publishes it by incrementing issued with release
+ *     ordering, a simulator that reads issued with acquire ordering always sees the whole instruction
+ *   - the simulator writes the results of the instruction into the snapshot under a sequence lock, as the
+ *     telemetry block does, then sets done to the number of the instruction with release ordering. The
+ *     controller takes a consistent copy of the snapshot with readSnapshotV2() whenever generation changes.
+ * A simulator that serves the layout advertises it by writing its pid and version and then PNP_V2_MAGIC into
+ * the block, and clears the magic when it quits. The controller uses the PnP block until it sees a live
+ * simulator advertising the layout, so it runs unchanged with the simulator of the assignment, which only
+ * knows the PnP block. The quit flag stays in the PnP block, as both sides set it.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPSHARED_H
+#define PNPSHARED_H
+
+#include <signal.h>
+#include <stdatomic.h>
+#include "pnpControl.h"
+
+#define PNP_V2_MAGIC 0x32506e50         // "PnP2"
+#define PNP_V2_VERSION 2
+#define PNP_V2_OFFSET 256               // bytes from the start of the memory mapped file to the PnPSharedV2 block
+#define PNP_V2_READ_RETRIES 1000        // readSnapshotV2() gives up after this many torn reads
+#define CACHE_LINE_SIZE 64
+
+#define SHARED_LAYOUT_V1 1              // instructions and results pass through the PnP block
+#define SHARED_LAYOUT_V2 2              // instructions and results pass through the PnPSharedV2 block
+
+_Static_assert(sizeof(PnP) + sizeof(PnPExtension) <= PNP_V2_OFFSET, "the PnPSharedV2 block must follow the PnPExtension block");
+
+/* an instruction and its arguments, written by the controller only */
+typedef struct
+{
+    int instruction;
+    int argument_3;
+    double argument_1;
+    double argument_2;
+
+} PnPInstruction;
+
+/* the results of the instructions executed so far, written by the simulator only */
+typedef struct
+{
+    double sim_time;
+    double x_preplace_error;
+    double y_preplace_error;
+    double theta_pick_error[MAX_NUMBER_OF_NOZZLES];
+    int pick_status[MAX_NUMBER_OF_NOZZLES];
+    double lookup_photo_time;
+
+} PnPSnapshot;
+
+typedef struct
+{
+    /* the controller's cache line */
+    _Alignas(CACHE_LINE_SIZE) _Atomic unsigned int issued;     // the number of instructions published
+    PnPInstruction instruction;
+
+    /* the simulator's cache lines */
+    _Alignas(CACHE_LINE_SIZE) _Atomic unsigned int magic;      // PNP_V2_MAGIC while a simulator serves the block
+    unsigned int version;
+    int simulator_pid;
+    _Atomic unsigned int done;                                  // the number of the last instruction executed
+    _Atomic unsigned int generation;                            // odd while the simulator is updating the snapshot
+    PnPSnapshot snapshot;
+
+} PnPSharedV2;
+
+/*
+ Function: publishInstructionV2
+ ------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: passes an instruction to the simulator, the simulator must have finished the previous one
+ Argument(s):
+ PnPSharedV2 *shared - the mapped block
+ int instruction - the instruction
+ double argument_1, double argument_2, int argument_3 - its arguments
+ Return Value: none
+ Usage: publishInstructionV2(shared, MOVE_HEAD, x, y, 0);
+ */
+static inline void publishInstructionV2(PnPSharedV2 *shared, int instruction, double argument_1, double argument_2, int argument_3)
+{
+    shared -> instruction.instruction = instruction;
+    shared -> instruction.argument_1 = argument_1;
+    shared -> instruction.argument_2 = argument_2;
+    shared -> instruction.argument_3 = argument_3;
+    atomic_fetch_add_explicit(&shared -> issued, 1, memory_order_release);
+}
+
+/*
+ Function: isInstructionDoneV2
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: determines whether the simulator has executed every instruction published
+ Argument(s): PnPSharedV2 *shared - the mapped block
+ Return Value: TRUE if it has, FALSE if not
+ Usage: if (isInstructionDoneV2(shared)) ...
+ */
+static inline int isInstructionDoneV2(PnPSharedV2 *shared)
+{
+    return atomic_load_explicit(&shared -> done, memory_order_acquire) == atomic_load_explicit(&shared -> issued, memory_order_relaxed);
+}
+
+/*
+ Function: takeInstructionV2
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: used by the simulator to take a copy of an instruction published and not yet executed
+ Argument(s):
+ PnPSharedV2 *shared - the mapped block
+ PnPInstruction *instruction - filled in with the copy
+ Return Value: the number of the instruction, to pass to finishInstructionV2(), or 0 if there is none
+ Usage: unsigned int number = takeInstructionV2(shared, &instruction);
+ */
+static inline unsigned int takeInstructionV2(PnPSharedV2 *shared, PnPInstruction *instruction)
+{
+    unsigned int issued = atomic_load_explicit(&shared -> issued, memory_order_acquire);
+
+    if (issued == atomic_load_explicit(&shared -> done, memory_order_relaxed)) return 0;
+    memcpy(instruction, &shared -> instruction, sizeof(PnPInstruction));
+    return issued;
+}
+
+/*
+ Function: writeSnapshotV2
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: used by the simulator to publish the results of an instruction, before it finishes the instruction
+ Argument(s):
+ PnPSharedV2 *shared - the mapped block
+ const PnPSnapshot *snapshot - the results
+ Return Value: none
+ Usage: writeSnapshotV2(shared, &results);
+ */
+static inline void writeSnapshotV2(PnPSharedV2 *shared, const PnPSnapshot *snapshot)
+{
+    unsigned int generation = atomic_load_explicit(&shared -> generation, memory_order_relaxed);
+
+    atomic_store_explicit(&shared -> generation, generation + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&shared -> snapshot, snapshot, sizeof(PnPSnapshot));
+    atomic_store_explicit(&shared -> generation, generation + 2, memory_order_release);
+}
+
+/*
+ Function: finishInstructionV2
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: used by the simulator to report an instruction executed, once its results are published
+ Argument(s):
+ PnPSharedV2 *shared - the mapped block
+ unsigned int number - the number of the instruction, from takeInstructionV2()
+ Return Value: none
+ Usage: finishInstructionV2(shared, number);
+ */
+static inline void finishInstructionV2(PnPSharedV2 *shared, unsigned int number)
+{
+    atomic_store_explicit(&shared -> done, number, memory_order_release);
+}
+
+/*
+ Function: readSnapshotV2
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: takes a consistent copy of the results of the instructions executed so far
+ Argument(s):
+ const PnPSharedV2 *shared - the mapped block
+ PnPSnapshot *snapshot - filled in with the copy
+ Return Value: the generation copied, or 0 if no consistent copy could be taken
+ Usage: unsigned int generation = readSnapshotV2(shared, &snapshot);
+ */
+static inline unsigned int readSnapshotV2(const PnPSharedV2 *shared, PnPSnapshot *snapshot)
+{
+    for (int retries = 0; retries < PNP_V2_READ_RETRIES; retries++)
+    {
+        unsigned int before = atomic_load_explicit(&shared -> generation, memory_order_acquire);
+        if (before & 1) continue;
+
+        memcpy(snapshot, &shared -> snapshot, sizeof(PnPSnapshot));
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&shared -> generation, memory_order_relaxed) == before) return before;
+    }
+    return 0;
+}
+
+/*
+ Function: isSimulatorServingV2
+ ------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ determines whether a simulator is advertising the layout, the pid is checked so that a block left behind
+ in the file by a simulator that was killed is not used
+ Argument(s): const PnPSharedV2 *shared - the mapped block
+ Return Value: TRUE if a live simulator serves the block, FALSE if not
+ Usage: if (isSimulatorServingV2(shared)) ...
+ */
+static inline int isSimulatorServingV2(const PnPSharedV2 *shared)
+{
+    if (atomic_load_explicit(&shared -> magic, memory_order_acquire) != PNP_V2_MAGIC || shared -> version != PNP_V2_VERSION) return FALSE;
+    return shared -> simulator_pid > 0 && (kill(shared -> simulator_pid, 0) == 0 || errno == EPERM);
+}
+
+#endif
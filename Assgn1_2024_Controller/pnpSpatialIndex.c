@@ -0,0 +1,381 @@
+/*
+ *
+ * pnpSpatialIndex.c - a uniform grid spatial index over placement targets, with k nearest and radius
+ * queries and removal of parts that have already been placed
+ *
+ * The grid is bucketed to the extent of the points, normally within the board envelope MIN_X..MAX_X,
+ * MIN_Y..MAX_Y, with cells sized for a few points each. Points are stored ordered by cell, so a query
+ * reads a few short contiguous runs. A nearest query searches rings of cells around the query point
+ * and stops once no unsearched cell can hold a nearer point.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpSpatialIndex.h"
+
+/*
+ Function: spatialIndexInit
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: initializes an empty spatial index, which must later be freed with spatialIndexFree()
+ Argument(s):
+ SpatialIndex *index - the index to initialize
+ Return Value: none
+ Usage: SpatialIndex index; spatialIndexInit(&index);
+ */
+void spatialIndexInit(SpatialIndex *index)
+{
+    memset(index, 0, sizeof(SpatialIndex));
+}
+
+/*
+ Function: spatialIndexFree
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: frees the memory of a spatial index and leaves it empty
+ Argument(s):
+ SpatialIndex *index - the index to free
+ Return Value: none
+ Usage: spatialIndexFree(&index);
+ */
+void spatialIndexFree(SpatialIndex *index)
+{
+    free(index -> cell_start);
+    free(index -> cell_live);
+    free(index -> x);
+    free(index -> y);
+    free(index -> id);
+    free(index -> position);
+    spatialIndexInit(index);
+}
+
+/*
+ Function: cellOf
+ ----------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: finds the column or row of the grid holding a coordinate, clamped to the grid
+ Argument(s):
+ double v - the x or y coordinate
+ double min - the lower grid edge of that axis
+ double cell_size - the cell size
+ int cells - the number of columns or rows
+ Return Value: the column or row
+ Usage: int column = cellOf(x, index -> min_x, index -> cell_size, index -> columns);
+ */
+int cellOf(double v, double min, double cell_size, int cells)
+{
+    double c = floor((v - min) / cell_size);
+
+    if (c < 0) return 0;
+    if (c >= cells) return cells - 1;
+    return (int) c;
+}
+
+/*
+ Function: buildGrid
+ -------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: builds an empty index over n points with ids in the range 0 to id_limit - 1
+ Argument(s):
+ SpatialIndex *index - the index, which must be empty
+ const double *x, const double *y - the points
+ const int *id - the id of each point, or NULL to use 0 to n - 1
+ int n - the number of points
+ int id_limit - one more than the largest id
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: if (buildGrid(&rebuilt, x, y, id, count, index -> id_limit) == 0) ...
+ */
+int buildGrid(SpatialIndex *index, const double *x, const double *y, const int *id, int n, int id_limit)
+{
+    double min_x = n ? x[0] : 0, min_y = n ? y[0] : 0, max_x = min_x, max_y = min_y;
+
+    for (int i = 1; i < n; i++)
+    {
+        min_x = fmin(min_x, x[i]);
+        max_x = fmax(max_x, x[i]);
+        min_y = fmin(min_y, y[i]);
+        max_y = fmax(max_y, y[i]);
+    }
+
+    /* square cells holding about SPATIAL_INDEX_POINTS_PER_CELL points each if the points are evenly spread */
+    double cells = n / SPATIAL_INDEX_POINTS_PER_CELL + 1.0;
+    if (cells > SPATIAL_INDEX_MAX_CELLS) cells = SPATIAL_INDEX_MAX_CELLS;
+    index -> cell_size = fmax(sqrt(fmax(max_x - min_x, 1e-3) * fmax(max_y - min_y, 1e-3) / cells), 1e-3);
+    index -> columns = (int) ((max_x - min_x) / index -> cell_size) + 1;
+    index -> rows = (int) ((max_y - min_y) / index -> cell_size) + 1;
+    index -> min_x = min_x;
+    index -> min_y = min_y;
+
+    int number_of_cells = index -> columns * index -> rows;
+    index -> cell_start = calloc(number_of_cells + 1, sizeof(int));
+    index -> cell_live = calloc(number_of_cells, sizeof(int));
+    index -> x = malloc((n ? n : 1) * sizeof(double));
+    index -> y = malloc((n ? n : 1) * sizeof(double));
+    index -> id = malloc((n ? n : 1) * sizeof(int));
+    index -> position = malloc((id_limit > n ? id_limit : n ? n : 1) * sizeof(int));
+    if (index -> cell_start == NULL || index -> cell_live == NULL || index -> x == NULL || index -> y == NULL || index -> id == NULL || index -> position == NULL)
+    {
+        spatialIndexFree(index);
+        return -1;
+    }
+
+    /* counting sort of the points by cell, position[] holds the cell of each point until it is placed */
+    for (int i = 0; i < n; i++)
+    {
+        int c = cellOf(y[i], min_y, index -> cell_size, index -> rows) * index -> columns + cellOf(x[i], min_x, index -> cell_size, index -> columns);
+        index -> position[i] = c;
+        index -> cell_live[c]++;
+    }
+    for (int c = 0; c < number_of_cells; c++) index -> cell_start[c + 1] = index -> cell_start[c] + index -> cell_live[c];
+    for (int c = 0; c < number_of_cells; c++) index -> cell_live[c] = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int c = index -> position[i], p = index -> cell_start[c] + index -> cell_live[c]++;
+        index -> x[p] = x[i];
+        index -> y[p] = y[i];
+        index -> id[p] = id ? id[i] : i;
+    }
+    for (int i = 0; i < id_limit; i++) index -> position[i] = -1;
+    for (int p = 0; p < n; p++) index -> position[index -> id[p]] = p;
+
+    index -> size = index -> count = n;
+    index -> id_limit = id_limit;
+    return 0;
+}
+
+/*
+ Function: spatialIndexBuild
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ builds the index over n points, replacing any points it already holds. The grid covers the points,
+ which are normally within the board envelope MIN_X..MAX_X, MIN_Y..MAX_Y. Ids must be in the range
+ 0 to n - 1, e.g. positions in the caller's arrays.
+ Argument(s):
+ SpatialIndex *index - the index
+ const double *x, const double *y - the points
+ const int *id - the id of each point, or NULL to use 0 to n - 1
+ int n - the number of points
+ Return Value: 0 on success, -1 if memory could not be allocated
+ Usage: spatialIndexBuild(&index, store.x, store.y, NULL, store.count);
+ */
+int spatialIndexBuild(SpatialIndex *index, const double *x, const double *y, const int *id, int n)
+{
+    spatialIndexFree(index);
+    return buildGrid(index, x, y, id, n, n);
+}
+
+/*
+ Function: compact
+ -----------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ rebuilds the index over the points not yet removed, so that the cells stay about as full as when it was
+ built and queries do not search through large emptied areas. The index is left as it is if memory
+ could not be allocated.
+ Argument(s):
+ SpatialIndex *index - the index
+ Return Value: none
+ Usage: compact(index);
+ */
+void compact(SpatialIndex *index)
+{
+    SpatialIndex rebuilt;
+    double *x = malloc((index -> count ? index -> count : 1) * sizeof(double)), *y = malloc((index -> count ? index -> count : 1) * sizeof(double));
+    int *id = malloc((index -> count ? index -> count : 1) * sizeof(int)), n = 0;
+
+    spatialIndexInit(&rebuilt);
+    if (x != NULL && y != NULL && id != NULL)
+    {
+        for (int c = 0; c < index -> columns * index -> rows; c++)
+        {
+            for (int p = index -> cell_start[c]; p < index -> cell_start[c] + index -> cell_live[c]; p++, n++)
+            {
+                x[n] = index -> x[p];
+                y[n] = index -> y[p];
+                id[n] = index -> id[p];
+            }
+        }
+        if (buildGrid(&rebuilt, x, y, id, n, index -> id_limit) == 0)
+        {
+            spatialIndexFree(index);
+            *index = rebuilt;
+        }
+    }
+    free(x);
+    free(y);
+    free(id);
+}
+
+/*
+ Function: spatialIndexRemove
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ removes a point from the index, e.g. once its part has been placed, so that queries no longer find it.
+ The last point of its cell takes its place, so removal takes constant time, apart from a rebuild
+ of the index each time the number of points falls by SPATIAL_INDEX_COMPACT_RATIO.
+ Argument(s):
+ SpatialIndex *index - the index
+ int id - the id of the point, points already removed are ignored
+ Return Value: none
+ Usage: spatialIndexRemove(&index, next);
+ */
+void spatialIndexRemove(SpatialIndex *index, int id)
+{
+    int p = index -> position[id];
+
+    if (p < 0) return;
+
+    int c = cellOf(index -> y[p], index -> min_y, index -> cell_size, index -> rows) * index -> columns
+            + cellOf(index -> x[p], index -> min_x, index -> cell_size, index -> columns);
+    int last = index -> cell_start[c] + index -> cell_live[c] - 1;
+
+    if (p > last) return;
+
+    /* swap the point with the last live point of its cell */
+    double x = index -> x[p], y = index -> y[p];
+    index -> x[p] = index -> x[last];
+    index -> y[p] = index -> y[last];
+    index -> id[p] = index -> id[last];
+    index -> position[index -> id[p]] = p;
+    index -> x[last] = x;
+    index -> y[last] = y;
+    index -> id[last] = id;
+    index -> position[id] = last;
+
+    index -> cell_live[c]--;
+    index -> count--;
+    if (index -> count * SPATIAL_INDEX_COMPACT_RATIO < index -> size && index -> size > SPATIAL_INDEX_MAX_K) compact(index);
+}
+
+/*
+ Function: spatialIndexNearest
+ -----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ finds the k points nearest to a point, nearest first. Points at the same distance are ordered by id.
+ Argument(s):
+ const SpatialIndex *index - the index
+ double px, double py - the point
+ int k - the number of points to find, at most SPATIAL_INDEX_MAX_K
+ int ids[] - set to the ids of the points found
+ double distance_squared[] - if not NULL, set to the squared distances of the points found
+ Return Value: the number of points found, less than k if fewer points remain in the index
+ Usage: int found = spatialIndexNearest(&index, LOOKUP_CAMERA_X, LOOKUP_CAMERA_Y, 1, &next, NULL);
+ */
+int spatialIndexNearest(const SpatialIndex *index, double px, double py, int k, int ids[], double distance_squared[])
+{
+    double best_d2[SPATIAL_INDEX_MAX_K];
+    int found = 0;
+
+    if (k > SPATIAL_INDEX_MAX_K) k = SPATIAL_INDEX_MAX_K;
+    if (k > index -> count) k = index -> count;
+    if (k <= 0) return 0;
+
+    int cx = cellOf(px, index -> min_x, index -> cell_size, index -> columns);
+    int cy = cellOf(py, index -> min_y, index -> cell_size, index -> rows);
+
+    for (int ring = 0; ; ring++)
+    {
+        int x0 = cx - ring, x1 = cx + ring, y0 = cy - ring, y1 = cy + ring;
+
+        for (int row = y0 > 0 ? y0 : 0; row <= y1 && row < index -> rows; row++)
+        {
+            /* only the cells on the edge of the ring are new */
+            int step = (row == y0 || row == y1) ? 1 : x1 - x0;
+            for (int column = x0; column <= x1; column += step > 0 ? step : 1)
+            {
+                if (column < 0 || column >= index -> columns) continue;
+
+                int c = row * index -> columns + column;
+                for (int p = index -> cell_start[c]; p < index -> cell_start[c] + index -> cell_live[c]; p++)
+                {
+                    double d2 = (index -> x[p] - px) * (index -> x[p] - px) + (index -> y[p] - py) * (index -> y[p] - py);
+                    int id = index -> id[p], slot;
+
+                    if (found == k && (d2 > best_d2[k - 1] || (d2 == best_d2[k - 1] && id > ids[k - 1]))) continue;
+
+                    /* insertion into the sorted list of the nearest points found so far */
+                    slot = found < k ? found++ : k - 1;
+                    while (slot > 0 && (best_d2[slot - 1] > d2 || (best_d2[slot - 1] == d2 && ids[slot - 1] > id)))
+                    {
+                        best_d2[slot] = best_d2[slot - 1];
+                        ids[slot] = ids[slot - 1];
+                        slot--;
+                    }
+                    best_d2[slot] = d2;
+                    ids[slot] = id;
+                }
+            }
+        }
+
+        /* stop when the whole grid has been searched, or no point outside the searched square can be as near as the k'th point */
+        if (x0 <= 0 && y0 <= 0 && x1 >= index -> columns - 1 && y1 >= index -> rows - 1) break;
+        if (found == k)
+        {   //sides of the square on the grid edge are ignored, there are no points beyond them
+            double margin = INFINITY;
+            if (x0 > 0) margin = fmin(margin, px - (index -> min_x + x0 * index -> cell_size));
+            if (x1 < index -> columns - 1) margin = fmin(margin, index -> min_x + (x1 + 1) * index -> cell_size - px);
+            if (y0 > 0) margin = fmin(margin, py - (index -> min_y + y0 * index -> cell_size));
+            if (y1 < index -> rows - 1) margin = fmin(margin, index -> min_y + (y1 + 1) * index -> cell_size - py);
+            if (margin > 0 && margin * margin > best_d2[k - 1]) break;
+        }
+    }
+
+    if (distance_squared != NULL) for (int i = 0; i < found; i++) distance_squared[i] = best_d2[i];
+    return found;
+}
+
+/*
+ Function: spatialIndexRadius
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: finds the points within a distance of a point, in no particular order
+ Argument(s):
+ const SpatialIndex *index - the index
+ double px, double py - the point
+ double radius - the distance
+ int ids[] - set to the ids of up to max_ids of the points found
+ int max_ids - the size of ids[]
+ Return Value: the number of points within the distance, which may be more than max_ids
+ Usage: int n = spatialIndexRadius(&index, x, y, 2 * NOZZLE_X_SEPARATION, ids, 100);
+ */
+int spatialIndexRadius(const SpatialIndex *index, double px, double py, double radius, int ids[], int max_ids)
+{
+    int found = 0;
+    double r2 = radius * radius;
+
+    if (index -> count == 0 || radius < 0) return 0;
+
+    int x0 = cellOf(px - radius, index -> min_x, index -> cell_size, index -> columns), x1 = cellOf(px + radius, index -> min_x, index -> cell_size, index -> columns);
+    int y0 = cellOf(py - radius, index -> min_y, index -> cell_size, index -> rows), y1 = cellOf(py + radius, index -> min_y, index -> cell_size, index -> rows);
+
+    for (int row = y0; row <= y1; row++)
+    {
+        for (int column = x0; column <= x1; column++)
+        {
+            int c = row * index -> columns + column;
+            for (int p = index -> cell_start[c]; p < index -> cell_start[c] + index -> cell_live[c]; p++)
+            {
+                if ((index -> x[p] - px) * (index -> x[p] - px) + (index -> y[p] - py) * (index -> y[p] - py) <= r2)
+                {
+                    if (found < max_ids) ids[found] = index -> id[p];
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,49 @@
+/*
+ *
+ * pnpSpatialIndex.h - declarations for the uniform grid spatial index over placement targets, used by the
+ * planner for nearest part and radius queries
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPSPATIALINDEX_H
+#define PNPSPATIALINDEX_H
+
+#include "pnpControl.h"
+
+#define SPATIAL_INDEX_POINTS_PER_CELL 2     // average number of points in a cell when the index is built
+#define SPATIAL_INDEX_MAX_CELLS 4194304     // limits the grid size for very large or very sparse boards
+#define SPATIAL_INDEX_MAX_K 64              // largest k of spatialIndexNearest()
+#define SPATIAL_INDEX_COMPACT_RATIO 4       // the index is rebuilt when 1 / SPATIAL_INDEX_COMPACT_RATIO of its points remain
+
+typedef struct
+{
+    double min_x, min_y;    // the lower left corner of the grid, which covers all points
+    double cell_size;
+    int columns, rows;
+    int *cell_start;        // the points of cell c are at cell_start[c] to cell_start[c + 1] - 1 of the arrays below
+    int *cell_live;         // the number of points of each cell not yet removed, which are kept first
+    double *x, *y;          // the points ordered by cell
+    int *id;                // the id of each point, as passed to spatialIndexBuild()
+    int *position;          // position[id] is the position of point id in the arrays above, -1 once compacted away
+    int size;               // the number of points the index was built with
+    int count;              // the number of points not yet removed
+    int id_limit;           // one more than the largest id
+
+} SpatialIndex;
+
+void spatialIndexInit(SpatialIndex*);
+
+void spatialIndexFree(SpatialIndex*);
+
+int spatialIndexBuild(SpatialIndex*, const double*, const double*, const int*, int);
+
+void spatialIndexRemove(SpatialIndex*, int);
+
+int spatialIndexNearest(const SpatialIndex*, double, double, int, int[], double[]);
+
+int spatialIndexRadius(const SpatialIndex*, double, double, double, int[], int);
+
+#endif
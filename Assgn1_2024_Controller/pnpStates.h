@@ -0,0 +1,57 @@
+/*
+ *
+ * pnpStates.h - the states of the manual and autonomous state machines of the controller, with their
+ * display names and the states each may move to
+ *
+ * STATE_TABLE() is expanded by the STATE_* macros below, so the state numbers, the names and the
+ * transition masks are all generated at compile time from the one table and cannot drift apart. The state
+ * numbers are published to remote clients and monitors, new states go at the end.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPSTATES_H
+#define PNPSTATES_H
+
+#define STATE_BIT(state) (1u << (state))
+
+/* X(state number, display name of up to 19 characters, padded for aligned output, the states it may move to) */
+#define STATE_TABLE(X) \
+    X(HOME,                "HOME               ", STATE_BIT(MOVE_TO_FEEDER) | STATE_BIT(PRE_ROTATE_NOZZLES)) \
+    X(MOVE_TO_FEEDER,      "MOVE TO FEEDER     ", STATE_BIT(WAIT_1) | STATE_BIT(LOWER_HEAD_NOZZLE) | STATE_BIT(LOWER_CNTR_NOZZLE)) \
+    X(WAIT_1,              "WAIT 1             ", STATE_BIT(LOWER_CNTR_NOZZLE) | STATE_BIT(MOVE_TO_CAMERA) | STATE_BIT(CORRECT_ERRORS) | \
+                                                  STATE_BIT(MOVE_TO_HOME) | STATE_BIT(MOVE_TO_FEEDER)) \
+    X(LOWER_CNTR_NOZZLE,   "LOWER CNTR NOZZLE  ", STATE_BIT(VAC_CNTR_NOZZLE))          /* lowering the centre nozzle */ \
+    X(VAC_CNTR_NOZZLE,     "VAC CNTR NOZZLE    ", STATE_BIT(RAISE_CNTR_NOZZLE))        /* applying the vacuum for the centre nozzle */ \
+    X(RAISE_CNTR_NOZZLE,   "RAISE CNTR NOZZLE  ", STATE_BIT(WAIT_1) | STATE_BIT(HOME) | STATE_BIT(MOVE_TO_HOME) | STATE_BIT(MOVE_TO_CAMERA)) \
+    X(MOVE_TO_CAMERA,      "MOVE TO CAMERA     ", STATE_BIT(LOOK_UP_PHOTO)) \
+    X(LOOK_UP_PHOTO,       "LOOK UP PHOTO      ", STATE_BIT(MOVE_TO_PCB) | STATE_BIT(CHECK_ERROR)) \
+    X(MOVE_TO_PCB,         "MOVE TO PCB        ", STATE_BIT(LOOK_DOWN_PHOTO)) \
+    X(LOOK_DOWN_PHOTO,     "LOOK DOWN PHOTO    ", STATE_BIT(CHECK_ERROR)) \
+    X(CHECK_ERROR,         "CHECK ERROR        ", STATE_BIT(WAIT_1) | STATE_BIT(FIX_NOZZLE_ERROR) | STATE_BIT(FIX_PREPLACE_ERROR) | \
+                                                  STATE_BIT(MOVE_TO_PCB) | STATE_BIT(MOVE_TO_REJECT_BIN) | STATE_BIT(MOVE_TO_HOME) | STATE_BIT(HOME)) \
+    X(CORRECT_ERRORS,      "CORRECT ERRORS     ", STATE_BIT(WAIT_1)) \
+    X(MOVE_TO_HOME,        "MOVE TO HOME       ", STATE_BIT(HOME)) \
+    X(FIX_NOZZLE_ERROR,    "FIX NOZZLE ERROR   ", STATE_BIT(CHECK_ERROR) | STATE_BIT(MOVE_TO_PCB)) \
+    X(FIX_PREPLACE_ERROR,  "FIX PREPLACE ERROR ", STATE_BIT(LOWER_HEAD_NOZZLE) | STATE_BIT(LOWER_CNTR_NOZZLE)) \
+    X(LOWER_HEAD_NOZZLE,   "LOWER NOZZLE       ", STATE_BIT(VAC_HEAD_NOZZLE))          /* lowering the current nozzle of the head in autonomous mode */ \
+    X(VAC_HEAD_NOZZLE,     "VAC NOZZLE         ", STATE_BIT(RAISE_HEAD_NOZZLE))        /* applying or releasing the vacuum of the current nozzle */ \
+    X(RAISE_HEAD_NOZZLE,   "RAISE NOZZLE       ", STATE_BIT(MOVE_TO_FEEDER) | STATE_BIT(MOVE_TO_CAMERA) | STATE_BIT(MOVE_TO_PCB) | \
+                                                  STATE_BIT(MOVE_TO_HOME) | STATE_BIT(HOME) | STATE_BIT(FLY_BY_CAMERA)) \
+    X(MOVE_TO_REJECT_BIN,  "MOVE TO REJECT BIN ", STATE_BIT(REJECT_PART))              /* taking a part picked at an angle beyond correction to the reject bin */ \
+    X(REJECT_PART,         "REJECT PART        ", STATE_BIT(CHECK_ERROR))              /* releasing the vacuum over the reject bin */ \
+    X(FLY_BY_CAMERA,       "FLY BY CAMERA      ", STATE_BIT(CHECK_ERROR))              /* moving to the PCB over the look-up camera, which photographs the parts in flight */ \
+    X(PRE_ROTATE_NOZZLES,  "PRE-ROTATE NOZZLES ", STATE_BIT(MOVE_TO_FEEDER))           /* turning the nozzles towards the angles of their parts before a trip */
+
+#define STATE_NUMBER(number, name, next) number,
+#define STATE_NAME(number, name, next) name,
+#define STATE_TRANSITIONS(number, name, next) next,
+
+enum { STATE_TABLE(STATE_NUMBER) NUMBER_OF_STATES };
+
+/* TRUE if the state machine may move from one state to the other, or stays in the same state */
+#define IS_STATE_TRANSITION(from, to) ((from) == (to) || (state_transitions[from] & STATE_BIT(to)) != 0)
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ *
+ * pnpTeach.c - teach and replay, which records the decisions of the operator in manual mode and compiles
+ * them into a job for automatic mode
+ *
+ * Every instruction the operator issues in manual mode is appended to the teach log as a line of text as
+ * it is issued, and a line the compiler cannot read is passed over. The compiler keeps what the operator
+ * decided, the order in which the parts were placed and the feeder each was actually picked from, and drops
+ * how the head got there: the detours to a wrong feeder, the trips home and the repeated photos. The job it
+ * writes is an automatic mode centroid file, so the planner generates the motion and corrects every part
+ * from the errors it measures, without keypress waits.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpTeach.h"
+#include "pnpJournal.h"
+#include "pnpPlanner.h"
+
+#define NOT_TAUGHT -2       // the taught feeder of a part not placed in the session
+
+const char teach_event_name[NUMBER_OF_TEACH_EVENTS][8] = {"START", "MOVE", "PICK", "PHOTO", "ROTATE", "AMEND", "PLACE", "END"};
+
+/* the instructions each event issued, a pick or a place lowers the nozzle, applies or releases the vacuum and raises it */
+const int teach_event_instructions[NUMBER_OF_TEACH_EVENTS] = {0, 1, 3, 1, 1, 1, 3, 0};
+
+FILE *teach_fp = NULL;
+
+/*
+ Function: teachOpen
+ -------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: starts a new teach log for a job, any log of an earlier session is replaced
+ Argument(s):
+ const char *file_name - the teach log
+ const PlacementStore *store - the parts of the job
+ double sim_time - the simulation time the session starts
+ Return Value: 0 if the log was created, -1 if not, the session is then not recorded
+ Usage: teachOpen(TEACH_FILE, &placements, getSimulationTime());
+ */
+int teachOpen(const char *file_name, const PlacementStore *store, double sim_time)
+{
+    teach_fp = fopen(file_name, "w");
+    if (teach_fp == NULL) return -1;
+
+    fprintf(teach_fp, "# teach log, one instruction per line: sim_time event part argument_1 argument_2\n");
+    teachRecord(TEACH_START, store -> count, placementFingerprint(store), 0, sim_time);
+    return 0;
+}
+
+/*
+ Function: teachRecord
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: appends an event to the teach log, if one is open
+ Argument(s):
+ int event - one of the TEACH_... events
+ int part - the part being placed
+ double argument_1, double argument_2 - the arguments of the event, see pnpTeach.h
+ double sim_time - the simulation time of the event
+ Return Value: none
+ Usage: teachRecord(TEACH_MOVE, part_counter, x, y, getSimulationTime());
+ */
+void teachRecord(int event, int part, double argument_1, double argument_2, double sim_time)
+{
+    if (teach_fp == NULL) return;
+
+    fprintf(teach_fp, "%.3f %s %d %.10g %.10g\n", sim_time, teach_event_name[event], part, argument_1, argument_2);
+    fflush(teach_fp);
+}
+
+/*
+ Function: teachClose
+ --------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: ends the session and closes the teach log
+ Argument(s): double sim_time - the simulation time the session ends
+ Return Value: none
+ Usage: teachClose(getSimulationTime());
+ */
+void teachClose(double sim_time)
+{
+    if (teach_fp == NULL) return;
+
+    teachRecord(TEACH_END, 0, 0, 0, sim_time);
+    fclose(teach_fp);
+    teach_fp = NULL;
+}
+
+/*
+ * teachEvent - the event named in a line of the teach log, or -1 if the name is unknown
+ */
+int teachEvent(const char *name)
+{
+    for (int event = 0; event < NUMBER_OF_TEACH_EVENTS; event++) if (strcmp(name, teach_event_name[event]) == 0) return event;
+    return -1;
+}
+
+/*
+ Function: compileTeachLog
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ compiles the teach log of a manual session into an automatic mode centroid file. The parts placed in the
+ session come first, in the order they were placed and each with the feeder it was picked from, followed by
+ the parts not placed with the feeders of the centroid file. The session is compared with the job, whose
+ travel, instructions and time are the planner's estimates for the parts placed in the session.
+ Argument(s):
+ const char *log_file - the teach log
+ const PlacementStore *store - the parts of the job the session was taught on
+ const char *job_file - the centroid file to write
+ TeachSummary *summary - filled in with the session and the job
+ Return Value:
+ one of:
+ TEACH_COMPILED (0)
+ TEACH_LOG_NOT_PRESENT (-1)
+ TEACH_LOG_OF_ANOTHER_JOB (-2)
+ TEACH_NOTHING_TAUGHT (-3)
+ TEACH_JOB_NOT_WRITTEN (-4)
+ Usage: res = compileTeachLog(TEACH_FILE, &placements, TAUGHT_JOB_FILE, &summary);
+ */
+int compileTeachLog(const char *log_file, const PlacementStore *store, const char *job_file, TeachSummary *summary)
+{
+    FILE *fp = fopen(log_file, "r");
+    char line[256], name[16];
+    int event, part, started = FALSE, moved = FALSE, rotated = FALSE, amended = FALSE, res = TEACH_COMPILED;
+    int picked_feeder = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+    int *taught_feeder = NULL, *order = NULL, *component_list = NULL;
+    double sim_time, argument_1, argument_2, start_time = 0, x = machine.home_x, y = machine.home_y;
+    PlacementStore job;
+
+    memset(summary, 0, sizeof(TeachSummary));
+    if (fp == NULL) return TEACH_LOG_NOT_PRESENT;
+
+    while (res == TEACH_COMPILED && fgets(line, sizeof(line), fp) != NULL)
+    {   //a line torn by a crash or unknown to this version is passed over
+        if (line[0] == '#' || sscanf(line, "%lf %15s %d %lf %lf", &sim_time, name, &part, &argument_1, &argument_2) != 5) continue;
+        if ((event = teachEvent(name)) < 0) continue;
+
+        if (event == TEACH_START)
+        {
+            if (started || part != store -> count || (unsigned int) argument_1 != placementFingerprint(store))
+            {
+                res = TEACH_LOG_OF_ANOTHER_JOB;
+                break;
+            }
+            taught_feeder = malloc((store -> count + 1) * sizeof(int));
+            order = malloc((store -> count + 1) * sizeof(int));
+            if (taught_feeder == NULL || order == NULL) res = TEACH_JOB_NOT_WRITTEN;
+            else for (int i = 0; i < store -> count; i++) taught_feeder[i] = NOT_TAUGHT;
+            started = TRUE;
+            start_time = sim_time;
+            continue;
+        }
+        if (!started) continue;
+
+        summary -> session_instructions += teach_event_instructions[event];
+        summary -> session_time = sim_time - start_time;
+        if (event == TEACH_MOVE)
+        {   //a move followed by another move did nothing but take the head out of its way
+            if (moved) summary -> redundant_moves++;
+            summary -> session_travel += hypot(argument_1 - x, argument_2 - y);
+            x = argument_1;
+            y = argument_2;
+            moved = TRUE;
+            continue;
+        }
+        moved = FALSE;
+
+        switch (event)
+        {
+            case TEACH_PICK:
+                picked_feeder = (int) argument_1;
+                rotated = amended = FALSE;
+                break;
+
+            case TEACH_ROTATE:
+                rotated = TRUE;
+                break;
+
+            case TEACH_AMEND:
+                summary -> session_travel += hypot(argument_1, argument_2);
+                x += argument_1;
+                y += argument_2;
+                amended = TRUE;
+                break;
+
+            case TEACH_PLACE:
+                if (part < 0 || part >= store -> count || taught_feeder[part] != NOT_TAUGHT) break;
+                //a part picked away from a feeder is taken from the feeder of the centroid file
+                taught_feeder[part] = (picked_feeder >= 0 && picked_feeder < machine.number_of_feeders) ? picked_feeder : store -> feeder[part];
+                if (taught_feeder[part] != store -> feeder[part]) summary -> feeders_changed++;
+                if (!rotated || !amended) summary -> corrections_skipped++;
+                order[summary -> parts_taught++] = part;
+                picked_feeder = NO_TAPE_FEEDER_AT_THIS_LOCATION;
+                break;
+        }
+    }
+    fclose(fp);
+
+    if (res == TEACH_COMPILED && summary -> parts_taught == 0) res = started ? TEACH_NOTHING_TAUGHT : TEACH_LOG_OF_ANOTHER_JOB;
+    if (res != TEACH_COMPILED)
+    {
+        free(taught_feeder);
+        free(order);
+        return res;
+    }
+
+    /* the parts taught lead the job, and the planner's estimates are for them alone */
+    placementStoreInit(&job);
+    for (int i = 0; i < summary -> parts_taught && res == TEACH_COMPILED; i++)
+    {
+        part = order[i];
+        if (placementStoreAdd(&job, placementDesignation(store, part), placementFootprint(store, part), store -> value[part],
+                              store -> x[part], store -> y[part], store -> theta[part], taught_feeder[part]) < 0) res = TEACH_JOB_NOT_WRITTEN;
+    }
+    if (res == TEACH_COMPILED && (component_list = malloc(job.count * sizeof(int))) != NULL && planPlacements(&job, component_list) >= 0)
+    {
+        summary -> job_travel = routeLength(&job, component_list, job.count);
+        summary -> job_instructions = planInstructions(&job, component_list, job.count);
+        summary -> job_time = planCycleTime(&job, component_list, job.count);
+    }
+
+    for (int i = 0; i < store -> count && res == TEACH_COMPILED; i++)
+    {
+        if (taught_feeder[i] == NOT_TAUGHT && placementStoreAdd(&job, placementDesignation(store, i), placementFootprint(store, i), store -> value[i],
+                                                                 store -> x[i], store -> y[i], store -> theta[i], store -> feeder[i]) < 0) res = TEACH_JOB_NOT_WRITTEN;
+    }
+    if (res == TEACH_COMPILED && savePlacementStore(job_file, AUTONOMOUS_CONTROL, &job) != 0) res = TEACH_JOB_NOT_WRITTEN;
+
+    free(component_list);
+    free(taught_feeder);
+    free(order);
+    placementStoreFree(&job);
+    return res;
+}
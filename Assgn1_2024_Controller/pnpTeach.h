@@ -0,0 +1,61 @@
+/*
+ *
+ * pnpTeach.h - declarations for teach and replay, which records the decisions of the operator in manual
+ * mode and compiles them into a job for automatic mode
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPTEACH_H
+#define PNPTEACH_H
+
+#include "pnpPlacementStore.h"
+
+#define TEACH_FILE "pnp_teach_log"
+#define TAUGHT_JOB_FILE "centroid_taught.txt"
+
+/* events, each is one line of the teach log: sim_time event part argument_1 argument_2 */
+#define TEACH_START 0           // part is the number of parts, argument_1 the fingerprint of the job
+#define TEACH_MOVE 1            // the head was sent to x = argument_1, y = argument_2
+#define TEACH_PICK 2            // part picked from feeder argument_1, or NO_TAPE_FEEDER_AT_THIS_LOCATION away from a feeder
+#define TEACH_PHOTO 3           // argument_1 is PHOTO_LOOKUP or PHOTO_LOOKDOWN
+#define TEACH_ROTATE 4          // nozzle turned to theta = argument_1
+#define TEACH_AMEND 5           // head moved by x = argument_1, y = argument_2
+#define TEACH_PLACE 6           // part placed
+#define TEACH_END 7
+#define NUMBER_OF_TEACH_EVENTS 8
+
+/* compileTeachLog() return values */
+#define TEACH_COMPILED 0
+#define TEACH_LOG_NOT_PRESENT -1
+#define TEACH_LOG_OF_ANOTHER_JOB -2
+#define TEACH_NOTHING_TAUGHT -3
+#define TEACH_JOB_NOT_WRITTEN -4
+
+/* the session taught and the job compiled from it */
+typedef struct
+{
+    int parts_taught;               // parts placed in the session, which lead the job in the order they were placed
+    int feeders_changed;            // parts picked from another feeder than the one in the centroid file
+    int corrections_skipped;        // parts placed without their rotation or preplace error corrected
+    int redundant_moves;            // moves of the head followed by another move with nothing done in between
+    long session_instructions;
+    double session_travel;          // mm
+    double session_time;            // simulated seconds from the start of the session to its end
+    long job_instructions;
+    double job_travel;
+    double job_time;
+
+} TeachSummary;
+
+int teachOpen(const char*, const PlacementStore*, double);
+
+void teachRecord(int, int, double, double, double);
+
+void teachClose(double);
+
+int compileTeachLog(const char*, const PlacementStore*, const char*, TeachSummary*);
+
+#endif
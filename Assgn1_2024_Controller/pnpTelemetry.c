@@ -0,0 +1,141 @@
+/*
+ *
+ * pnpTelemetry.c - publishes the controller status, instruction counters and timing histograms in a
+ * sequence locked shared memory block for external monitors, see pnpTelemetry.h
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpTelemetry.h"
+
+TelemetryBlock *telemetry = NULL;
+int telemetry_fd = -1;
+TelemetryData telemetry_data;
+int last_parts_placed = 0;
+double last_placement_time = 0.0;
+
+/*
+ Function: telemetryOpen
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ creates and memory maps TELEMETRY_FILE in the current working directory and initializes the
+ telemetry block
+ Argument(s): none
+ Return Value:
+ 0 on success, -1 if the file could not be mapped, in which case the controller runs without telemetry
+ Usage: telemetryOpen();
+ */
+int telemetryOpen()
+{
+    telemetry_fd = open(TELEMETRY_FILE, (O_CREAT | O_RDWR), 0666);
+    if (telemetry_fd < 0 || ftruncate(telemetry_fd, sizeof(TelemetryBlock)) != 0)
+    {
+        perror("WARNING  telemetry block unavailable");
+        if (telemetry_fd >= 0) close(telemetry_fd);
+        telemetry_fd = -1;
+        return -1;
+    }
+
+    telemetry = (TelemetryBlock *)mmap(0, sizeof(TelemetryBlock), (PROT_READ | PROT_WRITE), MAP_SHARED, telemetry_fd, (off_t)0);
+    if (telemetry == MAP_FAILED)
+    {
+        perror("WARNING  telemetry block unavailable");
+        close(telemetry_fd);
+        telemetry_fd = -1;
+        telemetry = NULL;
+        return -1;
+    }
+
+    /* make the block look busy while it is reset, in case a monitor is already attached */
+    atomic_store_explicit(&telemetry -> sequence, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memset(&telemetry -> data, 0, sizeof(TelemetryData));
+    telemetry -> magic = TELEMETRY_MAGIC;
+    telemetry -> version = TELEMETRY_VERSION;
+    telemetry -> size = sizeof(TelemetryBlock);
+    atomic_store_explicit(&telemetry -> sequence, 2, memory_order_release);
+    return 0;
+}
+
+/*
+ Function: telemetryClose
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: unmaps the telemetry block, the file is left behind so monitors can read the final values
+ Argument(s): none
+ Return Value: none
+ Usage: telemetryClose();
+ */
+void telemetryClose()
+{
+    if (telemetry == NULL) return;
+
+    munmap(telemetry, sizeof(TelemetryBlock));
+    close(telemetry_fd);
+    telemetry = NULL;
+    telemetry_fd = -1;
+}
+
+/*
+ Function: telemetryPublish
+ --------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ updates the cumulative counters and publishes a new telemetry snapshot, called once per control
+ loop iteration. The update is a single copy inside the sequence lock and never waits for readers.
+ Argument(s):
+ const ControllerStatus *status - the latest controller status
+ Return Value: none
+ Usage: telemetryPublish(&status);
+ */
+void telemetryPublish(const ControllerStatus *status)
+{
+    TelemetryData *d = &telemetry_data;
+    const InstructionStatistics *statistics = getInstructionStatistics();
+
+    if (telemetry == NULL) return;
+
+    /* count placements, parts_placed restarts from 0 when a new job is loaded */
+    if (status -> parts_placed > last_parts_placed)
+    {
+        d -> total_parts_placed += status -> parts_placed - last_parts_placed;
+        if (last_parts_placed > 0) d -> placement_interval_histogram[histogramBin(1000.0 * (status -> sim_time - last_placement_time))]++;
+        last_placement_time = status -> sim_time;
+    }
+    last_parts_placed = status -> parts_placed;
+
+    d -> publish_count++;
+    d -> sim_time = status -> sim_time;
+    d -> job_start_time = status -> job_start_time;
+    d -> operation_mode = status -> operation_mode;
+    d -> state = status -> state;
+    snprintf(d -> state_name, TELEMETRY_STATE_NAME_LENGTH, "%s", status -> state_name ? status -> state_name : "");
+    d -> paused = status -> paused;
+    d -> part_counter = status -> part_counter;
+    d -> parts_placed = status -> parts_placed;
+    d -> number_of_components_to_place = status -> number_of_components_to_place;
+    d -> number_of_nozzles = status -> number_of_nozzles;
+    for (int n = 0; n < status -> number_of_nozzles; n++)
+    {
+        d -> nozzle_status[n] = status -> nozzle_status[n];
+        d -> nozzle_part[n] = status -> nozzle_part[n];
+        d -> theta_pick_error[n] = status -> theta_pick_error[n];
+    }
+    d -> x_preplace_error = status -> x_preplace_error;
+    d -> y_preplace_error = status -> y_preplace_error;
+    memcpy(d -> instructions_issued, statistics -> issued, sizeof(d -> instructions_issued));
+    d -> instructions_completed = statistics -> completed;
+    memcpy(d -> instruction_latency_histogram, statistics -> latency_histogram, sizeof(d -> instruction_latency_histogram));
+
+    unsigned int sequence = atomic_load_explicit(&telemetry -> sequence, memory_order_relaxed);
+    atomic_store_explicit(&telemetry -> sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&telemetry -> data, d, sizeof(TelemetryData));
+    atomic_store_explicit(&telemetry -> sequence, sequence + 2, memory_order_release);
+}
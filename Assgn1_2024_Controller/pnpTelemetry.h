@@ -0,0 +1,103 @@
+/*
+ *
+ * pnpTelemetry.h - declarations for the telemetry block that the pick and place machine controller
+ * publishes in shared memory for external monitors
+ *
+ * The block lives in its own memory mapped file, TELEMETRY_FILE, and is protected by a sequence lock:
+ * the controller makes the sequence number odd while it updates the data and even again when it is
+ * done, and never waits for readers. Readers copy the data and retry if the sequence number was odd
+ * or changed during the copy, see readTelemetry(). Any number of readers can sample the block at any
+ * rate without affecting the controller.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPTELEMETRY_H
+#define PNPTELEMETRY_H
+
+#include <stdatomic.h>
+#include "pnpControl.h"
+
+#define TELEMETRY_FILE "pnp_telemetry_file"
+#define TELEMETRY_MAGIC 0x544e5050      // "PPNT"
+#define TELEMETRY_VERSION 4
+#define TELEMETRY_STATE_NAME_LENGTH 20
+
+#define TELEMETRY_READ_RETRIES 1000     // readTelemetry() gives up after this many torn reads
+
+typedef struct
+{
+    unsigned long long publish_count;
+    double sim_time;
+    double job_start_time;
+    int operation_mode;
+    int state;
+    char state_name[TELEMETRY_STATE_NAME_LENGTH];
+    int paused;
+    int part_counter;
+    int parts_placed;
+    int number_of_components_to_place;
+    int number_of_nozzles;
+    int nozzle_status[MAX_NUMBER_OF_NOZZLES];
+    int nozzle_part[MAX_NUMBER_OF_NOZZLES];
+    double theta_pick_error[MAX_NUMBER_OF_NOZZLES];
+    double x_preplace_error;
+    double y_preplace_error;
+
+    /* cumulative over every job since the controller started */
+    unsigned long long total_parts_placed;
+    unsigned long long instructions_issued[NUMBER_OF_INSTRUCTION_TYPES];
+    unsigned long long instructions_completed;
+    unsigned long long instruction_latency_histogram[LATENCY_HISTOGRAM_BINS];  // wall time from issue until ready, in microseconds
+    unsigned long long placement_interval_histogram[LATENCY_HISTOGRAM_BINS];   // simulation time between placements, in milliseconds
+
+} TelemetryData;
+
+typedef struct
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int size;                  // sizeof(TelemetryBlock), so readers can check they match the controller
+    _Atomic unsigned int sequence;      // odd while the controller is updating data
+    TelemetryData data;
+
+} TelemetryBlock;
+
+int telemetryOpen();
+
+void telemetryClose();
+
+void telemetryPublish(const ControllerStatus*);
+
+/*
+ Function: readTelemetry
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ takes a consistent copy of the telemetry data, defined here so that monitors only need this header
+ Argument(s):
+ const TelemetryBlock *block - the mapped telemetry block
+ TelemetryData *data - filled in with the copy
+ Return Value:
+ the number of torn reads that were retried, or -1 if no consistent copy could be taken
+ Usage: int retries = readTelemetry(block, &data);
+ */
+static inline int readTelemetry(const TelemetryBlock *block, TelemetryData *data)
+{
+    for (int retries = 0; retries < TELEMETRY_READ_RETRIES; retries++)
+    {
+        unsigned int before = atomic_load_explicit(&block -> sequence, memory_order_acquire);
+        if (before & 1) continue;
+
+        memcpy(data, &block -> data, sizeof(TelemetryData));
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&block -> sequence, memory_order_relaxed) == before) return retries;
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ *
+ * pnpTrip.c - the automatic mode job written as coroutines, selected with -c, which runs on the coroutine
+ * runtime of pnpCoroutine.c rather than the autonomous state machine
+ *
+ * A trip reads as the machine carries it out: pick a part with each nozzle, photograph them at the look-up
+ * camera, correct each nozzle, drop any part beyond correction in the reject bin, and place the parts in the
+ * order with the least travel. The check and correction of each nozzle is a coroutine of its own, so the
+ * nozzles are corrected side by side and their rotations take turns at the simulator. The picks are checked
+ * and recovered as in the state machine, see pnpRecovery.c, but the job is not journalled, takes no remote
+ * commands and publishes no status, and the gang picks, fly-by camera and pre-rotation of the state machine
+ * are not used.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "pnpTrip.h"
+#include "pnpPlanner.h"
+#include "pnpPeephole.h"
+
+#if MAX_COROUTINES <= MAX_NUMBER_OF_NOZZLES
+#error the job and the correction of every nozzle must fit in MAX_COROUTINES
+#endif
+
+typedef struct TripJob TripJob;
+
+/* the check and correction of one nozzle after the look-up photo */
+typedef struct
+{
+    Coroutine co;
+    TripJob *job;
+    int nozzle;
+
+} NozzleFlow;
+
+/* what the job keeps across waits */
+struct TripJob
+{
+    Coroutine co;
+    PlacementStore *store;
+    int *component_list;                            // the parts in pick order, a part picked again is put back before part_counter
+    int count, part_counter, placed;
+    RecoveryState recovery;
+    int nozzle, feeder, step, place_count;
+    int correcting;                                 // the nozzles whose correction is still running, see NOZZLE_MASK()
+    int nozzle_part[MAX_NUMBER_OF_NOZZLES], place_sequence[MAX_NUMBER_OF_NOZZLES];
+    char nozzle_loaded[MAX_NUMBER_OF_NOZZLES], nozzle_reject[MAX_NUMBER_OF_NOZZLES];
+    double requested_theta[MAX_NUMBER_OF_NOZZLES];  // the turn which corrects the part on each nozzle
+    double nozzle_theta[MAX_NUMBER_OF_NOZZLES];     // the angle of each nozzle since the last look-up photo, see resetNozzleAngles()
+    double sequence_saving;                         // travel saved by the placement order of each trip over placing in pick order
+    NozzleFlow flow[MAX_NUMBER_OF_NOZZLES];
+};
+
+/*
+ Function: correctNozzle
+ -----------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ the coroutine which checks the pick of a nozzle from the look-up photo and turns the nozzle to correct the
+ angle of its part. A failed pick is recorded and its part picked again or skipped, and a part at an angle
+ beyond correction is marked for the reject bin.
+ Argument(s): Coroutine *co - the coroutine, whose context is its NozzleFlow
+ Return Value: CO_WAITING, or CO_DONE once the nozzle is corrected
+ Usage: coSpawn(co -> scheduler, &job -> flow[n].co, correctNozzle, &job -> flow[n]);
+ */
+int correctNozzle(Coroutine *co)
+{
+    NozzleFlow *flow = co -> context;
+    TripJob *job = flow -> job;
+    int n = flow -> nozzle, part = job -> nozzle_part[n], pick;
+
+    CO_BEGIN(co);
+    pick = checkPick(getPickStatus(n), getPickErrorTheta(n));
+    recordPick(&job -> recovery, job -> store -> feeder[part], pick);
+    if (pick == PICK_OK)
+    {
+        //the nozzle is sent the shortest way round, the look-up photo has reset its angle
+        job -> requested_theta[n] = shortestTurn(job -> nozzle_theta[n], job -> store -> theta[part] - getPickErrorTheta(n));
+        job -> nozzle_theta[n] += job -> requested_theta[n];
+        printf("Time: %7.2f  Part %d on nozzle %d misalignment error: %3.2f  Correction required: %3.2f degrees\n", getSimulationTime(), part, n,
+               getPickErrorTheta(n), job -> requested_theta[n]);
+        CO_INSTRUCTION(co, rotateNozzle(n, job -> requested_theta[n]));
+    }
+    else
+    {   //the rest of the trip carries on without the part
+        job -> nozzle_loaded[n] = FALSE;
+        job -> nozzle_reject[n] = pick == PICK_OUT_OF_RANGE;
+        if (pick == PICK_MISSED) printf("Time: %7.2f  Part %d missing from nozzle %d, mis-pick from feeder %d\n", getSimulationTime(), part, n, job -> store -> feeder[part]);
+        else printf("Time: %7.2f  Part %d on nozzle %d misalignment error: %3.2f is beyond correction, rejecting it\n", getSimulationTime(), part, n, getPickErrorTheta(n));
+        if (recoverPart(&job -> recovery, job -> store, part) == RECOVERY_REQUEUE)
+        {
+            job -> component_list[--job -> part_counter] = part;
+            printf("Time: %7.2f  Part %d will be picked again from feeder %d\n", getSimulationTime(), part, job -> store -> feeder[part]);
+        }
+        else printf("Time: %7.2f  Part %d failed %d picks, skipping it\n", getSimulationTime(), part, RECOVERY_MAX_ATTEMPTS);
+    }
+    job -> correcting &= ~NOZZLE_MASK(n);
+    CO_END(co);
+}
+
+/*
+ Function: placeJob
+ ------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose: the coroutine which places every part of the job, trip by trip, and returns the head home
+ Argument(s): Coroutine *co - the coroutine, whose context is its TripJob
+ Return Value: CO_WAITING, or CO_DONE once the head is home after the last trip
+ Usage: coSpawn(&scheduler, &job -> co, placeJob, job);
+ */
+int placeJob(Coroutine *co)
+{
+    TripJob *job = co -> context;
+    PlacementStore *store = job -> store;
+    double next_x, next_y, trip_travel, pick_order_travel;
+
+    CO_BEGIN(co);
+    while (job -> part_counter < job -> count)
+    {
+        /* pick a part with each nozzle in turn from the left */
+        for (job -> nozzle = 0; job -> nozzle < HEAD_NOZZLES && job -> part_counter < job -> count; job -> nozzle++)
+        {
+            job -> nozzle_part[job -> nozzle] = job -> component_list[job -> part_counter++];
+            job -> feeder = store -> feeder[job -> nozzle_part[job -> nozzle]];
+            CO_INSTRUCTION(co, setTargetPos(machine.pick_x[job -> nozzle][job -> feeder], machine.pick_y[job -> nozzle][job -> feeder]));
+            CO_INSTRUCTION(co, lowerNozzle(job -> nozzle));
+            CO_INSTRUCTION(co, applyVacuum(job -> nozzle));
+            CO_INSTRUCTION(co, raiseNozzle(job -> nozzle));
+            job -> nozzle_loaded[job -> nozzle] = TRUE;
+            printf("Time: %7.2f  Part %d picked from feeder %d by nozzle %d\n", getSimulationTime(), job -> nozzle_part[job -> nozzle], job -> feeder, job -> nozzle);
+        }
+
+        /* photograph the parts, then check and correct the nozzles side by side, the last to pick first */
+        CO_INSTRUCTION(co, setTargetPos(machine.camera_x, machine.camera_y));
+        CO_INSTRUCTION(co, takePhoto(PHOTO_LOOKUP));
+        resetNozzleAngles(job -> nozzle_theta);
+        for (int n = HEAD_NOZZLES - 1; n >= 0; n--)
+        {
+            if (!job -> nozzle_loaded[n]) continue;
+            job -> flow[n].job = job;
+            job -> flow[n].nozzle = n;
+            job -> correcting |= NOZZLE_MASK(n);
+            coSpawn(co -> scheduler, &job -> flow[n].co, correctNozzle, &job -> flow[n]);
+        }
+        CO_WAIT_UNTIL(co, job -> correcting == 0);
+
+        for (job -> nozzle = 0; job -> nozzle < HEAD_NOZZLES; job -> nozzle++)
+        {   //the part falls into the bin when the vacuum is released
+            if (!job -> nozzle_reject[job -> nozzle]) continue;
+            CO_INSTRUCTION(co, setTargetPos(machine.reject_x - machine.nozzle_x[job -> nozzle], machine.reject_y));
+            CO_INSTRUCTION(co, releaseVacuum(job -> nozzle));
+            job -> nozzle_reject[job -> nozzle] = FALSE;
+            printf("Time: %7.2f  Part on nozzle %d dropped in the reject bin\n", getSimulationTime(), job -> nozzle);
+        }
+
+        /* place the parts in the order with the least travel to the first pick of the next trip, or home */
+        next_x = job -> part_counter < job -> count ? machine.pick_x[0][store -> feeder[job -> component_list[job -> part_counter]]] : machine.home_x;
+        next_y = job -> part_counter < job -> count ? machine.pick_y[0][store -> feeder[job -> component_list[job -> part_counter]]] : machine.home_y;
+        job -> place_count = sequencePlacements(store, job -> nozzle_loaded, job -> nozzle_part, next_x, next_y, job -> place_sequence, &trip_travel, &pick_order_travel);
+        job -> sequence_saving += pick_order_travel - trip_travel;
+        for (job -> step = 0; job -> step < job -> place_count; job -> step++)
+        {
+            job -> nozzle = job -> place_sequence[job -> step];
+            CO_INSTRUCTION(co, setTargetPos(store -> x[job -> nozzle_part[job -> nozzle]] - machine.nozzle_x[job -> nozzle], store -> y[job -> nozzle_part[job -> nozzle]]));
+            CO_INSTRUCTION(co, takePhoto(PHOTO_LOOKDOWN));
+            CO_INSTRUCTION(co, amendPos(-getPreplaceErrorX(), -getPreplaceErrorY()));
+            CO_INSTRUCTION(co, lowerNozzle(job -> nozzle));
+            CO_INSTRUCTION(co, releaseVacuum(job -> nozzle));
+            CO_INSTRUCTION(co, raiseNozzle(job -> nozzle));
+            job -> nozzle_loaded[job -> nozzle] = FALSE;
+            job -> placed++;
+            printf("Time: %7.2f  Part %d placed on PCB by nozzle %d\n", getSimulationTime(), job -> nozzle_part[job -> nozzle], job -> nozzle);
+        }
+    }
+    CO_INSTRUCTION(co, setTargetPos(machine.home_x, machine.home_y));
+    CO_END(co);
+}
+
+/*
+ * tripJobFree - frees a job and what it holds, job may be NULL
+ */
+void tripJobFree(TripJob *job)
+{
+    if (job == NULL) return;
+    free(job -> component_list);
+    recoveryFree(&job -> recovery);
+    free(job);
+}
+
+/*
+ Function: placeJobWithCoroutines
+ --------------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ plans and places an automatic mode job with the coroutines of this file, then waits for q, unless
+ quit_when_finished is set
+ Argument(s):
+ PlacementStore *store - the parts of the job, the feeder of a part may be changed by pick recovery
+ int quit_when_finished - TRUE to quit once the job is placed
+ Return Value:
+ one of:
+ TRIP_JOB_PLACED (0)
+ TRIP_JOB_INTERRUPTED (-1)
+ TRIP_NOT_ENOUGH_MEMORY (-2)
+ Usage: res = placeJobWithCoroutines(&placements, quit_when_finished);
+ */
+int placeJobWithCoroutines(PlacementStore *store, int quit_when_finished)
+{
+    TripJob *job = calloc(1, sizeof(TripJob));
+    CoScheduler scheduler;
+    int res;
+
+    if (job == NULL || (job -> component_list = calloc(store -> count + 1, sizeof(int))) == NULL ||
+        planPlacements(store, job -> component_list) < 0 || recoveryInit(&job -> recovery, store -> count) != 0)
+    {
+        tripJobFree(job);
+        return TRIP_NOT_ENOUGH_MEMORY;
+    }
+    job -> store = store;
+    job -> count = store -> count;
+    printf("Time: %7.2f  Placing %d parts with the coroutine runtime, planned gantry travel %.0f mm, %ld instructions\n\n", getSimulationTime(), job -> count,
+           routeLength(store, job -> component_list, job -> count), planInstructions(store, job -> component_list, job -> count));
+
+    coSchedulerInit(&scheduler);
+    coSpawn(&scheduler, &job -> co, placeJob, job);
+    res = coRun(&scheduler) == 0 ? TRIP_JOB_PLACED : TRIP_JOB_INTERRUPTED;
+    if (res == TRIP_JOB_PLACED)
+    {
+        printf("\nTime: %7.2f  Placed %d of %d parts, placement sequencing saved %.0f mm of travel over pick order. Press q to quit.\n",
+               getSimulationTime(), job -> placed, job -> count, job -> sequence_saving);
+        printFeederStatistics(&job -> recovery);
+        printPeepholeStatistics(getPeepholeStatistics(), getInstructionStatistics());
+        if (quit_when_finished) setPnPSimulationQuitFlag();
+        while (!isPnPSimulationQuitFlagOn())
+        {
+            getKey();
+            waitForEvent(1000 / POLL_LOOP_RATE);
+        }
+    }
+    tripJobFree(job);
+    return res;
+}
@@ -0,0 +1,25 @@
+/*
+ *
+ * pnpTrip.h - declarations for the automatic mode job written as coroutines, which runs on the coroutine
+ * runtime of pnpCoroutine.h rather than the autonomous state machine
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#ifndef PNPTRIP_H
+#define PNPTRIP_H
+
+#include "pnpCoroutine.h"
+#include "pnpPlacementStore.h"
+#include "pnpRecovery.h"
+
+/* placeJobWithCoroutines() return values */
+#define TRIP_JOB_PLACED 0
+#define TRIP_JOB_INTERRUPTED -1        // the controller quit before the job was placed
+#define TRIP_NOT_ENOUGH_MEMORY -2
+
+int placeJobWithCoroutines(PlacementStore*, int);
+
+#endif
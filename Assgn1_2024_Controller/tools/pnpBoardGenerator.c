@@ -0,0 +1,326 @@
+/*
+ *
+ * pnpBoardGenerator.c - generates synthetic centroid files of any size, for benchmarking the parser, the
+ * planner and the controller end to end on boards of production scale
+ *
+ * Usage:
+ *   pnpBoardGenerator [-n parts] [-o centroid_file] [-s seed] [-M] [-m machine_profile] [-w x0,y0,x1,y1]
+ *                     [-c clusters] [-r cluster_radius_mm] [-u uniform_percent] [-F footprint:weight,...]
+ *                     [-k feeder_skew] [-a ortho|uniform|zero] [-j rotation_jitter_degrees]
+ *
+ * A board of parts (100) is written to centroid_file (GENERATED_CENTROID_FILE) in the format read by
+ * getCentroidFileContents() and loadPlacementStore(), for automatic mode unless -M is given. The same seed (1)
+ * and options always give the same file, on every platform, as the generator has its own random numbers.
+ *   - placement: the parts lie in the board area (100,100 to 500,500 mm). uniform_percent (10) of them are spread
+ *     evenly over it, the rest in clusters (8) around random centres, normally distributed with a standard
+ *     deviation of cluster_radius_mm (15), as parts gather round the ICs they support. -c 0 spreads every part.
+ *   - feeders: every feeder of the machine profile, MACHINE_PROFILE_FILE unless -m is given, is loaded with a
+ *     part type, a footprint drawn from the footprint weights and a value drawn for the footprint. Feeder
+ *     popularity follows Zipf's law with exponent feeder_skew (1): the k-th most popular feeder, in an order
+ *     drawn from the seed, supplies parts in proportion to 1 / k^feeder_skew, and -k 0 uses the feeders equally.
+ *   - rotation: "ortho" gives 0, 90, 180 and -90 degrees with decreasing frequency, "uniform" any angle and
+ *     "zero" none, plus normally distributed jitter of rotation_jitter_degrees (0).
+ * A summary of the board is printed.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpMachineProfile.h"
+#include "../pnpPlacementStore.h"
+
+#define GENERATED_CENTROID_FILE "centroid_generated.txt"
+#define GENERATOR_MAX_FOOTPRINTS 32
+#define GENERATOR_DEFAULT_FOOTPRINTS "0402:30,0603:25,0805:15,1206:5,SOT23:10,SOIC8:8,QFP:4,TQFP44:3"
+
+#define ROTATION_ORTHO 0
+#define ROTATION_UNIFORM 1
+#define ROTATION_ZERO 2
+
+/* the designation prefix and values of the part types of each footprint, matched by the start of the footprint */
+typedef struct
+{
+    const char *footprint;
+    const char *prefix;
+    double min_value, max_value;    // values are drawn from the E12 series between these, or 0 if both are 0
+
+} FootprintKind;
+
+const FootprintKind footprint_kind[] = {
+    {"04", "C", 1e-12, 1e-6}, {"06", "R", 1, 1e6}, {"08", "R", 1, 1e6}, {"12", "C", 1e-9, 1e-5},
+    {"SOT", "Q", 0, 0}, {"SOD", "D", 0, 0}, {"", "U", 0, 0}};
+
+const double e12[12] = {1.0, 1.2, 1.5, 1.8, 2.2, 2.7, 3.3, 3.9, 4.7, 5.6, 6.8, 8.2};
+
+typedef struct
+{
+    char footprint[PLACEMENT_STORE_MAX_NAME_LENGTH + 1];
+    double weight;
+
+} FootprintWeight;
+
+unsigned long long random_state;
+
+/*
+ * nextRandom - the next number of a splitmix64 generator, uniformRandom and normalRandom derive from it
+ */
+unsigned long long nextRandom()
+{
+    unsigned long long z = (random_state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+double uniformRandom()
+{
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double normalRandom()
+{
+    double u = uniformRandom();
+
+    while (u <= 0.0) u = uniformRandom();
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * uniformRandom());
+}
+
+/*
+ Function: drawWeighted
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: draws an index with probability in proportion to its cumulative weight, by binary search
+ Argument(s):
+ const double cumulative[] - the running total of the weights, the last is the total
+ int n - the number of weights
+ Return Value: the index, 0 to n - 1
+ Usage: int f = drawWeighted(feeder_cumulative, machine.number_of_feeders);
+ */
+int drawWeighted(const double cumulative[], int n)
+{
+    double target = uniformRandom() * cumulative[n - 1];
+    int low = 0, high = n - 1;
+
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (cumulative[middle] > target) high = middle;
+        else low = middle + 1;
+    }
+    return low;
+}
+
+/*
+ Function: parseFootprints
+ -------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads a list of footprints and their weights, e.g. "0402:30,SOIC8:5"
+ Argument(s):
+ const char *list - the list
+ FootprintWeight footprints[] - filled in, GENERATOR_MAX_FOOTPRINTS at most
+ Return Value: the number of footprints, or -1 if the list is not valid
+ Usage: int n = parseFootprints(GENERATOR_DEFAULT_FOOTPRINTS, footprints);
+ */
+int parseFootprints(const char *list, FootprintWeight footprints[])
+{
+    int n = 0, length;
+
+    while (*list != '\0')
+    {
+        if (n == GENERATOR_MAX_FOOTPRINTS) return -1;
+        length = 0;
+        if (sscanf(list, "%*[^:,]%n", &length) != 0 || length < 1 || length > PLACEMENT_STORE_MAX_NAME_LENGTH) return -1;
+        memcpy(footprints[n].footprint, list, length);
+        footprints[n].footprint[length] = '\0';
+        list += length;
+        if (*list++ != ':' || sscanf(list, "%lf%n", &footprints[n].weight, &length) != 1 || footprints[n].weight < 0) return -1;
+        list += length;
+        if (*list == ',') list++;
+        else if (*list != '\0') return -1;
+        n++;
+    }
+    return n;
+}
+
+/*
+ Function: footprintKind
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: finds the kind of part a footprint is, from the start of its name
+ Argument(s): const char *footprint - the footprint
+ Return Value: the kind, the last kind (ICs) if no other matches
+ Usage: const FootprintKind *kind = footprintKind("0603");
+ */
+const FootprintKind *footprintKind(const char *footprint)
+{
+    const FootprintKind *kind = footprint_kind;
+
+    while (strncmp(footprint, kind -> footprint, strlen(kind -> footprint)) != 0) kind++;
+    return kind;
+}
+
+/*
+ Function: drawRotation
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: draws the rotation of a part
+ Argument(s):
+ int distribution - ROTATION_ORTHO, ROTATION_UNIFORM or ROTATION_ZERO
+ double jitter - the standard deviation of the jitter added, in degrees
+ Return Value: the rotation, from -180 to 180 degrees
+ Usage: double theta = drawRotation(ROTATION_ORTHO, 0.5);
+ */
+double drawRotation(int distribution, double jitter)
+{
+    double theta = 0.0, u = uniformRandom();
+
+    if (distribution == ROTATION_ORTHO) theta = u < 0.6 ? 0.0 : u < 0.85 ? 90.0 : u < 0.95 ? 180.0 : -90.0;
+    else if (distribution == ROTATION_UNIFORM) theta = 360.0 * u - 180.0;
+    if (jitter > 0) theta += jitter * normalRandom();
+    while (theta > 180.0) theta -= 360.0;
+    while (theta < -180.0) theta += 360.0;
+    return theta;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = GENERATED_CENTROID_FILE, *profile = MACHINE_PROFILE_FILE, *footprint_list = GENERATOR_DEFAULT_FOOTPRINTS;
+    long parts = 100;
+    int clusters = 8, rotation = ROTATION_ORTHO, manual = FALSE, number_of_footprints;
+    double x0 = 100, y0 = 100, x1 = 500, y1 = 500, cluster_radius = 15, uniform_percent = 10, skew = 1.0, jitter = 0;
+    unsigned long long seed = 1;
+    FootprintWeight footprints[GENERATOR_MAX_FOOTPRINTS];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) parts = atol(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) output = argv[++i];
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-M") == 0) manual = TRUE;
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) profile = argv[++i];
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc && sscanf(argv[++i], "%lf,%lf,%lf,%lf", &x0, &y0, &x1, &y1) == 4);
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) clusters = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) cluster_radius = atof(argv[++i]);
+        else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) uniform_percent = atof(argv[++i]);
+        else if (strcmp(argv[i], "-F") == 0 && i + 1 < argc) footprint_list = argv[++i];
+        else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) skew = atof(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) jitter = atof(argv[++i]);
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc && strcmp(argv[i + 1], "ortho") == 0) {rotation = ROTATION_ORTHO; i++;}
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc && strcmp(argv[i + 1], "uniform") == 0) {rotation = ROTATION_UNIFORM; i++;}
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc && strcmp(argv[i + 1], "zero") == 0) {rotation = ROTATION_ZERO; i++;}
+        else
+        {
+            printf("usage: %s [-n parts] [-o centroid_file] [-s seed] [-M] [-m machine_profile] [-w x0,y0,x1,y1]\n"
+                   "          [-c clusters] [-r cluster_radius_mm] [-u uniform_percent] [-F footprint:weight,...]\n"
+                   "          [-k feeder_skew] [-a ortho|uniform|zero] [-j rotation_jitter_degrees]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((number_of_footprints = parseFootprints(footprint_list, footprints)) <= 0)
+    {
+        printf("footprints must be a list of footprint:weight, at most %d\n", GENERATOR_MAX_FOOTPRINTS);
+        return 1;
+    }
+    if (parts < 1 || parts > PLACEMENT_STORE_MAX_COMPONENTS || clusters < 0 || cluster_radius < 0 || uniform_percent < 0 ||
+        uniform_percent > 100 || skew < 0 || jitter < 0 || x1 <= x0 || y1 <= y0) return 1;
+
+    if (loadMachineProfile(profile, &machine) == MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE) return 2;
+    random_state = seed;
+
+    /* load the feeders, then rank them by popularity in an order drawn from the seed */
+    double footprint_cumulative[GENERATOR_MAX_FOOTPRINTS], feeder_cumulative[MAX_NUMBER_OF_FEEDERS], total = 0;
+    int feeder_footprint[MAX_NUMBER_OF_FEEDERS], rank[MAX_NUMBER_OF_FEEDERS];
+    double feeder_value[MAX_NUMBER_OF_FEEDERS];
+
+    for (int t = 0; t < number_of_footprints; t++) footprint_cumulative[t] = (total += footprints[t].weight);
+    if (total <= 0) {printf("the footprint weights must not all be zero\n"); return 1;}
+    for (int f = 0; f < machine.number_of_feeders; f++)
+    {
+        const FootprintKind *kind;
+
+        feeder_footprint[f] = drawWeighted(footprint_cumulative, number_of_footprints);
+        kind = footprintKind(footprints[feeder_footprint[f]].footprint);
+        feeder_value[f] = 0;
+        if (kind -> max_value > 0)
+        {
+            int decades = (int) round(log10(kind -> max_value / kind -> min_value));
+            feeder_value[f] = kind -> min_value * pow(10, nextRandom() % (decades + 1)) * e12[nextRandom() % 12];
+        }
+        rank[f] = f;
+    }
+    for (int f = machine.number_of_feeders - 1; f > 0; f--)
+    {
+        int g = nextRandom() % (f + 1), swap = rank[f];
+        rank[f] = rank[g];
+        rank[g] = swap;
+    }
+    total = 0;
+    for (int f = 0; f < machine.number_of_feeders; f++) feeder_cumulative[f] = (total += pow(rank[f] + 1, -skew));
+
+    /* the cluster centres keep clear of the edges by one radius where the board allows it */
+    double (*centre)[2] = malloc((clusters ? clusters : 1) * sizeof(*centre));
+    double margin_x = fmin(cluster_radius, (x1 - x0) / 4), margin_y = fmin(cluster_radius, (y1 - y0) / 4);
+    if (centre == NULL) return 2;
+    for (int c = 0; c < clusters; c++)
+    {
+        centre[c][0] = x0 + margin_x + (x1 - x0 - 2 * margin_x) * uniformRandom();
+        centre[c][1] = y0 + margin_y + (y1 - y0 - 2 * margin_y) * uniformRandom();
+    }
+
+    FILE *fp = fopen(output, "w");
+    if (fp == NULL)
+    {
+        perror("creation of centroid file failed");
+        return 2;
+    }
+    fprintf(fp, "%c\n%ld\n", manual ? 'M' : 'A', parts);
+
+    long clustered = 0, from_feeder[MAX_NUMBER_OF_FEEDERS] = {0}, prefix_count[26] = {0};    // designations are numbered per prefix letter
+    for (long i = 0; i < parts; i++)
+    {
+        int f = drawWeighted(feeder_cumulative, machine.number_of_feeders);
+        const char *footprint = footprints[feeder_footprint[f]].footprint;
+        const FootprintKind *kind = footprintKind(footprint);
+        double x, y;
+
+        if (clusters > 0 && 100 * uniformRandom() >= uniform_percent)
+        {   /* redraw the few parts that fall off the board */
+            int c = nextRandom() % clusters;
+            do
+            {
+                x = centre[c][0] + cluster_radius * normalRandom();
+                y = centre[c][1] + cluster_radius * normalRandom();
+            }
+            while (x < x0 || x > x1 || y < y0 || y > y1);
+            clustered++;
+        }
+        else
+        {
+            x = x0 + (x1 - x0) * uniformRandom();
+            y = y0 + (y1 - y0) * uniformRandom();
+        }
+        fprintf(fp, "%s%ld\t%s\t%g\t%.2f\t%.2f\t%.2f\t%d\n", kind -> prefix, ++prefix_count[kind -> prefix[0] - 'A'], footprint,
+                feeder_value[f], x, y, drawRotation(rotation, jitter), f);
+        from_feeder[f]++;
+    }
+    free(centre);
+    if (fclose(fp) != 0)
+    {
+        perror("writing of centroid file failed");
+        return 2;
+    }
+
+    printf("%ld parts written to %s for %s mode, seed %llu\n", parts, output, manual ? "manual" : "automatic", seed);
+    printf("%ld in %d clusters of radius %.1f mm, %ld spread over %.0f,%.0f to %.0f,%.0f\n", clustered, clusters, cluster_radius,
+           parts - clustered, x0, y0, x1, y1);
+    printf("Feeder  Footprint  Value        Parts\n");
+    for (int f = 0; f < machine.number_of_feeders; f++)
+        printf("%6d  %-9s  %-10g  %6ld\n", f, footprints[feeder_footprint[f]].footprint, feeder_value[f], from_feeder[f]);
+    return 0;
+}
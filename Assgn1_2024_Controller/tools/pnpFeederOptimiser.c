@@ -0,0 +1,125 @@
+/*
+ *
+ * pnpFeederOptimiser.c - proposes which feeder each part type of a job is loaded into, and writes the
+ * centroid file with the proposed feeders
+ *
+ * Usage:
+ *   pnpFeederOptimiser [-i centroid_file] [-o remapped_centroid_file] [-p swap_passes] [-m machine_profile]
+ *
+ * The proposal and the predicted saving in gantry travel are printed. The remapped centroid file is only
+ * written if -o is given, the parts keep their centroid file order. The feeders are those of the machine
+ * profile, MACHINE_PROFILE_FILE unless -m is given, or the default feeders if there is no profile.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpFeederAssignment.h"
+
+/*
+ Function: writeCentroidFile
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes a centroid file with the feeder of each part replaced
+ Argument(s):
+ const char *file_name - the file to write
+ int operation_mode - MANUAL_CONTROL or AUTONOMOUS_CONTROL
+ const PlacementStore *store - the parts
+ const int feeder[] - the feeder of each part
+ Return Value: 0 on success, -1 if the file could not be written
+ Usage: writeCentroidFile("centroid_remapped.txt", operation_mode, &store, remapped_feeder);
+ */
+int writeCentroidFile(const char *file_name, int operation_mode, const PlacementStore *store, const int feeder[])
+{
+    FILE *fp = fopen(file_name, "w");
+
+    if (fp == NULL) return -1;
+    fprintf(fp, "%c\n%d\n", operation_mode == MANUAL_CONTROL ? 'M' : 'A', store -> count);
+    for (int i = 0; i < store -> count; i++)
+    {
+        fprintf(fp, "%s\t%s\t%.10g\t%.10g\t%.10g\t%.10g\t%d\n", placementDesignation(store, i), placementFootprint(store, i),
+                store -> value[i], store -> x[i], store -> y[i], store -> theta[i], feeder[i]);
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *input = CENTROID_FILE, *output = NULL, *profile = MACHINE_PROFILE_FILE;
+    int swap_passes = 10, operation_mode, res;
+    PlacementStore store;
+    FeederAssignment assignment;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) input = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) output = argv[++i];
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) swap_passes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) profile = argv[++i];
+        else
+        {
+            printf("usage: %s [-i centroid_file] [-o remapped_centroid_file] [-p swap_passes] [-m machine_profile]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (loadMachineProfile(profile, &machine) == MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE) return 2;
+    printf("Machine profile: %s, %d feeders\n", machine.name, machine.number_of_feeders);
+
+    /* parts in feeders which are not in the profile are a content issue */
+    placementStoreInit(&store);
+    if ((res = loadPlacementStore(input, &operation_mode, &store)) != CENTROID_FILE_PRESENT_AND_READ)
+    {
+        printf("Problem with centroid file %s, error code %d\n", input, res);
+        return 2;
+    }
+
+    int *remapped_feeder = malloc((store.count ? store.count : 1) * sizeof(int));
+    if (remapped_feeder == NULL || optimiseFeeders(&store, swap_passes, &assignment, remapped_feeder) != 0)
+    {
+        printf("Not enough memory to optimise %d parts\n", store.count);
+        return 2;
+    }
+
+    printf("%d parts in %d %s\n\n", store.count, assignment.number_of_units,
+           assignment.grouping == UNITS_BY_PART_TYPE ? "part types" : "feeders (there are more part types than feeders)");
+    printf("Footprint  Value       Parts  Current feeders  Proposed feeder\n");
+    for (int u = 0; u < assignment.number_of_units; u++)
+    {
+        int e = assignment.unit_example[u];
+        char current[3 * MAX_NUMBER_OF_FEEDERS + 1] = "";
+        int in_feeder[MAX_NUMBER_OF_FEEDERS] = {0};
+
+        for (int i = 0; i < store.count; i++)
+        {
+            int same_unit = assignment.grouping == UNITS_BY_FEEDER ? store.feeder[i] == store.feeder[e]
+                            : store.footprint[i] == store.footprint[e] && store.value[i] == store.value[e];
+            if (same_unit) in_feeder[store.feeder[i]] = TRUE;
+        }
+        for (int f = 0; f < machine.number_of_feeders; f++) if (in_feeder[f]) sprintf(current + strlen(current), "%d ", f);
+
+        if (assignment.grouping == UNITS_BY_FEEDER) printf("%-9s  %-10s  %5d  %-15s  %d\n", "(mixed)", "", assignment.unit_parts[u], current, assignment.unit_feeder[u]);
+        else printf("%-9s  %-10g  %5d  %-15s  %d\n", placementFootprint(&store, e), store.value[e], assignment.unit_parts[u], current, assignment.unit_feeder[u]);
+    }
+
+    printf("\nTravel model:        %10.0f mm -> %10.0f mm\n", assignment.model_cost_before, assignment.model_cost_after);
+    printf("Planned gantry travel: %8.0f mm -> %10.0f mm, %d improving swaps\n", assignment.route_before, assignment.route_after, assignment.swaps);
+    printf("Predicted saving:    %10.0f mm (%.1f%%)\n", assignment.route_before - assignment.route_after,
+           assignment.route_before > 0 ? 100.0 * (assignment.route_before - assignment.route_after) / assignment.route_before : 0.0);
+
+    if (output != NULL)
+    {
+        if (writeCentroidFile(output, operation_mode, &store, remapped_feeder) != 0)
+        {
+            perror("writing of remapped centroid file failed");
+            return 2;
+        }
+        printf("Remapped centroid file written to %s\n", output);
+    }
+
+    free(remapped_feeder);
+    placementStoreFree(&store);
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ *
+ * pnpRemoteClient.c - a command line client for the remote endpoint of the pick and place machine
+ * controller, used by line supervisor scripts and to exercise the endpoint
+ *
+ * Usage:
+ *   pnpRemoteClient [-s socket] [-n lines] command ...    send each command and print the reply,
+ *                                                        -n prints that many telemetry lines after a STREAM command
+ *   pnpRemoteClient [-s socket] -t                       exercise the endpoint: PING, STATUS, PAUSE, START
+ *                                                        and a one second telemetry stream at the maximum rate
+ *
+ * Run it in the directory the controller was started in, for example:
+ *   pnpRemoteClient "LOAD centroid_large_auto.txt" START "STREAM 100" -n 500
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../pnpRemote.h"
+
+int server_fd;
+char received[REMOTE_OUTPUT_BUFFER_SIZE];
+int received_length = 0;
+
+/*
+ Function: readLine
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: reads the next line sent by the controller
+ Argument(s):
+ char *line - the buffer for the line, the newline is removed
+ int size - the size of the buffer
+ long timeout_ms - the longest time to wait for a complete line
+ Return Value: TRUE if a line was read, FALSE on timeout or if the controller closed the connection
+ Usage: if (readLine(line, sizeof(line), 1000)) ...
+ */
+int readLine(char *line, int size, long timeout_ms)
+{
+    struct pollfd pfd = {.fd = server_fd, .events = POLLIN};
+    char *newline;
+
+    while ((newline = memchr(received, '\n', received_length)) == NULL)
+    {
+        if (poll(&pfd, 1, (int) timeout_ms) <= 0) return FALSE;
+        ssize_t n = recv(server_fd, received + received_length, sizeof(received) - received_length, 0);
+        if (n <= 0) return FALSE;
+        received_length += n;
+    }
+    int length = newline - received;
+    snprintf(line, size, "%.*s", length, received);
+    received_length -= length + 1;
+    memmove(received, newline + 1, received_length);
+    return TRUE;
+}
+
+/*
+ Function: command
+ -----------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: sends one command and waits for its reply, telemetry lines received in the meantime are skipped
+ Argument(s):
+ const char *text - the command, without a newline
+ char *reply - the buffer for the reply
+ int size - the size of the buffer
+ Return Value: TRUE if a reply was received
+ Usage: command("STATUS", reply, sizeof(reply));
+ */
+int command(const char *text, char *reply, int size)
+{
+    char line[REMOTE_LINE_LENGTH + 2];
+    int length = snprintf(line, sizeof(line), "%s\n", text);
+
+    if (send(server_fd, line, length, MSG_NOSIGNAL) != length) return FALSE;
+    do
+    {
+        if (!readLine(reply, size, 2000)) return FALSE;
+    } while ((reply[0] == 'T') && (strncmp(text, "STATUS", 6) != 0 && strncmp(text, "status", 6) != 0));
+    return TRUE;
+}
+
+/*
+ Function: exercise
+ ------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: runs a fixed sequence of commands against the controller and checks the replies
+ Argument(s): none
+ Return Value: the number of failed checks
+ Usage: failures = exercise();
+ */
+int exercise()
+{
+    char reply[1024];
+    int failures = 0, lines = 0;
+    struct timespec start, now;
+
+    #define CHECK(text, expected) \
+        do { \
+            int ok = command(text, reply, sizeof(reply)) && strncmp(reply, expected, strlen(expected)) == 0; \
+            printf("%-6s %-12s -> %s\n", ok ? "pass" : "FAIL", text, reply); \
+            failures += !ok; \
+        } while (0)
+
+    CHECK("PING", "PONG");
+    CHECK("STATUS", "T ");
+    CHECK("BOGUS", "ERR");
+    CHECK("PAUSE", "OK");
+    CHECK("STATUS", "T ");
+    if (strstr(reply, "paused=1") == NULL) {printf("FAIL   status does not report paused\n"); failures++;}
+    CHECK("START", "OK");
+
+    CHECK("STREAM 1000", "OK");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+        if (readLine(reply, sizeof(reply), 100) && reply[0] == 'T') lines++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec) < 1000000000L);
+    CHECK("STREAM 0", "OK");
+    printf("%-6s received %d telemetry lines in 1 s, last: %s\n", (lines > 0) ? "pass" : "FAIL", lines, reply);
+    failures += (lines == 0);
+
+    printf("%d checks failed\n", failures);
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socket_name = REMOTE_SOCKET;
+    struct sockaddr_un address;
+    char reply[1024];
+    long stream_lines = 0;
+    int test = FALSE, first_command = argc;
+
+    for (int i = 1; i < argc && first_command == argc; i++)
+    {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) socket_name = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) stream_lines = atol(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0) test = TRUE;
+        else first_command = i;
+    }
+    if (!test && first_command == argc)
+    {
+        printf("usage: %s [-s socket] [-n lines] command ...\n       %s [-s socket] -t\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", socket_name);
+    if (server_fd < 0 || connect(server_fd, (struct sockaddr *) &address, sizeof(address)) != 0)
+    {
+        perror("connection to controller failed");
+        return 2;
+    }
+
+    if (test) return exercise() ? 3 : 0;
+
+    for (int i = first_command; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {stream_lines = atol(argv[++i]); continue;}
+        if (!command(argv[i], reply, sizeof(reply)))
+        {
+            printf("no reply to %s\n", argv[i]);
+            return 3;
+        }
+        printf("%s\n", reply);
+    }
+    for (long n = 0; n < stream_lines && readLine(reply, sizeof(reply), 5000); )
+    {
+        if (reply[0] == 'T') {printf("%s\n", reply); n++;}
+    }
+    close(server_fd);
+    return 0;
+}
@@ -0,0 +1,689 @@
+/*
+ *
+ * pnpSimulator.c - a headless stand-in for the simulator of the pick and place machine, for running the
+ * controller without the simulator of the assignment
+ *
+ * Usage:
+ *   pnpSimulator [-m machine_profile] [-r real_time_factor] [-s seed] [-t pick_error_degrees] [-p preplace_error_mm]
+ *                [-f failed_pick_percent] [-b bad_pick_percent] [-j centroid_file] [-1] [-v]
+ *
+ * It follows the protocol of the simulator of the assignment over the memory mapped file: an instruction is
+ * accepted by clearing ready_for_next_instruction then instruction_to_execute, and ready_for_next_instruction
+ * is set once it has been executed. The machine is described by the machine profile, MACHINE_PROFILE_FILE
+ * unless -m is given, so heads of up to MAX_NUMBER_OF_NOZZLES nozzles are simulated, with the pick errors
+ * of nozzles from NUMBER_OF_NOZZLES on written to the PnPExtension block, and the gang pick instructions are
+ * accepted if gang_pick is set in the profile, MOVE_HEAD_VIA_CAMERA if flyby_camera is set.
+ *
+ * A move takes the instruction time of the profile plus its travel at the head speed, every other instruction,
+ * including a gang pick instruction, takes the instruction time. Simulated time runs as fast as the controller
+ * allows, or at real_time_factor times real time if -r is given. Pick errors of up to pick_error_degrees (5) and
+ * preplace errors of up to preplace_error_mm (1) either way are drawn from the seed (1). With -f a pick fails
+ * to lift the part that often, and with -b the part is lifted on its side, at 30 to 90 degrees. The look-up
+ * photo reports whether each nozzle holds a part in the pick_status of the PnPExtension block, and a part
+ * released over the reject bin of the profile is counted as rejected rather than placed. A byte is written to
+ * SIMULATOR_NOTIFY_FIFO whenever the simulator becomes ready, once the controller has opened it. A summary of
+ * the instructions executed is printed when the controller quits, or on ctrl-c.
+ *
+ * MOVE_HEAD_VIA_CAMERA moves the head through the look-up camera to its target in one move, so it costs one
+ * instruction time, taken half accelerating and half settling, plus the travel of both legs. The photo is
+ * triggered as the head passes the camera: its results and the time it was triggered are written to the
+ * shared memory at that point of the move, before the simulator is ready again, so the controller can check
+ * the picks while the head is still moving.
+ *
+ * As in the simulator of the assignment, ROTATE_NOZZLE turns a nozzle by the angle it is given, and the look-up
+ * photo resets the angle of each nozzle, so the part on it is at its pick error and the correction is measured
+ * from there. With rotation_speed in the profile a rotation also takes the time to turn the nozzle through the
+ * angle it is given, at that speed. With rotate_while_moving the rotation only takes the instruction time, and
+ * the nozzle keeps turning while the next instructions are executed. An instruction which needs the nozzle
+ * still, lowering it, turning it again or a look-up photo, first waits for the turn to end. rotate_while_moving
+ * describes a hypothetical machine whose look-up photo measures the part against the nozzle and leaves the
+ * angle of the nozzle as it is, see pnpMachineProfile.c.
+ *
+ * A move leaves the head off its target by a preplace error, which the look-down photo measures against the
+ * position the head was last moved to, so a second photo after the amendment reads zero. Every part released
+ * over the PCB is checked against the parts of the centroid file, CENTROID_FILE unless -j is given: only a
+ * part released at the position and angle of a part of the file is counted as placed, the others are counted
+ * as placed wrongly. Without the centroid file the placements are not checked.
+ *
+ * The simulator also serves the PnPSharedV2 block of pnpShared.h, which it advertises unless -1 is given, and
+ * executes instructions passed through either layout. The results of an instruction are written back to the
+ * layout it came through.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpShared.h"
+#include "../pnpMachineProfile.h"
+#include "../pnpPlacementStore.h"
+
+#define SIMULATOR_POLL_INTERVAL_US 100     // how often instruction_to_execute is sampled while idle
+#define SIMULATOR_PICK_TOLERANCE 0.5       // mm, how close a nozzle must be to a feeder to pick from it
+#define SIMULATOR_CAMERA_TOLERANCE 0.5     // mm, how close the head must be to the look-up camera to photograph the nozzles
+#define SIMULATOR_PLACE_TOLERANCE 0.01     // mm, how close a part must be released to its position on the PCB
+#define SIMULATOR_ANGLE_TOLERANCE 0.01     // degrees, how close a part must be released to its angle
+
+const char instruction_name[NUMBER_OF_INSTRUCTION_TYPES][24] = {"NO_INSTRUCTION", "MOVE_HEAD", "ROTATE_NOZZLE", "LOWER_NOZZLE",
+                                                                 "RAISE_NOZZLE", "APPLY_VACUUM", "RELEASE_VACUUM", "TAKE_PHOTO", "AMEND_HEAD_POSITION",
+                                                                 "LOWER_NOZZLES", "RAISE_NOZZLES", "APPLY_VACUUMS", "MOVE_HEAD_VIA_CAMERA"};
+
+typedef struct
+{
+    double x, y;                                    // the head position the controller has moved and amended it to
+    double move_x, move_y;                          // the target of the last move
+    double x_error, y_error;                        // how far the head is off its position since the last move
+    int error_drawn;                                // FALSE until the preplace error of the last move is drawn
+    int lowered[MAX_NUMBER_OF_NOZZLES];
+    int holding[MAX_NUMBER_OF_NOZZLES];             // the feeder of the part on each nozzle, or NO_PICKED_PART
+    double theta[MAX_NUMBER_OF_NOZZLES];            // the angle of each nozzle, since the last look-up photo reset it
+    double pick_error[MAX_NUMBER_OF_NOZZLES];       // the angle of the part on each nozzle against the nozzle
+    double time, travel;
+    double trigger_delay;                           // from the start of the instruction to a photo taken in flight, or 0
+    double turn_end[MAX_NUMBER_OF_NOZZLES];         // when each nozzle stops turning, with rotate_while_moving
+    double turn_wait;                               // time spent waiting for nozzles to stop turning
+    unsigned long long executed[NUMBER_OF_INSTRUCTION_TYPES], rejected, picks, missed_picks, failed_picks, bad_picks, placed, rejected_parts;
+    unsigned long long off_position, wrong_angle;   // parts released over the PCB which are not where the centroid file puts them
+    PnPSnapshot results;                            // the photo results and time, written back to the layout of each instruction
+
+} SimulatorState;
+
+volatile PnP *pnp;
+volatile PnPExtension *pnp_extension;
+PnPSharedV2 *pnp_v2;
+volatile sig_atomic_t stop = FALSE;
+PlacementStore placements;                          // the parts the placements are checked against
+int check_placements = FALSE;
+
+double max_pick_error = 5.0, max_preplace_error = 1.0, failed_pick_percent = 0, bad_pick_percent = 0;
+int verbose = FALSE;
+
+/*
+ Function: stopSimulator
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: SIGINT handler, stops the simulator after the instruction being executed
+ Argument(s): int signal_number - not used
+ Return Value: none
+ Usage: signal(SIGINT, stopSimulator);
+ */
+void stopSimulator(int signal_number)
+{
+    stop = TRUE;
+}
+
+/*
+ Function: uniformError
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: draws an error uniformly distributed between -max and max
+ Argument(s): double max - the largest error either way
+ Return Value: the error
+ Usage: double error = uniformError(max_pick_error);
+ */
+double uniformError(double max)
+{
+    return (2.0 * rand() / RAND_MAX - 1.0) * max;
+}
+
+/*
+ Function: feederUnderNozzle
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: finds the feeder under a nozzle at the current head position
+ Argument(s):
+ const SimulatorState *state - the simulated machine
+ int nozzle - the nozzle
+ Return Value: the feeder, or NO_TAPE_FEEDER_AT_THIS_LOCATION
+ Usage: int f = feederUnderNozzle(&state, nozzle);
+ */
+int feederUnderNozzle(const SimulatorState *state, int nozzle)
+{
+    for (int f = 0; f < machine.number_of_feeders; f++)
+    {
+        if (fabs(state -> x + machine.nozzle_x[nozzle] - machine.feeder_x[f]) < SIMULATOR_PICK_TOLERANCE &&
+            fabs(state -> y - machine.feeder_y[f]) < SIMULATOR_PICK_TOLERANCE)
+            return f;
+    }
+    return NO_TAPE_FEEDER_AT_THIS_LOCATION;
+}
+
+/*
+ Function: drawPreplaceError
+ ---------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: draws how far the head is off its position since the last move, once per move
+ Argument(s): SimulatorState *state - the simulated machine
+ Return Value: none
+ Usage: drawPreplaceError(&state);
+ */
+void drawPreplaceError(SimulatorState *state)
+{
+    if (state -> error_drawn) return;
+    state -> x_error = uniformError(max_preplace_error);
+    state -> y_error = uniformError(max_preplace_error);
+    state -> error_drawn = TRUE;
+}
+
+/*
+ Function: checkPlacement
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ counts a part released over the PCB as placed if a part of the centroid file is at its position and angle,
+ otherwise as off its position or at the wrong angle. Without the centroid file every part is counted as placed.
+ Argument(s):
+ SimulatorState *state - the simulated machine
+ int nozzle - the nozzle releasing the part
+ Return Value: none
+ Usage: checkPlacement(state, nozzle);
+ */
+void checkPlacement(SimulatorState *state, int nozzle)
+{
+    double x, y, theta = state -> theta[nozzle] + state -> pick_error[nozzle];
+    int at_position = FALSE;
+
+    if (!check_placements)
+    {
+        state -> placed++;
+        return;
+    }
+    drawPreplaceError(state);
+    x = state -> x + state -> x_error + machine.nozzle_x[nozzle];
+    y = state -> y + state -> y_error;
+    for (int i = 0; i < placements.count; i++)
+    {
+        if (fabs(placements.x[i] - x) >= SIMULATOR_PLACE_TOLERANCE || fabs(placements.y[i] - y) >= SIMULATOR_PLACE_TOLERANCE) continue;
+        at_position = TRUE;
+        if (fabs(shortestTurn(placements.theta[i], theta)) < SIMULATOR_ANGLE_TOLERANCE)
+        {
+            state -> placed++;
+            return;
+        }
+    }
+    if (at_position) state -> wrong_angle++;
+    else state -> off_position++;
+    printf("%9.2f  nozzle %d placed a part %s, at x %.3f y %.3f theta %.3f\n", state -> time, nozzle,
+           at_position ? "at the wrong angle" : "off every position of the centroid file", x, y, theta);
+}
+
+/*
+ Function: executeNozzleInstruction
+ ----------------------------------
+ Date: 18/10/2026
+ Version 1.2
+ Purpose: carries out a lower, raise, vacuum or release instruction on one nozzle
+ Argument(s):
+ SimulatorState *state - the simulated machine
+ int instruction - LOWER_NOZZLE, RAISE_NOZZLE, APPLY_VACUUM or RELEASE_VACUUM
+ int nozzle - the nozzle
+ Return Value: none
+ Usage: executeNozzleInstruction(&state, APPLY_VACUUM, nozzle);
+ */
+void executeNozzleInstruction(SimulatorState *state, int instruction, int nozzle)
+{
+    int f;
+
+    switch (instruction)
+    {
+        case LOWER_NOZZLE:
+            state -> lowered[nozzle] = TRUE;
+            break;
+
+        case RAISE_NOZZLE:
+            state -> lowered[nozzle] = FALSE;
+            break;
+
+        case APPLY_VACUUM:
+            if (state -> holding[nozzle] != NO_PICKED_PART) break;
+            if (state -> lowered[nozzle] && (f = feederUnderNozzle(state, nozzle)) != NO_TAPE_FEEDER_AT_THIS_LOCATION)
+            {   //the part sits on the nozzle at a random angle until the look-up photo measures it
+                double chance = 100.0 * rand() / RAND_MAX;
+
+                state -> picks++;
+                if (chance < failed_pick_percent)
+                {
+                    state -> failed_picks++;
+                    break;
+                }
+                state -> holding[nozzle] = f;
+                state -> pick_error[nozzle] = uniformError(max_pick_error);
+                if (chance < failed_pick_percent + bad_pick_percent)
+                {   //lifted on its side or corner
+                    state -> pick_error[nozzle] = (30.0 + 60.0 * rand() / RAND_MAX) * (rand() % 2 ? 1 : -1);
+                    state -> bad_picks++;
+                }
+            }
+            else
+            {
+                state -> missed_picks++;
+                if (verbose) printf("%9.2f  nozzle %d picked nothing\n", state -> time, nozzle);
+            }
+            break;
+
+        case RELEASE_VACUUM:
+            if (state -> holding[nozzle] != NO_PICKED_PART && hypot(state -> x + machine.nozzle_x[nozzle] - machine.reject_x, state -> y - machine.reject_y) < SIMULATOR_PICK_TOLERANCE)
+                state -> rejected_parts++;
+            else if (state -> holding[nozzle] != NO_PICKED_PART) checkPlacement(state, nozzle);
+            state -> holding[nozzle] = NO_PICKED_PART;
+            break;
+    }
+}
+
+/*
+ Function: lookupPhoto
+ ---------------------
+ Date: 18/10/2026
+ Version 1.1
+ Purpose:
+ photographs the nozzles from the look-up camera, the camera sees the angle of the part on each nozzle, empty
+ nozzles read zero. Unless the machine has rotate_while_moving, the angle of each nozzle is reset, so a part is
+ at its pick error.
+ Argument(s):
+ SimulatorState *state - the simulated machine
+ int at_camera - TRUE if the nozzles are over the camera, otherwise the photo shows nothing
+ double photo_time - the simulated time the photo is taken
+ Return Value: none
+ Usage: lookupPhoto(&state, TRUE, state.time);
+ */
+void lookupPhoto(SimulatorState *state, int at_camera, double photo_time)
+{
+    for (int n = 0; n < machine.number_of_nozzles; n++)
+    {
+        state -> results.theta_pick_error[n] = at_camera && state -> holding[n] != NO_PICKED_PART ? state -> pick_error[n] : 0.0;
+        state -> results.pick_status[n] = !at_camera ? PICK_STATUS_UNKNOWN :
+                                          state -> holding[n] != NO_PICKED_PART ? PICK_STATUS_PART_PRESENT : PICK_STATUS_NOZZLE_EMPTY;
+        if (at_camera && !machine.rotate_while_moving) state -> theta[n] = 0;
+    }
+    state -> results.lookup_photo_time = photo_time;
+}
+
+/*
+ Function: waitForTurns
+ ----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: the time from the start of an instruction until the nozzles it needs still have stopped turning
+ Argument(s):
+ SimulatorState *state - the simulated machine
+ int nozzle_mask - the nozzles, see NOZZLE_MASK()
+ Return Value: the wait in seconds, 0 if they are not turning, which is added to the time waited for turns
+ Usage: double wait = waitForTurns(state, NOZZLE_MASK(nozzle));
+ */
+double waitForTurns(SimulatorState *state, int nozzle_mask)
+{
+    double wait = 0;
+
+    for (int n = 0; n < machine.number_of_nozzles; n++)
+        if ((nozzle_mask & NOZZLE_MASK(n)) && state -> turn_end[n] - state -> time > wait) wait = state -> turn_end[n] - state -> time;
+    state -> turn_wait += wait;
+    return wait;
+}
+
+/*
+ Function: executeInstruction
+ ----------------------------
+ Date: 18/10/2026
+ Version 1.5
+ Purpose:
+ carries out an instruction on the simulated machine, and keeps the photo results in the state.
+ Instructions for nozzles the head does not have, gang pick instructions on a machine without gang pick,
+ fly-by moves on a machine without a fly-by camera, unknown cameras or instructions, and moves with a
+ nozzle lowered are rejected. A fly-by move sets the trigger_delay of its photo. The time taken includes
+ any wait for a nozzle still turning from an earlier rotation.
+ Argument(s):
+ SimulatorState *state - the simulated machine
+ int instruction - the instruction
+ double argument_1, double argument_2, int argument_3 - the arguments of the instruction
+ Return Value: the simulated time taken in seconds, or -1 if the instruction is rejected
+ Usage: double duration = executeInstruction(&state, instruction, argument_1, argument_2, argument_3);
+ */
+double executeInstruction(SimulatorState *state, int instruction, double argument_1, double argument_2, int argument_3)
+{
+    int nozzles = machine.number_of_nozzles;
+    double distance, wait, turn_time;
+
+    switch (instruction)
+    {
+        case MOVE_HEAD:
+        case AMEND_HEAD_POSITION:
+            for (int n = 0; n < nozzles; n++) if (state -> lowered[n]) return -1;
+            if (instruction == AMEND_HEAD_POSITION)
+            {
+                argument_1 += state -> x;
+                argument_2 += state -> y;
+            }
+            distance = hypot(argument_1 - state -> x, argument_2 - state -> y);
+            state -> x = argument_1;
+            state -> y = argument_2;
+            state -> travel += distance;
+            if (instruction == MOVE_HEAD)
+            {
+                state -> move_x = argument_1;
+                state -> move_y = argument_2;
+                state -> error_drawn = FALSE;
+            }
+            return machine.instruction_time + distance / machine.head_speed;
+
+        case MOVE_HEAD_VIA_CAMERA:
+            if (!machine.flyby_camera) return -1;
+            for (int n = 0; n < nozzles; n++) if (state -> lowered[n]) return -1;
+            wait = waitForTurns(state, NOZZLE_MASK(nozzles) - 1);  //the photo needs the nozzles still
+            distance = hypot(machine.camera_x - state -> x, machine.camera_y - state -> y);
+            state -> trigger_delay = wait + machine.instruction_time / 2 + distance / machine.head_speed;
+            lookupPhoto(state, TRUE, state -> time + state -> trigger_delay);
+            distance += hypot(argument_1 - machine.camera_x, argument_2 - machine.camera_y);
+            state -> x = state -> move_x = argument_1;
+            state -> y = state -> move_y = argument_2;
+            state -> error_drawn = FALSE;
+            state -> travel += distance;
+            return wait + machine.instruction_time + distance / machine.head_speed;
+
+        case ROTATE_NOZZLE:
+            if (argument_3 < 0 || argument_3 >= nozzles) return -1;
+            //the nozzle turns by the angle it is given, it does not take the shorter way round by itself
+            wait = waitForTurns(state, NOZZLE_MASK(argument_3));
+            turn_time = machine.rotation_speed > 0 ? fabs(argument_1) / machine.rotation_speed : 0;
+            state -> theta[argument_3] += argument_1;
+            if (!machine.rotate_while_moving) return wait + machine.instruction_time + turn_time;
+            state -> turn_end[argument_3] = state -> time + wait + machine.instruction_time + turn_time;
+            return wait + machine.instruction_time;
+
+        case LOWER_NOZZLE:
+        case RAISE_NOZZLE:
+        case APPLY_VACUUM:
+        case RELEASE_VACUUM:
+            if (argument_3 < 0 || argument_3 >= nozzles) return -1;
+            wait = instruction == LOWER_NOZZLE ? waitForTurns(state, NOZZLE_MASK(argument_3)) : 0;
+            executeNozzleInstruction(state, instruction, argument_3);
+            return wait + machine.instruction_time;
+
+        case LOWER_NOZZLES:
+        case RAISE_NOZZLES:
+        case APPLY_VACUUMS:
+            if (!machine.gang_pick || argument_3 <= 0 || (argument_3 >> nozzles) != 0) return -1;
+            wait = instruction == LOWER_NOZZLES ? waitForTurns(state, argument_3) : 0;
+            for (int n = 0; n < nozzles; n++)
+            {
+                if (argument_3 & NOZZLE_MASK(n))
+                    executeNozzleInstruction(state, instruction == LOWER_NOZZLES ? LOWER_NOZZLE : instruction == RAISE_NOZZLES ? RAISE_NOZZLE : APPLY_VACUUM, n);
+            }
+            return wait + machine.instruction_time;
+
+        case TAKE_PHOTO:
+            wait = 0;
+            if (argument_3 == PHOTO_LOOKUP)
+            {
+                wait = waitForTurns(state, NOZZLE_MASK(nozzles) - 1);
+                lookupPhoto(state, hypot(state -> x - machine.camera_x, state -> y - machine.camera_y) < SIMULATOR_CAMERA_TOLERANCE, state -> time + wait + machine.instruction_time);
+            }
+            else if (argument_3 == PHOTO_LOOKDOWN)
+            {   //the head is measured against where it was moved to, an amendment since then is part of the error
+                drawPreplaceError(state);
+                state -> results.x_preplace_error = state -> x + state -> x_error - state -> move_x;
+                state -> results.y_preplace_error = state -> y + state -> y_error - state -> move_y;
+            }
+            else return -1;
+            return wait + machine.instruction_time;
+    }
+    return -1;
+}
+
+/*
+ Function: writeResultsV1
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes the results of the instructions executed so far to the PnP and PnPExtension blocks
+ Argument(s): const PnPSnapshot *results - the results
+ Return Value: none
+ Usage: writeResultsV1(&state.results);
+ */
+void writeResultsV1(const PnPSnapshot *results)
+{
+    pnp -> sim_time = results -> sim_time;
+    pnp -> x_preplace_error = results -> x_preplace_error;
+    pnp -> y_preplace_error = results -> y_preplace_error;
+    for (int n = 0; n < machine.number_of_nozzles; n++)
+    {
+        if (n < NUMBER_OF_NOZZLES) pnp -> theta_pick_error[n] = results -> theta_pick_error[n];
+        else pnp_extension -> theta_pick_error[n - NUMBER_OF_NOZZLES] = results -> theta_pick_error[n];
+        pnp_extension -> pick_status[n] = results -> pick_status[n];
+    }
+    pnp_extension -> lookup_photo_time = results -> lookup_photo_time;
+}
+
+/*
+ Function: publishResults
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: writes the results of the instructions executed so far to the layout the current instruction came through
+ Argument(s): const PnPSnapshot *results - the results
+ Return Value: none
+ Usage: publishResults(&state.results, number != 0);
+ */
+void publishResults(const PnPSnapshot *results, int v2)
+{
+    if (v2) writeSnapshotV2(pnp_v2, results);
+    else writeResultsV1(results);
+}
+
+/*
+ Function: pauseRealTime
+ -----------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: sleeps for a simulated duration scaled to real time, or not at all if the simulator runs as fast as it can
+ Argument(s):
+ double duration - simulated seconds
+ double real_time_factor - from -r, or 0
+ Return Value: none
+ Usage: pauseRealTime(duration, real_time_factor);
+ */
+void pauseRealTime(double duration, double real_time_factor)
+{
+    if (real_time_factor > 0)
+    {
+        double wall_time = duration / real_time_factor;
+        struct timespec pause = {.tv_sec = (time_t) wall_time, .tv_nsec = (long) ((wall_time - (time_t) wall_time) * 1e9)};
+        nanosleep(&pause, NULL);
+    }
+}
+
+/*
+ Function: notifyReady
+ ---------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose:
+ writes a byte to SIMULATOR_NOTIFY_FIFO to wake the controller. The FIFO is opened once the controller has
+ opened its read end, until then nothing is written.
+ Argument(s): int *notify_fd - the write end of the FIFO, or -1 if it is not open yet
+ Return Value: none
+ Usage: notifyReady(&notify_fd);
+ */
+void notifyReady(int *notify_fd)
+{
+    char byte = 1;
+
+    if (*notify_fd < 0) *notify_fd = open(SIMULATOR_NOTIFY_FIFO, O_WRONLY | O_NONBLOCK);
+    if (*notify_fd >= 0 && write(*notify_fd, &byte, 1) < 0 && errno == EPIPE)
+    {   //the controller has closed the FIFO, reopen it when the next controller runs
+        close(*notify_fd);
+        *notify_fd = -1;
+    }
+}
+
+/*
+ Function: printSummary
+ ----------------------
+ Date: 18/10/2026
+ Version 1.3
+ Purpose: prints the instructions executed and the work done by the simulated machine
+ Argument(s): const SimulatorState *state - the simulated machine
+ Return Value: none
+ Usage: printSummary(&state);
+ */
+void printSummary(const SimulatorState *state)
+{
+    unsigned long long total = 0;
+
+    printf("\nSimulated time %.2f s, head travel %.0f mm\n", state -> time, state -> travel);
+    for (int i = 1; i < NUMBER_OF_INSTRUCTION_TYPES; i++)
+    {
+        printf("  %-20s %llu\n", instruction_name[i], state -> executed[i]);
+        total += state -> executed[i];
+    }
+    printf("  %-20s %llu\n  %-20s %llu\n", "total", total, "rejected", state -> rejected);
+    printf("Picks %llu, of which %llu failed and %llu bad, picks from no feeder %llu\n", state -> picks, state -> failed_picks, state -> bad_picks, state -> missed_picks);
+    printf("Parts placed %llu, rejected %llu\n", state -> placed, state -> rejected_parts);
+    if (check_placements) printf("Parts placed wrongly %llu, %llu off their position and %llu at the wrong angle\n",
+                                 state -> off_position + state -> wrong_angle, state -> off_position, state -> wrong_angle);
+    if (machine.rotate_while_moving) printf("Waited %.2f s for nozzles to stop turning\n", state -> turn_wait);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *profile = MACHINE_PROFILE_FILE, *centroid_file = CENTROID_FILE;
+    double real_time_factor = 0;
+    unsigned int seed = 1;
+    int fd, notify_fd = -1, serve_v2 = TRUE, operation_mode;
+    SimulatorState state = {0};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) profile = argv[++i];
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) real_time_factor = atof(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = (unsigned int) atol(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) max_pick_error = atof(argv[++i]);
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) max_preplace_error = atof(argv[++i]);
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) failed_pick_percent = atof(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) bad_pick_percent = atof(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) centroid_file = argv[++i];
+        else if (strcmp(argv[i], "-1") == 0) serve_v2 = FALSE;
+        else if (strcmp(argv[i], "-v") == 0) verbose = TRUE;
+        else
+        {
+            printf("usage: %s [-m machine_profile] [-r real_time_factor] [-s seed] [-t pick_error_degrees] [-p preplace_error_mm]\n"
+                   "          [-f failed_pick_percent] [-b bad_pick_percent] [-j centroid_file] [-1] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (loadMachineProfile(profile, &machine) == MACHINE_PROFILE_PRESENT_BUT_CONTENT_ISSUE) return 2;
+    printMachineProfile(&machine);
+    placementStoreInit(&placements);
+    if (loadPlacementStore(centroid_file, &operation_mode, &placements) == CENTROID_FILE_PRESENT_AND_READ) check_placements = TRUE;
+    else printf("Cannot read %s, placements are not checked\n", centroid_file);
+    srand(seed);
+    signal(SIGINT, stopSimulator);
+    signal(SIGPIPE, SIG_IGN);
+
+    fd = open(MEMORY_MAPPED_FILE, (O_CREAT | O_RDWR), 0666);
+    if (fd < 0 || ftruncate(fd, PNP_V2_OFFSET + sizeof(PnPSharedV2)) != 0)
+    {
+        perror("creation/opening of file failed");
+        return 1;
+    }
+    pnp = (PnP *)mmap(0, PNP_V2_OFFSET + sizeof(PnPSharedV2), (PROT_READ | PROT_WRITE), MAP_SHARED, fd, (off_t)0);
+    if (pnp == MAP_FAILED)
+    {
+        perror("memory mapping of file failed");
+        close(fd);
+        return 1;
+    }
+    pnp_extension = (PnPExtension *)(pnp + 1);
+    pnp_v2 = (PnPSharedV2 *)((char *) pnp + PNP_V2_OFFSET);
+    memset((void *) pnp, 0, PNP_V2_OFFSET + sizeof(PnPSharedV2));
+    if (mkfifo(SIMULATOR_NOTIFY_FIFO, 0666) != 0 && errno != EEXIST) perror("creation of notification FIFO failed");
+
+    state.x = state.move_x = machine.home_x;
+    state.y = state.move_y = machine.home_y;
+    for (int n = 0; n < MAX_NUMBER_OF_NOZZLES; n++) state.holding[n] = NO_PICKED_PART;
+    pnp -> ready_for_next_instruction = TRUE;
+    if (serve_v2)
+    {   /* advertise the version 2 block last, once it is ready to be used */
+        pnp_v2 -> simulator_pid = getpid();
+        pnp_v2 -> version = PNP_V2_VERSION;
+        atomic_store_explicit(&pnp_v2 -> magic, PNP_V2_MAGIC, memory_order_release);
+    }
+    printf("Simulator ready, waiting for the controller%s\n", serve_v2 ? ", serving shared memory layout version 2" : "");
+
+    while (!stop && !pnp -> quit)
+    {
+        PnPInstruction taken;
+        unsigned int number = serve_v2 ? takeInstructionV2(pnp_v2, &taken) : 0;
+        int instruction, argument_3;
+        double argument_1, argument_2;
+
+        if (number != 0)
+        {
+            instruction = taken.instruction;
+            argument_1 = taken.argument_1;
+            argument_2 = taken.argument_2;
+            argument_3 = taken.argument_3;
+        }
+        else if ((instruction = pnp -> instruction_to_execute) != NO_INSTRUCTION)
+        {   /* accept the instruction: not ready first, so the controller never sees it cleared while still ready */
+            pnp -> ready_for_next_instruction = FALSE;
+            argument_1 = pnp -> instruction_argument_1;
+            argument_2 = pnp -> instruction_argument_2;
+            argument_3 = pnp -> instruction_argument_3;
+            atomic_thread_fence(memory_order_seq_cst);
+            pnp -> instruction_to_execute = NO_INSTRUCTION;
+        }
+        else
+        {
+            usleep(SIMULATOR_POLL_INTERVAL_US);
+            continue;
+        }
+
+        state.trigger_delay = 0;
+        double duration = instruction > NO_INSTRUCTION && instruction < NUMBER_OF_INSTRUCTION_TYPES ?
+                          executeInstruction(&state, instruction, argument_1, argument_2, argument_3) : -1;
+        if (duration < 0)
+        {
+            state.rejected++;
+            printf("%9.2f  rejected instruction %d, arguments %.2f %.2f %d\n", state.time, instruction, argument_1, argument_2, argument_3);
+        }
+        else
+        {
+            state.executed[instruction]++;
+            if (state.trigger_delay > 0)
+            {   //a photo taken in flight is published as the head passes the camera, while the move carries on
+                pauseRealTime(state.trigger_delay, real_time_factor);
+                state.results.sim_time = state.time + state.trigger_delay;
+                publishResults(&state.results, number != 0);
+                duration -= state.trigger_delay;
+            }
+            pauseRealTime(duration, real_time_factor);
+            state.time += duration + state.trigger_delay;
+            if (verbose) printf("%9.2f  %-20s %.2f %.2f %d\n", state.time, instruction_name[instruction], argument_1, argument_2, argument_3);
+        }
+
+        state.results.sim_time = state.time;
+        publishResults(&state.results, number != 0);
+        if (number != 0) finishInstructionV2(pnp_v2, number);
+        else
+        {
+            atomic_thread_fence(memory_order_seq_cst);
+            pnp -> ready_for_next_instruction = TRUE;
+        }
+        notifyReady(&notify_fd);
+    }
+
+    atomic_store_explicit(&pnp_v2 -> magic, 0, memory_order_relaxed);
+    printSummary(&state);
+    if (notify_fd >= 0) close(notify_fd);
+    unlink(SIMULATOR_NOTIFY_FIFO);
+    munmap((void *) pnp, PNP_V2_OFFSET + sizeof(PnPSharedV2));
+    close(fd);
+    placementStoreFree(&placements);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ *
+ * pnpTelemetryMonitor.c - samples the telemetry block published by the pick and place machine controller
+ *
+ * Usage:
+ *   pnpTelemetryMonitor [-f file] [-r rate] [-n samples]   print a status line rate times per second
+ *   pnpTelemetryMonitor [-f file] -H                       print the counters and timing histograms once
+ *   pnpTelemetryMonitor [-f file] -b seconds               sample as fast as possible and report the read rate
+ *
+ * The telemetry block is mapped read only, so any number of monitors can run alongside the controller.
+ *
+ * Platform: Any POSIX compliant platform
+ * Intended for: Cygwin 64 bit, tested on Linux
+ *
+ */
+
+#include "../pnpTelemetry.h"
+
+const char instruction_name[NUMBER_OF_INSTRUCTION_TYPES][24] = {"NO_INSTRUCTION", "MOVE_HEAD", "ROTATE_NOZZLE", "LOWER_NOZZLE",
+                                                                 "RAISE_NOZZLE", "APPLY_VACUUM", "RELEASE_VACUUM", "TAKE_PHOTO", "AMEND_HEAD_POSITION",
+                                                                 "LOWER_NOZZLES", "RAISE_NOZZLES", "APPLY_VACUUMS", "MOVE_HEAD_VIA_CAMERA"};
+
+/*
+ Function: printHistogram
+ ------------------------
+ Date: 18/10/2026
+ Version 1.0
+ Purpose: prints the non-empty bins of a logarithmic histogram, see histogramBin()
+ Argument(s):
+ const char *title - the histogram title
+ const char *unit - the unit of the binned values
+ const unsigned long long histogram[] - the bin counts
+ Return Value: none
+ Usage: printHistogram("Instruction latency", "us", data.instruction_latency_histogram);
+ */
+void printHistogram(const char *title, const char *unit, const unsigned long long histogram[LATENCY_HISTOGRAM_BINS])
+{
+    printf("%s:\n", title);
+    for (int b = 0; b < LATENCY_HISTOGRAM_BINS; b++)
+    {
+        if (histogram[b] == 0) continue;
+        printf("  %9.0f - %9.0f %s  %llu\n", b ? ldexp(1.0, b - 1) : 0.0, ldexp(1.0, b), unit, histogram[b]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *file_name = TELEMETRY_FILE;
+    long rate = 10, samples = -1;
+    double benchmark_seconds = 0.0;
+    int histograms = FALSE;
+    TelemetryData data;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) file_name = argv[++i];
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) rate = atol(argv[++i]);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) samples = atol(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) benchmark_seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-H") == 0) histograms = TRUE;
+        else
+        {
+            printf("usage: %s [-f file] [-r rate] [-n samples] | -H | -b seconds\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {perror("opening of telemetry file failed"); return 2;}
+    const TelemetryBlock *block = (const TelemetryBlock *)mmap(0, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, fd, (off_t)0);
+    if (block == MAP_FAILED) {perror("memory mapping of telemetry file failed"); return 2;}
+    if (block -> magic != TELEMETRY_MAGIC || block -> version != TELEMETRY_VERSION || block -> size != sizeof(TelemetryBlock))
+    {
+        printf("%s is not a version %d telemetry block\n", file_name, TELEMETRY_VERSION);
+        return 2;
+    }
+
+    if (benchmark_seconds > 0.0)
+    {
+        struct timespec start, now;
+        long long reads = 0, retries = 0, failures = 0;
+        double elapsed = 0.0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        do
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                int r = readTelemetry(block, &data);
+                if (r < 0) failures++; else retries += r;
+            }
+            reads += 1000;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+        } while (elapsed < benchmark_seconds);
+        printf("%lld consistent reads in %.2f s (%.0f reads/s, %.1f ns/read), %lld torn reads retried, %lld failed\n",
+               reads - failures, elapsed, reads / elapsed, 1e9 * elapsed / reads, retries, failures);
+        return 0;
+    }
+
+    if (histograms)
+    {
+        if (readTelemetry(block, &data) < 0) {printf("no consistent telemetry\n"); return 3;}
+        printf("Snapshots published: %llu\nParts placed: %llu\nInstructions completed: %llu\n",
+               data.publish_count, data.total_parts_placed, data.instructions_completed);
+        for (int i = 1; i < NUMBER_OF_INSTRUCTION_TYPES; i++) printf("  %-20s %llu\n", instruction_name[i], data.instructions_issued[i]);
+        printHistogram("Instruction latency", "us", data.instruction_latency_histogram);
+        printHistogram("Time between placements", "ms", data.placement_interval_histogram);
+        return 0;
+    }
+
+    for (long n = 0; samples < 0 || n < samples; n++)
+    {
+        if (readTelemetry(block, &data) < 0) printf("no consistent telemetry\n");
+        else
+        {
+            printf("t=%8.2f %.19s part %d/%d placed %d nozzles", data.sim_time, data.state_name, data.part_counter,
+                   data.number_of_components_to_place, data.parts_placed);
+            for (int i = 0; i < data.number_of_nozzles; i++)
+            {
+                if (data.nozzle_status[i]) printf(" %d", data.nozzle_part[i]);
+                else printf(" -");
+            }
+            printf(" pick errors");
+            for (int i = 0; i < data.number_of_nozzles; i++) printf(" %.2f", data.theta_pick_error[i]);
+            printf(" preplace %.2f,%.2f%s\n", data.x_preplace_error, data.y_preplace_error, data.paused ? " PAUSED" : "");
+        }
+        fflush(stdout);
+        sleepMilliseconds(rate > 0 ? 1000 / rate : 1000);
+    }
+    return 0;
+}
+
+/*
+ * sleepMilliseconds - as in pnpControlInterface.c, which the monitor does not link with
+ */
+void sleepMilliseconds(long ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000;
+    nanosleep(&ts, NULL);
+}